@@ -0,0 +1,142 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tinyvtu::bench {
+/**
+ * Returns the number of calls of the global operator new so far, counted by the benchmark executable.
+ */
+std::uint64_t allocationCount();
+
+/**
+ * Settings of a benchmark run, given on the command line.
+ */
+struct Options
+{
+    /**
+     * Only benchmarks whose name contains the filter are run.
+     */
+    std::string filter;
+
+    /**
+     * The minimal time, in seconds, every benchmark is repeated for.
+     */
+    double min_time = 0.25;
+
+    /**
+     * The size, in bytes, of the arrays the benchmarks work on.
+     */
+    std::uint64_t size = 8 * 1024 * 1024;
+
+    /**
+     * Prints the results as JSON instead of CSV.
+     */
+    bool json = false;
+};
+
+/**
+ * The measurement of a single benchmark.
+ */
+struct Result
+{
+    std::string name;
+    std::uint64_t bytes;         ///< Bytes processed per call, the throughput refers to them
+    std::uint64_t output_bytes;  ///< Bytes produced per call, e.g. the compressed size
+    std::uint64_t iterations;
+    double seconds;              ///< Seconds per call
+    double allocations;          ///< Calls of operator new per call
+};
+
+/**
+ * Runs benchmarks and collects their results.
+ *
+ * Every benchmark is called once for warm-up and then repeatedly until Options::min_time has passed. The rows are
+ * printed in the order the benchmarks are run, which is fixed, so the output of two versions can be diffed.
+ */
+class Suite final
+{
+public:
+    explicit Suite(Options options) : options_(std::move(options)) {}
+
+    [[nodiscard]] const Options &options() const { return options_; }
+
+    /**
+     * Measures a benchmark unless it is filtered out.
+     *
+     * @param name   The unique name of the benchmark, of the form "<function>/<parameters>"
+     * @param bytes  The number of bytes processed per call
+     * @param call   Callable running the benchmark once and returning the number of bytes it produced
+     */
+    template <typename Call>
+    void run(const std::string &name, std::uint64_t bytes, Call &&call)
+    {
+        if (name.find(options_.filter) == std::string::npos) return;
+
+        const std::uint64_t output_bytes = call();
+        const auto allocationsBefore = allocationCount();
+        const auto start = std::chrono::steady_clock::now();
+        std::uint64_t iterations = 0;
+        std::chrono::duration<double> elapsed{};
+        do
+        {
+            static_cast<void>(call());
+            ++iterations;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < options_.min_time);
+        const auto allocations = allocationCount() - allocationsBefore;
+
+        results_.push_back({name, bytes, output_bytes, iterations, elapsed.count() / static_cast<double>(iterations),
+                            static_cast<double>(allocations) / static_cast<double>(iterations)});
+    }
+
+    /**
+     * Prints all results as CSV or JSON, see Options::json.
+     */
+    void print(std::ostream &stream) const
+    {
+        auto megabytesPerSecond = [](const Result &result)
+        { return static_cast<double>(result.bytes) / result.seconds / 1e6; };
+
+        if (options_.json)
+        {
+            stream << "[\n";
+            for (std::size_t i = 0; i < results_.size(); ++i)
+            {
+                const auto &result = results_[i];
+                stream << "  {\"name\": \"" << result.name << "\", \"bytes\": " << result.bytes
+                       << ", \"output_bytes\": " << result.output_bytes << ", \"iterations\": " << result.iterations
+                       << ", \"seconds\": " << result.seconds << ", \"MB/s\": " << megabytesPerSecond(result)
+                       << ", \"allocations\": " << result.allocations << "}" << (i + 1 < results_.size() ? "," : "")
+                       << "\n";
+            }
+            stream << "]\n";
+            return;
+        }
+
+        stream << "name,bytes,output_bytes,iterations,seconds,MB/s,allocations\n";
+        for (const auto &result : results_)
+            stream << result.name << "," << result.bytes << "," << result.output_bytes << "," << result.iterations
+                   << "," << result.seconds << "," << megabytesPerSecond(result) << "," << result.allocations << "\n";
+    }
+
+private:
+    Options options_;
+    std::vector<Result> results_;
+};
+
+/**
+ * Benchmarks compressData for all levels, block sizes, thread counts, and codecs.
+ */
+void benchmarkCompression(Suite &suite);
+
+/**
+ * Benchmarks createBlock per element type, gathering strided and per-component fields, generating derived fields,
+ * createGrid, XML emission, base64 encoding, writing unstructured and structured grids and point clouds, and reading
+ * whole files.
+ */
+void benchmarkGrid(Suite &suite);
+}  // namespace tinyvtu::bench
@@ -0,0 +1,172 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "internal/DataBlock.hpp"
+#include "internal/Precision.hpp"
+
+using namespace tinyvtu::internal;
+
+namespace {
+/**
+ * Creates a smooth float field with some noise, which compresses similar to typical simulation output.
+ */
+std::vector<float> createField(std::size_t size)
+{
+    std::mt19937 generator(42);
+    std::normal_distribution<float> noise(0.f, 1e-3f);
+
+    std::vector<float> field(size);
+    for (std::size_t i = 0; i < size; ++i) field[i] = std::sin(static_cast<float>(i) * 1e-4f) + noise(generator);
+    return field;
+}
+
+/**
+ * Creates a float64 field of pure noise, which deflate shrinks by a few percent only.
+ */
+std::vector<double> createNoise(std::size_t size)
+{
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> noise(-1., 1.);
+
+    std::vector<double> field(size);
+    for (auto &value : field) value = noise(generator);
+    return field;
+}
+
+/**
+ * Creates cell-wise integer data like material ids, which compresses much better than floating point fields.
+ */
+std::vector<std::int32_t> createIds(std::size_t size)
+{
+    std::vector<std::int32_t> ids(size);
+    for (std::size_t i = 0; i < size; ++i) ids[i] = static_cast<std::int32_t>((i / 4096) % 7);
+    return ids;
+}
+
+void benchmarkCompressData(tinyvtu::bench::Suite &suite, const std::string &name, std::span<const std::uint8_t> data,
+                           const tinyvtu::compression::Info &compression)
+{
+    suite.run("compressData/" + name, data.size(),
+              [&] { return compressData(data.data(), data.size(), compression).size(); });
+}
+
+/**
+ * Compares the throughput of compressing with a growing number of threads, the result must not depend on them.
+ */
+void benchmarkThreads(tinyvtu::bench::Suite &suite, std::span<const std::uint8_t> field)
+{
+    auto compression = tinyvtu::compression::zlib;
+    const auto reference = compressData(field.data(), field.size(), compression);
+
+    const auto maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (std::uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        compression.threads = threads;
+        if (compressData(field.data(), field.size(), compression) != reference)
+            throw std::runtime_error("Compressed data depends on the number of threads");
+        benchmarkCompressData(suite, "float32/zlib-2/threads=" + std::to_string(threads), field, compression);
+    }
+}
+
+/**
+ * Compares the codecs and zlib engines available in this build, the ratio follows from bytes and output_bytes.
+ */
+void benchmarkCodecs(tinyvtu::bench::Suite &suite, const std::string &array, std::span<const std::uint8_t> data)
+{
+    using tinyvtu::compression::Codec;
+    using tinyvtu::compression::Deflate;
+    struct Candidate
+    {
+        const char *name;
+        tinyvtu::compression::Info compression;
+    };
+    std::vector<Candidate> candidates{{"zlib-1", {true, 32768, 1}},
+                                      {"zlib-2", tinyvtu::compression::zlib},
+                                      {"zlib-6", {true, 32768, 6}},
+                                      {"zlib-2/adaptive", {true, 32768, 2, 1, Codec::ZLib, Deflate::Default, 1.05}},
+                                      {"zlib-2/block=auto", {true, 0, 2}}};
+#ifdef TINYVTU_WITH_LZ4
+    candidates.push_back({"lz4", tinyvtu::compression::lz4});
+#endif
+#ifdef TINYVTU_WITH_LZMA
+    candidates.push_back({"lzma-2", {true, 32768, 2, 1, Codec::LZMA}});
+    candidates.push_back({"lzma-6", tinyvtu::compression::lzma});
+#endif
+#ifdef TINYVTU_WITH_LIBDEFLATE
+    candidates.push_back({"zlib-2/libdeflate", {true, 32768, 2, 1, Codec::ZLib, Deflate::LibDeflate}});
+    candidates.push_back({"zlib-6/libdeflate", {true, 32768, 6, 1, Codec::ZLib, Deflate::LibDeflate}});
+#endif
+
+    for (const auto &[name, compression] : candidates)
+        benchmarkCompressData(suite, array + "/" + name, data, compression);
+}
+/**
+ * Compares compressing noise with and without the adaptive passthrough of incompressible blocks.
+ */
+void benchmarkAdaptive(tinyvtu::bench::Suite &suite, std::span<const std::uint8_t> noise)
+{
+    auto compression = tinyvtu::compression::zlib;
+    benchmarkCompressData(suite, "float64-noise/zlib-2", noise, compression);
+    compression.minRatio = 1.05;
+    benchmarkCompressData(suite, "float64-noise/zlib-2/adaptive", noise, compression);
+}
+
+/**
+ * Compares compressing noise at full precision with rounding its mantissas and narrowing it to float.
+ */
+void benchmarkPrecision(tinyvtu::bench::Suite &suite, std::span<const double> noise)
+{
+    using tinyvtu::precision::Narrowing;
+    struct Candidate
+    {
+        const char *name;
+        tinyvtu::precision::Info precision;
+    };
+    const std::vector<Candidate> candidates{{"full", tinyvtu::precision::full},
+                                            {"significantBits=24", {.significantBits = 24}},
+                                            {"relativeError=1e-4", {.relativeError = 1e-4}},
+                                            {"float32", {.narrowing = Narrowing::Float32}},
+                                            {"float32/significantBits=16", {16, 0, Narrowing::Float32}}};
+
+    for (const auto &[name, precision] : candidates)
+        suite.run(std::string("createBlock/float64-noise/zlib-2/") + name, noise.size_bytes(),
+                  [&]
+                  {
+                      return createBlock("noise", noise, 1, tinyvtu::compression::zlib, precision).size();
+                  });
+}
+}  // namespace
+
+namespace tinyvtu::bench {
+void benchmarkCompression(Suite &suite)
+{
+    const auto count = suite.options().size / sizeof(float);
+    const auto field = createField(count);
+    const auto ids = createIds(count);
+    const auto noise = createNoise(count / 2);
+    const std::span<const std::uint8_t> fieldBytes(reinterpret_cast<const std::uint8_t *>(field.data()),
+                                                   field.size() * sizeof(float));
+    const std::span<const std::uint8_t> idBytes(reinterpret_cast<const std::uint8_t *>(ids.data()),
+                                                ids.size() * sizeof(std::int32_t));
+    const std::span<const std::uint8_t> noiseBytes(reinterpret_cast<const std::uint8_t *>(noise.data()),
+                                                   noise.size() * sizeof(double));
+
+    for (const std::int32_t level : {1, 2, 6, 9})
+        for (const std::uint32_t blockSize : {16384u, 32768u, 65536u, 262144u})
+            benchmarkCompressData(suite,
+                                  "float32/zlib-" + std::to_string(level) + "/block=" + std::to_string(blockSize),
+                                  fieldBytes, {true, blockSize, level});
+
+    benchmarkThreads(suite, fieldBytes);
+    benchmarkCodecs(suite, "float32", fieldBytes);
+    benchmarkCodecs(suite, "int32", idBytes);
+    benchmarkAdaptive(suite, noiseBytes);
+    benchmarkPrecision(suite, noise);
+}
+}  // namespace tinyvtu::bench
@@ -0,0 +1,483 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "internal/GridData.hpp"
+#include "internal/XMLWriter.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu::internal;
+
+namespace {
+template <typename T>
+void benchmarkCreateBlock(tinyvtu::bench::Suite &suite, const std::string &type)
+{
+    std::vector<T> data(suite.options().size / sizeof(T));
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<T>(i % 1000);
+    const auto bytes = data.size() * sizeof(T);
+
+    suite.run("createBlock/" + type + "/zlib-2", bytes,
+              [&] { return createBlock("data", std::span<const T>(data), 1, tinyvtu::compression::zlib).size(); });
+    suite.run("createBlock/" + type + "/copy", bytes,
+              [&] { return createBlock("data", std::span<const T>(data), 1, tinyvtu::compression::none).size(); });
+    suite.run("createBlock/" + type + "/reference", bytes, [&]
+              { return createBlock("data", std::span<const T>(data), 1, tinyvtu::compression::none, true).size(); });
+}
+
+/**
+ * Compresses a constant field, whose equal blocks are compressed once, and the types of cells of one type, which are
+ * generated instead of stored.
+ */
+void benchmarkConstant(tinyvtu::bench::Suite &suite)
+{
+    const std::vector<double> zeros(suite.options().size / sizeof(double), 0.0);
+    suite.run("createBlock/float64-zeros/zlib-2", zeros.size() * sizeof(double),
+              [&]
+              { return createBlock("zeros", std::span<const double>(zeros), 1, tinyvtu::compression::zlib).size(); });
+
+    const auto cellCount = suite.options().size;
+    suite.run("createBlock/types-generated/zlib-2", cellCount,
+              [&]
+              {
+                  return createBlock(DataBlock::UInt8, "types", cellCount, 0, tinyvtu::compression::zlib,
+                                     [](std::uint64_t, std::span<std::uint8_t> destination)
+                                     { std::ranges::fill(destination, std::uint8_t{10}); })
+                      .size();
+              });
+}
+
+/**
+ * Adds a vector field stored in an array of structs or in one array per component, gathered block by block or copied
+ * into an interleaved vector first.
+ */
+void benchmarkGather(tinyvtu::bench::Suite &suite)
+{
+    struct Node
+    {
+        double pressure;
+        float velocity[3];
+        std::int32_t id;
+    };
+    const auto count = suite.options().size / (3 * sizeof(float));
+    std::vector<Node> nodes(count);
+    std::array<std::vector<float>, 3> components;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto x = static_cast<float>(i % 1000);
+        nodes[i].velocity[0] = x;
+        nodes[i].velocity[1] = 0.5f * x;
+        nodes[i].velocity[2] = static_cast<float>(i % 7);
+        for (std::size_t c = 0; c < 3; ++c) components[c].push_back(nodes[i].velocity[c]);
+    }
+
+    const auto bytes = count * 3 * sizeof(float);
+    auto addAndWrite = [&](const auto &add)
+    {
+        auto grid = tinyvtu::createImageData({count, 1, 1});
+        add(grid);
+        std::vector<std::uint8_t> buffer;
+        tinyvtu::VectorSink sink(buffer);
+        grid.write(sink);
+        return static_cast<std::uint64_t>(buffer.size());
+    };
+    auto copy = [&](tinyvtu::ImageData &grid)
+    {
+        std::vector<float> velocity;
+        velocity.reserve(3 * count);
+        for (const auto &node : nodes) velocity.insert(velocity.end(), node.velocity, node.velocity + 3);
+        grid.addPointData("velocity", velocity, 3);
+    };
+    auto strided = [&](tinyvtu::ImageData &grid)
+    { grid.addPointData("velocity", tinyvtu::StridedView<float>{nodes[0].velocity, count, sizeof(Node), 3}); };
+    auto soa = [&](tinyvtu::ImageData &grid)
+    {
+        const tinyvtu::ComponentsView<float> view{{components[0].data(), components[1].data(), components[2].data()},
+                                                  count};
+        grid.addPointData("velocity", view);
+    };
+    suite.run("addPointData+write/aos-copy/zlib-2", bytes, [&] { return addAndWrite(copy); });
+    suite.run("addPointData+write/aos-strided/zlib-2", bytes, [&] { return addAndWrite(strided); });
+    suite.run("addPointData+write/soa-components/zlib-2", bytes, [&] { return addAndWrite(soa); });
+}
+
+/**
+ * Adds the magnitude of a vector field, computed into a vector first or evaluated block by block while compressing.
+ */
+void benchmarkDerived(tinyvtu::bench::Suite &suite)
+{
+    const auto count = suite.options().size / sizeof(float);
+    std::vector<float> velocity(3 * count);
+    for (std::size_t i = 0; i < velocity.size(); ++i) velocity[i] = static_cast<float>(i % 1000) * 0.01f;
+    auto magnitude = [&](std::uint64_t i)
+    {
+        const auto *v = &velocity[3 * i];
+        return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    };
+
+    const auto bytes = count * sizeof(float);
+    auto addAndWrite = [&](const auto &add)
+    {
+        auto grid = tinyvtu::createImageData({count, 1, 1});
+        add(grid);
+        std::vector<std::uint8_t> buffer;
+        tinyvtu::VectorSink sink(buffer);
+        grid.write(sink);
+        return static_cast<std::uint64_t>(buffer.size());
+    };
+    auto computed = [&](tinyvtu::ImageData &grid)
+    {
+        std::vector<float> magnitudes(count);
+        for (std::size_t i = 0; i < count; ++i) magnitudes[i] = magnitude(i);
+        grid.addPointData("magnitude", std::span<const float>(magnitudes));
+    };
+    auto generated = [&](tinyvtu::ImageData &grid) { grid.addPointData("magnitude", magnitude); };
+    suite.run("addPointData+write/derived-vector/zlib-2", bytes, [&] { return addAndWrite(computed); });
+    suite.run("addPointData+write/derived-function/zlib-2", bytes, [&] { return addAndWrite(generated); });
+}
+
+/**
+ * A structured block of tetrahedra, five per cube, which resembles the connectivity of a typical mesh.
+ */
+struct Mesh
+{
+    std::vector<std::array<float, 3> > points;
+    std::vector<std::vector<std::int32_t> > cells;
+    std::vector<std::int32_t> connectivity;
+    std::vector<std::int32_t> offsets;
+    std::vector<tinyvtu::CellType> types;
+};
+
+Mesh createMesh(std::uint64_t size)
+{
+    // Each cube adds roughly one point of 12 bytes and five cells of 4 indices
+    const auto n = static_cast<std::int32_t>(std::max(2.0, std::cbrt(static_cast<double>(size) / 92.0)));
+    Mesh mesh;
+    auto index = [n](std::int32_t x, std::int32_t y, std::int32_t z) { return (z * n + y) * n + x; };
+    for (std::int32_t z = 0; z < n; ++z)
+        for (std::int32_t y = 0; y < n; ++y)
+            for (std::int32_t x = 0; x < n; ++x)
+                mesh.points.push_back({static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+    for (std::int32_t z = 0; z + 1 < n; ++z)
+        for (std::int32_t y = 0; y + 1 < n; ++y)
+            for (std::int32_t x = 0; x + 1 < n; ++x)
+            {
+                const std::int32_t c[8] = {index(x, y, z),         index(x + 1, y, z),         index(x + 1, y + 1, z),
+                                           index(x, y + 1, z),     index(x, y, z + 1),         index(x + 1, y, z + 1),
+                                           index(x + 1, y + 1, z + 1), index(x, y + 1, z + 1)};
+                for (const auto &tetra : {std::array{c[0], c[1], c[3], c[4]}, std::array{c[1], c[2], c[3], c[6]},
+                                          std::array{c[1], c[4], c[5], c[6]}, std::array{c[3], c[4], c[6], c[7]},
+                                          std::array{c[1], c[3], c[4], c[6]}})
+                {
+                    mesh.cells.emplace_back(tetra.begin(), tetra.end());
+                    mesh.connectivity.insert(mesh.connectivity.end(), tetra.begin(), tetra.end());
+                    mesh.offsets.push_back(static_cast<std::int32_t>(mesh.connectivity.size()));
+                    mesh.types.push_back(tinyvtu::CellType::Tetra);
+                }
+            }
+    return mesh;
+}
+
+std::uint64_t meshBytes(const Mesh &mesh)
+{
+    return mesh.points.size() * sizeof(mesh.points[0]) + mesh.connectivity.size() * sizeof(std::int32_t) +
+           mesh.offsets.size() * sizeof(std::int32_t) + mesh.types.size();
+}
+
+void benchmarkCreateGrid(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    for (const auto &[name, compression] : {std::pair{"zlib-2", tinyvtu::compression::zlib},
+                                            std::pair{"none", tinyvtu::compression::none}})
+    {
+        suite.run(std::string("createGrid/cells/") + name, meshBytes(mesh),
+                  [&]
+                  {
+                      static_cast<void>(tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Tetra, mesh.cells,
+                                                            compression));
+                      return std::uint64_t{0};
+                  });
+        suite.run(std::string("createGrid/csr/") + name, meshBytes(mesh),
+                  [&]
+                  {
+                      static_cast<void>(tinyvtu::createGrid(std::span(mesh.points), std::span(mesh.connectivity),
+                                                            std::span(mesh.offsets), std::span(mesh.types),
+                                                            compression));
+                      return std::uint64_t{0};
+                  });
+    }
+}
+
+/**
+ * Emits the XML header of a piece with many arrays, which is independent of the array sizes.
+ */
+void benchmarkXMLWriter(tinyvtu::bench::Suite &suite)
+{
+    const auto compression = tinyvtu::compression::zlib;
+    const std::vector<float> values(16);
+    const auto block = createBlock("field", values, 1, compression);
+
+    PieceDescription piece{1000, 1000, {&block, 0}, {&block, 0}, {&block, 0}, {&block, 0}, {}, {}};
+    for (std::uint64_t i = 0; i < 100; ++i)
+    {
+        piece.point_data.push_back({&block, i * 1000});
+        piece.cell_data.push_back({&block, i * 1000});
+    }
+
+    std::ostringstream stream;
+    {
+        XMLWriter writer(stream);
+        writeHeader(writer, compression, HeaderType::UInt32, piece);
+    }
+    const auto bytes = stream.str().size();
+    suite.run("XMLWriter/writeHeader/200-arrays", bytes,
+              [&]
+              {
+                  std::ostringstream output;
+                  XMLWriter writer(output);
+                  writeHeader(writer, compression, HeaderType::UInt32, piece);
+                  writer.flush();
+                  return static_cast<std::uint64_t>(output.tellp());
+              });
+}
+
+/**
+ * Writes a whole file from a grid whose arrays are already compressed, i.e. measures assembly and file output.
+ */
+void benchmarkWrite(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench.vtu";
+    std::vector<float> field(mesh.points.size() * 3);
+    for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i % 977);
+
+    for (const auto &[name, compression] : {std::pair{"zlib-2", tinyvtu::compression::zlib},
+                                            std::pair{"none", tinyvtu::compression::none}})
+    {
+        auto grid = tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Tetra, mesh.cells, compression);
+        grid.addPointData("velocity", std::span<const float>(field), 3);
+        suite.run(std::string("write/") + name, meshBytes(mesh) + field.size() * sizeof(float),
+                  [&]
+                  {
+                      grid.write(path);
+                      return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+                  });
+        suite.run(std::string("createGrid+write/") + name, meshBytes(mesh) + field.size() * sizeof(float),
+                  [&]
+                  {
+                      auto fresh = tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Tetra, mesh.cells, compression);
+                      fresh.addPointData("velocity", std::span<const float>(field), 3);
+                      fresh.write(path);
+                      return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+                  });
+    }
+    std::filesystem::remove(path);
+}
+
+/**
+ * Encodes a buffer to base64 with the XMLWriter, and writes and reads the grid of benchmarkWrite with the base64
+ * encodings, which are compared to the raw rows of write/ and read/.
+ */
+void benchmarkBase64(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    std::vector<std::uint8_t> bytes(suite.options().size);
+    for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<std::uint8_t>(i * 31 + (i >> 12));
+    suite.run("XMLWriter/writeBase64", bytes.size(),
+              [&]
+              {
+                  std::ostringstream output;
+                  {
+                      XMLWriter writer(output);
+                      writer.writeBase64(std::array{std::span<const std::uint8_t>(bytes)}, 0);
+                  }
+                  return static_cast<std::uint64_t>(output.tellp());
+              });
+
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench_base64.vtu";
+    std::vector<float> field(mesh.points.size() * 3);
+    for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i % 977);
+    for (const auto &[name, compression] : {std::pair{"zlib-2", tinyvtu::compression::zlib},
+                                            std::pair{"none", tinyvtu::compression::none}})
+    {
+        for (const auto &[encodingName, encoding] :
+             {std::pair{"base64-appended", tinyvtu::compression::Encoding::AppendedBase64},
+              std::pair{"base64-inline", tinyvtu::compression::Encoding::InlineBase64}})
+        {
+            auto settings = compression;
+            settings.encoding = encoding;
+            auto grid = tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Tetra, mesh.cells, settings);
+            grid.addPointData("velocity", std::span<const float>(field), 3);
+            suite.run(std::string("write/") + encodingName + "/" + name, meshBytes(mesh) + field.size() * sizeof(float),
+                      [&]
+                      {
+                          grid.write(path);
+                          return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+                      });
+            grid.write(path);
+            suite.run(std::string("read/") + encodingName + "/" + name, meshBytes(mesh) + field.size() * sizeof(float),
+                      [&]
+                      {
+                          const auto dataset = tinyvtu::read(path);
+                          return static_cast<std::uint64_t>(dataset.points.bytes.size() +
+                                                            dataset.pointData.front().bytes.size());
+                      });
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+/**
+ * Writes a grid with many small arrays from the CSR arrays of the mesh, compressing every array when it is added or
+ * all of them together in write().
+ */
+void benchmarkDeferred(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench_deferred.vtu";
+    constexpr std::size_t arrayCount = 32;
+    std::vector<std::vector<float> > fields(arrayCount, std::vector<float>(mesh.points.size()));
+    for (std::size_t a = 0; a < arrayCount; ++a)
+        for (std::size_t i = 0; i < mesh.points.size(); ++i) fields[a][i] = static_cast<float>((i * (a + 1)) % 977);
+    const auto bytes = meshBytes(mesh) + arrayCount * mesh.points.size() * sizeof(float);
+
+    for (const bool deferred : {false, true})
+    {
+        auto compression = tinyvtu::compression::zlib;
+        compression.threads = 0;
+        compression.deferred = deferred;
+        suite.run(std::string("createGrid+write/32-arrays/threads=all/") + (deferred ? "deferred" : "eager"), bytes,
+                  [&]
+                  {
+                      auto grid = tinyvtu::createGrid(std::span<const std::array<float, 3> >(mesh.points),
+                                                      std::span<const std::int32_t>(mesh.connectivity),
+                                                      std::span<const std::int32_t>(mesh.offsets),
+                                                      std::span<const tinyvtu::CellType>(mesh.types), compression);
+                      for (std::size_t a = 0; a < arrayCount; ++a)
+                          grid.addPointData("field" + std::to_string(a), std::span<const float>(fields[a]));
+                      grid.write(path);
+                      return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+                  });
+    }
+    std::filesystem::remove(path);
+}
+
+/**
+ * Writes a field on the points of the mesh as unstructured hexahedra, as a structured grid, and as an image, whose
+ * topology is implicit. The sizes of the files follow from output_bytes.
+ */
+void benchmarkStructured(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench_structured";
+    const auto n = static_cast<std::uint64_t>(std::llround(std::cbrt(static_cast<double>(mesh.points.size()))));
+    const std::array dimensions{n, n, n};
+    std::vector<float> field(mesh.points.size());
+    for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i % 977);
+
+    std::vector<std::vector<std::int32_t> > hexahedra;
+    auto index = [n](std::uint64_t x, std::uint64_t y, std::uint64_t z)
+    { return static_cast<std::int32_t>((z * n + y) * n + x); };
+    for (std::uint64_t z = 0; z + 1 < n; ++z)
+        for (std::uint64_t y = 0; y + 1 < n; ++y)
+            for (std::uint64_t x = 0; x + 1 < n; ++x)
+                hexahedra.push_back({index(x, y, z), index(x + 1, y, z), index(x + 1, y + 1, z), index(x, y + 1, z),
+                                     index(x, y, z + 1), index(x + 1, y, z + 1), index(x + 1, y + 1, z + 1),
+                                     index(x, y + 1, z + 1)});
+
+    const auto bytes = field.size() * sizeof(float);
+    auto writeGrid = [&](auto &&grid)
+    {
+        grid.addPointData("field", std::span<const float>(field));
+        grid.write(path);
+        return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+    };
+    suite.run("createGrid+write/hexahedra/zlib-2", bytes,
+              [&] { return writeGrid(tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Hexahedron, hexahedra)); });
+    suite.run("createStructuredGrid+write/zlib-2", bytes,
+              [&] { return writeGrid(tinyvtu::createStructuredGrid(dimensions, std::span(mesh.points))); });
+    suite.run("createImageData+write/zlib-2", bytes,
+              [&] { return writeGrid(tinyvtu::createImageData(dimensions)); });
+    std::filesystem::remove(path);
+}
+
+/**
+ * Writes the points of the mesh as particles with a field, as an unstructured grid of vertices and as a PolyData with
+ * generated vertices or without cells.
+ */
+void benchmarkPointCloud(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench_particles";
+    std::vector<float> field(mesh.points.size());
+    for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i % 977);
+    std::vector<std::vector<std::int32_t> > vertices(mesh.points.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) vertices[i] = {static_cast<std::int32_t>(i)};
+
+    const auto bytes = mesh.points.size() * sizeof(mesh.points[0]) + field.size() * sizeof(float);
+    auto writeGrid = [&](auto &&grid)
+    {
+        grid.addPointData("field", std::span<const float>(field));
+        grid.write(path);
+        return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+    };
+    suite.run("createGrid+write/vertices/zlib-2", bytes,
+              [&] { return writeGrid(tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Vertex, vertices)); });
+    suite.run("createPolyData+write/vertices/zlib-2", bytes,
+              [&]
+              { return writeGrid(tinyvtu::createPolyData(std::span(mesh.points), tinyvtu::compression::zlib, true)); });
+    suite.run("createPolyData+write/points/zlib-2", bytes,
+              [&] { return writeGrid(tinyvtu::createPolyData(std::span(mesh.points))); });
+    std::filesystem::remove(path);
+}
+
+/**
+ * Reads a whole file back, i.e. measures parsing and parallel decompression of all arrays.
+ */
+void benchmarkRead(tinyvtu::bench::Suite &suite, const Mesh &mesh)
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyvtu_bench_read.vtu";
+    std::vector<float> field(mesh.points.size() * 3);
+    for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i % 977);
+
+    for (const auto &[name, compression] : {std::pair{"zlib-2", tinyvtu::compression::zlib},
+                                            std::pair{"none", tinyvtu::compression::none}})
+    {
+        auto grid = tinyvtu::createGrid(mesh.points, tinyvtu::CellType::Tetra, mesh.cells, compression);
+        grid.addPointData("velocity", std::span<const float>(field), 3);
+        grid.write(path);
+        suite.run(std::string("read/") + name, meshBytes(mesh) + field.size() * sizeof(float),
+                  [&]
+                  {
+                      const auto dataset = tinyvtu::read(path);
+                      return static_cast<std::uint64_t>(dataset.points.bytes.size() +
+                                                        dataset.pointData.front().bytes.size());
+                  });
+    }
+    std::filesystem::remove(path);
+}
+}  // namespace
+
+namespace tinyvtu::bench {
+void benchmarkGrid(Suite &suite)
+{
+    benchmarkCreateBlock<float>(suite, "float32");
+    benchmarkCreateBlock<double>(suite, "float64");
+    benchmarkCreateBlock<std::uint8_t>(suite, "uint8");
+    benchmarkCreateBlock<std::int32_t>(suite, "int32");
+    benchmarkCreateBlock<std::int64_t>(suite, "int64");
+    benchmarkConstant(suite);
+    benchmarkGather(suite);
+    benchmarkDerived(suite);
+
+    const auto mesh = createMesh(suite.options().size);
+    benchmarkCreateGrid(suite, mesh);
+    benchmarkXMLWriter(suite);
+    benchmarkWrite(suite, mesh);
+    benchmarkBase64(suite, mesh);
+    benchmarkDeferred(suite, mesh);
+    benchmarkStructured(suite, mesh);
+    benchmarkPointCloud(suite, mesh);
+    benchmarkRead(suite, mesh);
+}
+}  // namespace tinyvtu::bench
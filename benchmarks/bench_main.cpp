@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "Benchmark.hpp"
+
+namespace {
+std::atomic<std::uint64_t> allocations = 0;
+}  // namespace
+
+// The global allocation functions are replaced to count the allocations of each benchmark
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+std::uint64_t tinyvtu::bench::allocationCount() { return allocations.load(std::memory_order_relaxed); }
+
+namespace {
+void printUsage()
+{
+    std::cerr << "usage: tinyvtu_bench [--json] [--filter <text>] [--min-time <seconds>] [--size <MiB>]\n";
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    tinyvtu::bench::Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--json")
+            options.json = true;
+        else if (argument == "--filter" && hasValue)
+            options.filter = argv[++i];
+        else if (argument == "--min-time" && hasValue)
+            options.min_time = std::stod(argv[++i]);
+        else if (argument == "--size" && hasValue)
+            options.size = std::stoull(argv[++i]) * 1024 * 1024;
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    try
+    {
+        tinyvtu::bench::Suite suite(options);
+        tinyvtu::bench::benchmarkCompression(suite);
+        tinyvtu::bench::benchmarkGrid(suite);
+        suite.print(std::cout);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include "internal/Base64.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TINYVTU_BASE64_X86 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TINYVTU_BASE64_NEON 1
+#endif
+
+namespace tinyvtu::internal {
+namespace {
+constexpr std::string_view Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * The two characters encoding each 12 bit value. Looking up pairs halves the lookups per group of 3 bytes, and the
+ * table of 8 KiB stays in the L1 cache.
+ */
+constexpr auto Pairs = []
+{
+    std::array<std::array<char, 2>, 4096> pairs{};
+    for (std::size_t i = 0; i < pairs.size(); ++i) pairs[i] = {Alphabet[i >> 6], Alphabet[i & 63]};
+    return pairs;
+}();
+
+/**
+ * The 6 bit value of each character, 64 for characters outside the alphabet.
+ */
+constexpr auto Values = []
+{
+    std::array<std::uint8_t, 256> values{};
+    values.fill(64);
+    for (std::size_t i = 0; i < Alphabet.size(); ++i)
+        values[static_cast<std::uint8_t>(Alphabet[i])] = static_cast<std::uint8_t>(i);
+    return values;
+}();
+
+/**
+ * Loads 8 bytes with the first one in the most significant bits.
+ */
+std::uint64_t loadBigEndian(const std::uint8_t *source)
+{
+    std::uint64_t value;
+    std::memcpy(&value, source, sizeof(value));
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        // Compiles to a single bswap
+        value = ((value & 0x00000000ffffffffull) << 32) | ((value & 0xffffffff00000000ull) >> 32);
+        value = ((value & 0x0000ffff0000ffffull) << 16) | ((value & 0xffff0000ffff0000ull) >> 16);
+        value = ((value & 0x00ff00ff00ff00ffull) << 8) | ((value & 0xff00ff00ff00ff00ull) >> 8);
+    }
+    return value;
+}
+
+/**
+ * Encodes the bytes [input, end) with the Pairs table, on CPUs without a vector kernel and for the bytes left by the
+ * kernels.
+ */
+void encodeTable(const std::uint8_t *input, const std::uint8_t *end, std::uint8_t *destination)
+{
+    // Two groups of 3 bytes per iteration from one load of 8 bytes, the last 2 bytes are loaded but not used
+    for (; end - input >= 8; input += 6, destination += 8)
+    {
+        const auto bits = loadBigEndian(input);
+        std::memcpy(destination, Pairs[(bits >> 52) & 0xfff].data(), 2);
+        std::memcpy(destination + 2, Pairs[(bits >> 40) & 0xfff].data(), 2);
+        std::memcpy(destination + 4, Pairs[(bits >> 28) & 0xfff].data(), 2);
+        std::memcpy(destination + 6, Pairs[(bits >> 16) & 0xfff].data(), 2);
+    }
+    for (; end - input >= 3; input += 3, destination += 4)
+    {
+        const auto bits = std::uint32_t{input[0]} << 16 | std::uint32_t{input[1]} << 8 | input[2];
+        std::memcpy(destination, Pairs[bits >> 12].data(), 2);
+        std::memcpy(destination + 2, Pairs[bits & 0xfff].data(), 2);
+    }
+    if (end == input) return;
+
+    // The last group of 1 or 2 bytes is padded with '='
+    const auto bits = std::uint32_t{input[0]} << 16 | (end - input == 2 ? std::uint32_t{input[1]} << 8 : 0);
+    destination[0] = Alphabet[bits >> 18];
+    destination[1] = Alphabet[(bits >> 12) & 63];
+    destination[2] = end - input == 2 ? Alphabet[(bits >> 6) & 63] : '=';
+    destination[3] = '=';
+}
+
+#if defined(TINYVTU_BASE64_X86)
+// The kernels for SSSE3 and AVX2 follow W. Muła and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions". Each 128-bit lane spreads 12 bytes to 16 indices of 6 bits, which are shifted into the alphabet.
+
+/**
+ * Encodes groups of 12 bytes with SSSE3 as long as 16 bytes can be loaded.
+ *
+ * @return  The number of bytes encoded, a multiple of 12
+ */
+__attribute__((target("ssse3"))) std::size_t encodeSsse3(std::span<const std::uint8_t> source,
+                                                         std::uint8_t *destination)
+{
+    const auto spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const auto shifts = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                      '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    std::size_t done = 0;
+    for (; done + 16 <= source.size(); done += 12, destination += 16)
+    {
+        const auto bytes =
+            _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source.data() + done)), spread);
+        // Moves the 6-bit values of each group of 3 bytes to the low bits of 4 bytes with two multiplications
+        const auto high = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const auto low = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const auto indices = _mm_or_si128(high, low);
+        // 0 for 26-51, 1-10 for the digits, 11 and 12 for '+' and '/', and 13 for the upper case letters
+        auto ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        const auto characters = _mm_add_epi8(_mm_shuffle_epi8(shifts, ranges), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination), characters);
+    }
+    return done;
+}
+
+/**
+ * Encodes groups of 24 bytes with AVX2 as long as 28 bytes can be loaded, as encodeSsse3 does in each lane.
+ *
+ * @return  The number of bytes encoded, a multiple of 24
+ */
+__attribute__((target("avx2"))) std::size_t encodeAvx2(std::span<const std::uint8_t> source,
+                                                       std::uint8_t *destination)
+{
+    const auto spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7,
+                                         6, 8, 7, 10, 9, 11, 10);
+    const auto shifts = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                         'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    std::size_t done = 0;
+    for (; done + 28 <= source.size(); done += 24, destination += 32)
+    {
+        // The lanes start at the first and at the second group of 12 bytes
+        const auto *input = source.data() + done;
+        const auto lanes =
+            _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input))),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 12)), 1);
+        const auto bytes = _mm256_shuffle_epi8(lanes, spread);
+        const auto high = _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0fc0fc00)),
+                                             _mm256_set1_epi32(0x04000040));
+        const auto low = _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003f03f0)),
+                                            _mm256_set1_epi32(0x01000010));
+        const auto indices = _mm256_or_si256(high, low);
+        auto ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        ranges = _mm256_or_si256(
+            ranges, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        const auto characters = _mm256_add_epi8(_mm256_shuffle_epi8(shifts, ranges), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination), characters);
+    }
+    return done;
+}
+
+using VectorEncoder = std::size_t (*)(std::span<const std::uint8_t>, std::uint8_t *);
+
+/**
+ * Returns the widest kernel the CPU supports, nullptr if it supports none.
+ */
+VectorEncoder vectorEncoder()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return encodeAvx2;
+    if (__builtin_cpu_supports("ssse3")) return encodeSsse3;
+    return nullptr;
+}
+#elif defined(TINYVTU_BASE64_NEON)
+/**
+ * Encodes groups of 48 bytes with NEON, which loads the first, second, and third bytes of 16 groups into 3 vectors and
+ * looks the 4 vectors of indices up in the alphabet.
+ *
+ * @return  The number of bytes encoded, a multiple of 48
+ */
+std::size_t encodeNeon(std::span<const std::uint8_t> source, std::uint8_t *destination)
+{
+    const auto *alphabet = reinterpret_cast<const std::uint8_t *>(Alphabet.data());
+    const uint8x16x4_t table{
+        {vld1q_u8(alphabet), vld1q_u8(alphabet + 16), vld1q_u8(alphabet + 32), vld1q_u8(alphabet + 48)}};
+    const auto low2 = vdupq_n_u8(0x30), low4 = vdupq_n_u8(0x3c), low6 = vdupq_n_u8(0x3f);
+    std::size_t done = 0;
+    for (; done + 48 <= source.size(); done += 48, destination += 64)
+    {
+        const auto bytes = vld3q_u8(source.data() + done);
+        uint8x16x4_t indices;
+        indices.val[0] = vshrq_n_u8(bytes.val[0], 2);
+        indices.val[1] = vorrq_u8(vshrq_n_u8(bytes.val[1], 4), vandq_u8(vshlq_n_u8(bytes.val[0], 4), low2));
+        indices.val[2] = vorrq_u8(vshrq_n_u8(bytes.val[2], 6), vandq_u8(vshlq_n_u8(bytes.val[1], 2), low4));
+        indices.val[3] = vandq_u8(bytes.val[2], low6);
+        for (auto &value : indices.val) value = vqtbl4q_u8(table, value);
+        vst4q_u8(destination, indices);
+    }
+    return done;
+}
+#endif
+}  // namespace
+
+void encodeBase64(std::span<const std::uint8_t> source, std::uint8_t *destination)
+{
+    std::size_t done = 0;
+#if defined(TINYVTU_BASE64_X86)
+    static const auto encodeVectors = vectorEncoder();
+    if (encodeVectors) done = encodeVectors(source, destination);
+#elif defined(TINYVTU_BASE64_NEON)
+    done = encodeNeon(source, destination);
+#endif
+    encodeTable(source.data() + done, source.data() + source.size(), destination + done / 3 * 4);
+}
+
+bool decodeBase64(std::string_view text, Data &destination)
+{
+    if (text.size() % 4 != 0) return false;
+    if (text.empty()) return true;
+    // Padding is only allowed in the last group
+    const auto padding = static_cast<std::size_t>(text.back() == '=') + (text[text.size() - 2] == '=');
+    const auto offset = destination.size();
+    destination.resize(offset + text.size() / 4 * 3);
+    auto *output = destination.data() + offset;
+
+    const auto *input = reinterpret_cast<const std::uint8_t *>(text.data());
+    const auto *last = input + text.size() - 4;
+    std::uint32_t invalid = 0;
+    for (; input != last; input += 4, output += 3)
+    {
+        const std::uint32_t a = Values[input[0]], b = Values[input[1]], c = Values[input[2]], d = Values[input[3]];
+        // Characters outside the alphabet have the bit 6 set, which is checked once at the end
+        invalid |= a | b | c | d;
+        const auto bits = a << 18 | b << 12 | c << 6 | d;
+        output[0] = static_cast<std::uint8_t>(bits >> 16);
+        output[1] = static_cast<std::uint8_t>(bits >> 8);
+        output[2] = static_cast<std::uint8_t>(bits);
+    }
+
+    std::uint32_t bits = 0;
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+        const std::uint32_t value = j < 4 - padding ? Values[input[j]] : 0;
+        invalid |= value;
+        bits = bits << 6 | value;
+    }
+    output[0] = static_cast<std::uint8_t>(bits >> 16);
+    if (padding < 2) output[1] = static_cast<std::uint8_t>(bits >> 8);
+    if (padding < 1) output[2] = static_cast<std::uint8_t>(bits);
+    destination.resize(destination.size() - padding);
+    return (invalid & 64) == 0;
+}
+}  // namespace tinyvtu::internal
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "internal/DataBlock.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * Returns the number of characters encoding bytes in base64, including the padding.
+ *
+ * @param size  The number of bytes
+ * @return      4 characters per started group of 3 bytes
+ */
+constexpr std::uint64_t base64Size(std::uint64_t size) { return (size + 2) / 3 * 4; }
+
+/**
+ * Encodes bytes to base64.
+ *
+ * Uses AVX2 or SSSE3 on x86-64 as the CPU supports them, NEON on AArch64, and a table of character pairs otherwise and
+ * for the bytes left by the vector kernels.
+ *
+ * Each group of 3 bytes is encoded independently, hence a stream can be encoded in parts whose sizes are multiples of
+ * 3, e.g. by several threads. Only the last part is padded if its size is not a multiple of 3.
+ *
+ * @param source       The bytes to encode
+ * @param destination  Receives base64Size(source.size()) characters
+ */
+void encodeBase64(std::span<const std::uint8_t> source, std::uint8_t *destination);
+
+/**
+ * Decodes base64 and appends the bytes to destination.
+ *
+ * @param text         The characters, whose number must be a multiple of 4, with padding at the end only
+ * @param destination  The buffer the decoded bytes are appended to
+ * @return             false if the text is not valid base64, the bytes appended to destination are then undefined
+ */
+bool decodeBase64(std::string_view text, Data &destination);
+}  // namespace tinyvtu::internal
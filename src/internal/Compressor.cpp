@@ -0,0 +1,312 @@
+#include "internal/Compressor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+#include "zlib.h"
+
+#ifdef TINYVTU_WITH_LZ4
+#include "lz4.h"
+#endif
+
+#ifdef TINYVTU_WITH_LZMA
+#include "lzma.h"
+#endif
+
+#ifdef TINYVTU_WITH_LIBDEFLATE
+#include "libdeflate.h"
+#endif
+
+#ifndef TINYVTU_DEFAULT_DEFLATE
+#define TINYVTU_DEFAULT_DEFLATE ZLib
+#endif
+
+namespace tinyvtu::internal {
+namespace {
+[[noreturn, maybe_unused]] void throwUnavailable(const char *codec)
+{
+    throw std::invalid_argument(std::string("[tinyvtu::compressBlock] ") + codec +
+                                " compression is not available, enable it when building tinyvtu");
+}
+
+[[noreturn]] void throwFailed(const char *codec, std::uint64_t size, long long error)
+{
+    throw std::runtime_error(std::string("[tinyvtu::compressBlock] ") + codec +
+                             " compression failed for block of size " + std::to_string(size) + " with error code " +
+                             std::to_string(error));
+}
+
+compression::Deflate resolveDeflate(compression::Deflate deflate)
+{
+    return deflate == compression::Deflate::Default ? compression::Deflate::TINYVTU_DEFAULT_DEFLATE : deflate;
+}
+
+#ifdef TINYVTU_WITH_LIBDEFLATE
+/**
+ * Returns a compressor of the calling thread for the passed level, allocating a compressor per block is expensive.
+ */
+libdeflate_compressor *libdeflateCompressor(std::int32_t level)
+{
+    struct Deleter
+    {
+        void operator()(libdeflate_compressor *compressor) const { libdeflate_free_compressor(compressor); }
+    };
+    // libdeflate supports levels 0-12, tinyvtu passes zlib levels 0-9 as is
+    thread_local std::array<std::unique_ptr<libdeflate_compressor, Deleter>, 13> compressors;
+    auto &compressor = compressors[static_cast<std::size_t>(std::clamp(level, 0, 12))];
+    if (!compressor) compressor.reset(libdeflate_alloc_compressor(std::clamp(level, 0, 12)));
+    if (!compressor) throw std::bad_alloc();
+    return compressor.get();
+}
+#endif
+
+std::uint64_t deflateBound(std::uint64_t size, const compression::Info &compression)
+{
+    switch (resolveDeflate(compression.deflate))
+    {
+    case compression::Deflate::LibDeflate:
+#ifdef TINYVTU_WITH_LIBDEFLATE
+        return libdeflate_zlib_compress_bound(libdeflateCompressor(compression.level), static_cast<std::size_t>(size));
+#else
+        throwUnavailable("libdeflate");
+#endif
+    case compression::Deflate::Default:
+    case compression::Deflate::ZLib:
+        break;
+    }
+    // Adaptive compression ends the deflate block of its sample early, which adds a few bytes of block headers
+    return compressBound(static_cast<uLong>(size)) + (compression.minRatio > 0 ? 16 : 0);
+}
+
+std::uint64_t deflateBlock(const std::uint8_t *source, std::uint64_t size, std::uint8_t *destination,
+                           std::uint64_t capacity, const compression::Info &compression)
+{
+    switch (resolveDeflate(compression.deflate))
+    {
+    case compression::Deflate::LibDeflate:
+    {
+#ifdef TINYVTU_WITH_LIBDEFLATE
+        const auto compressedSize =
+            libdeflate_zlib_compress(libdeflateCompressor(compression.level), source, static_cast<std::size_t>(size),
+                                     destination, static_cast<std::size_t>(capacity));
+        if (compressedSize == 0) throwFailed("libdeflate", size, 0);
+        return compressedSize;
+#else
+        throwUnavailable("libdeflate");
+#endif
+    }
+    case compression::Deflate::Default:
+    case compression::Deflate::ZLib:
+        break;
+    }
+    uLongf compressedSize = static_cast<uLongf>(capacity);
+    const auto ret = compress2(destination, &compressedSize, source, static_cast<uLong>(size), compression.level);
+    if (ret != Z_OK) throwFailed("zlib", size, ret);
+    return compressedSize;
+}
+
+/**
+ * The number of bytes at the start of a block which are compressed to estimate the ratio of the block.
+ */
+constexpr std::uint64_t adaptiveSampleSize = 4096;
+
+/**
+ * Compresses a block with zlib, or stores all but a sample at its start if the sample does not reach
+ * compression.minRatio.
+ *
+ * The sample is the first deflate block of the stream, hence its compressed bytes are kept in either case. Only stock
+ * zlib can switch levels within a stream, so it is used unless another engine is selected explicitly.
+ */
+std::uint64_t deflateAdaptive(const std::uint8_t *source, std::uint64_t size, std::uint8_t *destination,
+                              std::uint64_t capacity, const compression::Info &compression)
+{
+    if (compression.codec != compression::Codec::ZLib || compression.deflate == compression::Deflate::LibDeflate)
+        throw std::invalid_argument("[tinyvtu::compressBlock] minRatio requires the zlib codec and the zlib engine");
+
+    // Nothing is left to store if the sample is the whole block
+    const auto sampleSize = std::min(size, adaptiveSampleSize);
+    if (sampleSize == size) return deflateBlock(source, size, destination, capacity, compression);
+
+    z_stream stream{};
+    auto ret = deflateInit(&stream, compression.level);
+    if (ret != Z_OK) throwFailed("zlib", size, ret);
+    struct End
+    {
+        z_stream &stream;
+        ~End() { deflateEnd(&stream); }
+    } end{stream};
+
+    stream.next_in = const_cast<Bytef *>(source);
+    stream.avail_in = static_cast<uInt>(sampleSize);
+    stream.next_out = destination;
+    stream.avail_out = static_cast<uInt>(capacity);
+    // Z_BLOCK ends the deflate block of the sample without padding, so the output so far is the compressed sample
+    ret = deflate(&stream, Z_BLOCK);
+    if (ret != Z_OK) throwFailed("zlib", size, ret);
+    if (static_cast<double>(sampleSize) < compression.minRatio * static_cast<double>(stream.total_out))
+    {
+        ret = deflateParams(&stream, 0, Z_DEFAULT_STRATEGY);
+        if (ret != Z_OK) throwFailed("zlib", size, ret);
+    }
+
+    stream.avail_in = static_cast<uInt>(size - sampleSize);
+    ret = deflate(&stream, Z_FINISH);
+    if (ret != Z_STREAM_END) throwFailed("zlib", size, ret);
+    return stream.total_out;
+}
+}  // namespace
+
+std::uint32_t resolveBlockSize(const compression::Info &compression)
+{
+    if (compression.blockSize != 0) return compression.blockSize;
+
+    // A block, its output, and the state of the compressor (about 256 KiB for zlib) should stay in the L2 cache, which
+    // is shared by two threads on many machines. The result is the same for all arrays, hence it is computed once.
+    static const std::uint32_t cacheBlockSize = []
+    {
+        long cacheSize = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        if (cacheSize <= 0) return std::uint32_t{32768};
+        return std::clamp(std::bit_floor(static_cast<std::uint32_t>(cacheSize / 64)), 16384u, 65536u);
+    }();
+    return cacheBlockSize;
+}
+
+const char *compressorName(const compression::Info &compression)
+{
+    switch (compression.codec)
+    {
+    case compression::Codec::LZ4:
+        return "vtkLZ4DataCompressor";
+    case compression::Codec::LZMA:
+        return "vtkLZMADataCompressor";
+    case compression::Codec::ZLib:
+        break;
+    }
+    return "vtkZLibDataCompressor";
+}
+
+std::uint64_t compressedBlockBound(std::uint64_t size, const compression::Info &compression)
+{
+    switch (compression.codec)
+    {
+    case compression::Codec::LZ4:
+#ifdef TINYVTU_WITH_LZ4
+        return static_cast<std::uint64_t>(LZ4_compressBound(static_cast<int>(size)));
+#else
+        throwUnavailable("LZ4");
+#endif
+    case compression::Codec::LZMA:
+#ifdef TINYVTU_WITH_LZMA
+        return lzma_stream_buffer_bound(static_cast<std::size_t>(size));
+#else
+        throwUnavailable("LZMA");
+#endif
+    case compression::Codec::ZLib:
+        break;
+    }
+    return deflateBound(size, compression);
+}
+
+std::uint64_t compressBlock(const std::uint8_t *source, std::uint64_t size, std::uint8_t *destination,
+                            std::uint64_t capacity, const compression::Info &compression)
+{
+    if (compression.minRatio > 0) return deflateAdaptive(source, size, destination, capacity, compression);
+    switch (compression.codec)
+    {
+    case compression::Codec::LZ4:
+    {
+#ifdef TINYVTU_WITH_LZ4
+        // Higher levels compress better, which LZ4 expresses as lower acceleration
+        const int acceleration = std::max(1, 10 - compression.level);
+        const auto compressedSize =
+            LZ4_compress_fast(reinterpret_cast<const char *>(source), reinterpret_cast<char *>(destination),
+                              static_cast<int>(size), static_cast<int>(capacity), acceleration);
+        if (compressedSize <= 0) throwFailed("LZ4", size, compressedSize);
+        return static_cast<std::uint64_t>(compressedSize);
+#else
+        throwUnavailable("LZ4");
+#endif
+    }
+    case compression::Codec::LZMA:
+    {
+#ifdef TINYVTU_WITH_LZMA
+        // The xz stream format and check are the ones written by vtkLZMADataCompressor
+        std::size_t compressedSize = 0;
+        const auto ret = lzma_easy_buffer_encode(static_cast<std::uint32_t>(std::clamp(compression.level, 0, 9)),
+                                                 LZMA_CHECK_CRC32, nullptr, source, static_cast<std::size_t>(size),
+                                                 destination, &compressedSize, static_cast<std::size_t>(capacity));
+        if (ret != LZMA_OK) throwFailed("LZMA", size, ret);
+        return compressedSize;
+#else
+        throwUnavailable("LZMA");
+#endif
+    }
+    case compression::Codec::ZLib:
+        break;
+    }
+    return deflateBlock(source, size, destination, capacity, compression);
+}
+
+void decompressBlock(compression::Codec codec, const std::uint8_t *source, std::uint64_t size,
+                     std::uint8_t *destination, std::uint64_t capacity)
+{
+    auto throwCorrupt = [&](const char *name)
+    {
+        throw std::runtime_error(std::string("[tinyvtu::decompressBlock] ") + name + " block of size " +
+                                 std::to_string(size) + " does not decompress to " + std::to_string(capacity) +
+                                 " bytes");
+    };
+    switch (codec)
+    {
+    case compression::Codec::LZ4:
+    {
+#ifdef TINYVTU_WITH_LZ4
+        // The sizes of LZ4 blocks are ints, larger ones cannot be written by vtkLZ4DataCompressor either
+        constexpr auto MaxSize = static_cast<std::uint64_t>(std::numeric_limits<int>::max());
+        if (size > MaxSize || capacity > MaxSize) throwCorrupt("LZ4");
+        const auto result =
+            LZ4_decompress_safe(reinterpret_cast<const char *>(source), reinterpret_cast<char *>(destination),
+                                static_cast<int>(size), static_cast<int>(capacity));
+        if (result < 0 || static_cast<std::uint64_t>(result) != capacity) throwCorrupt("LZ4");
+        return;
+#else
+        throwUnavailable("LZ4");
+#endif
+    }
+    case compression::Codec::LZMA:
+    {
+#ifdef TINYVTU_WITH_LZMA
+        std::uint64_t memoryLimit = UINT64_MAX;
+        std::size_t inPosition = 0;
+        std::size_t outPosition = 0;
+        const auto ret =
+            lzma_stream_buffer_decode(&memoryLimit, 0, nullptr, source, &inPosition, static_cast<std::size_t>(size),
+                                      destination, &outPosition, static_cast<std::size_t>(capacity));
+        if (ret != LZMA_OK || outPosition != capacity) throwCorrupt("LZMA");
+        return;
+#else
+        throwUnavailable("LZMA");
+#endif
+    }
+    case compression::Codec::ZLib:
+        break;
+    }
+    auto decompressedSize = static_cast<uLongf>(capacity);
+    const auto ret = uncompress(destination, &decompressedSize, source, static_cast<uLong>(size));
+    if (ret != Z_OK || decompressedSize != capacity) throwCorrupt("zlib");
+}
+}  // namespace tinyvtu::internal
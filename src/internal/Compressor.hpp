@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+#include "tinyvtu.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * Returns the name of the vtk compressor reading data of the selected codec.
+ *
+ * @param compression  The compression information, must be active
+ * @return             The value of the compressor attribute of the VTKFile element
+ */
+const char *compressorName(const compression::Info &compression);
+
+/**
+ * Returns the size of an uncompressed block.
+ *
+ * @param compression  The compression information, must be active
+ * @return             The block size of the compression information or, if it is 0, a size fitting the L2 cache
+ */
+std::uint32_t resolveBlockSize(const compression::Info &compression);
+
+/**
+ * Returns the maximal size of a compressed block.
+ *
+ * @param size         The size of the uncompressed block
+ * @param compression  The compression information, must be active
+ * @return             The number of bytes the destination of compressBlock needs at least
+ * @throws std::invalid_argument if the codec is not available in this build
+ */
+std::uint64_t compressedBlockBound(std::uint64_t size, const compression::Info &compression);
+
+/**
+ * Compresses a single block with the selected codec.
+ *
+ * Each block is an independent stream of the codec, as expected by the vtk compressors.
+ *
+ * @param source       Pointer to the uncompressed block
+ * @param size         The size of the uncompressed block
+ * @param destination  Pointer to the buffer receiving the compressed block
+ * @param capacity     The size of the destination, at least compressedBlockBound(size)
+ * @param compression  The compression information, must be active
+ * @return             The size of the compressed block
+ * @throws std::invalid_argument if the codec is not available in this build
+ * @throws std::runtime_error if the compression failed
+ */
+std::uint64_t compressBlock(const std::uint8_t *source, std::uint64_t size, std::uint8_t *destination,
+                            std::uint64_t capacity, const compression::Info &compression);
+
+/**
+ * Decompresses a single block written by compressBlock or a vtk compressor.
+ *
+ * @param codec        The codec the block was compressed with
+ * @param source       Pointer to the compressed block
+ * @param size         The size of the compressed block
+ * @param destination  Pointer to the buffer receiving the uncompressed block
+ * @param capacity     The size of the uncompressed block, which has to be filled exactly
+ * @throws std::invalid_argument if the codec is not available in this build
+ * @throws std::runtime_error if the block is corrupt, does not decompress to capacity bytes, or its sizes exceed the
+ *                            limits of the codec
+ */
+void decompressBlock(compression::Codec codec, const std::uint8_t *source, std::uint64_t size,
+                     std::uint8_t *destination, std::uint64_t capacity);
+}  // namespace tinyvtu::internal
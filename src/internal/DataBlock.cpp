@@ -1,84 +1,526 @@
 #include "internal/DataBlock.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-#include "zlib.h"
+#include "internal/Compressor.hpp"
+#include "internal/Parallel.hpp"
 
 namespace tinyvtu::internal {
-Data compressData(const std::uint8_t *source, std::uint64_t size, const compression::Info &compression)
+namespace {
+void writeField(std::uint8_t *destination, std::uint64_t value, HeaderType header_type)
+{
+    if (header_type == HeaderType::UInt64)
+    {
+        std::memcpy(destination, &value, sizeof(std::uint64_t));
+        return;
+    }
+    const auto narrow = static_cast<std::uint32_t>(value);
+    std::memcpy(destination, &narrow, sizeof(std::uint32_t));
+}
+
+std::uint64_t readField(const std::uint8_t *source, HeaderType header_type)
+{
+    if (header_type == HeaderType::UInt64)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, source, sizeof(std::uint64_t));
+        return value;
+    }
+    std::uint32_t value;
+    std::memcpy(&value, source, sizeof(std::uint32_t));
+    return value;
+}
+
+/**
+ * Compresses the blocks [first_block, last_block) of data of the passed size and appends them to the destination.
+ *
+ * load(i, size, buffer) returns a pointer to the size bytes of block i, either into memory holding the data or into
+ * buffer after generating them. A full block equal to the previous one of its chunk reuses its compressed bytes, which
+ * are the same, so constant data is compressed once per chunk.
+ */
+template <typename Load>
+void compressBlockRange(std::uint64_t size, std::uint32_t first_block, std::uint32_t last_block,
+                        const compression::Info &compression, Data &destination, std::uint32_t *compressed_sizes,
+                        const Load &load)
+{
+    const std::uint32_t blockSize = resolveBlockSize(compression);
+    const auto numberOfFullBlocks = static_cast<std::uint32_t>(size / blockSize);
+    const auto lastPartialBlockSize = static_cast<std::uint32_t>(size % blockSize);
+    const std::uint32_t numberOfBlocksToCompress = last_block - first_block;
+
+    const auto compressedBlockSize =
+        std::max((numberOfFullBlocks > 0) ? compressedBlockBound(blockSize, compression) : 0,
+                 compressedBlockBound(lastPartialBlockSize, compression));
+
+    // The blocks are split into contiguous chunks, each chunk is compressed into its own buffer. Chunks are
+    // concatenated in order afterward, hence the result does not depend on the number of threads.
+    const auto threads = resolveThreads(compression.threads);
+    const std::uint32_t chunksPerThread = threads > 1 ? 4 : 1;
+    const std::uint32_t numberOfChunks = std::max(std::min(numberOfBlocksToCompress, threads * chunksPerThread), 1u);
+
+    std::vector<Data> chunks(numberOfChunks);
+    parallelFor(
+        numberOfChunks, threads,
+        [&](const std::size_t chunk)
+        {
+            const auto firstBlock =
+                first_block + static_cast<std::uint32_t>(chunk * numberOfBlocksToCompress / numberOfChunks);
+            const auto lastBlock =
+                first_block + static_cast<std::uint32_t>((chunk + 1) * numberOfBlocksToCompress / numberOfChunks);
+
+            auto &chunkData = chunks[chunk];
+            // Generated blocks alternate between the buffers, so the previous block stays available for comparison
+            std::array<Data, 2> buffers;
+            const std::uint8_t *previous = nullptr;
+            std::uint64_t previousSize = 0;
+            for (auto i = firstBlock; i < lastBlock; ++i)
+            {
+                const bool isPartialBlock = i == numberOfFullBlocks;
+                const auto sourceSize = isPartialBlock ? lastPartialBlockSize : blockSize;
+                const auto *block = load(i, sourceSize, buffers[i % 2]);
+
+                const auto chunkSize = chunkData.size();
+                if (!isPartialBlock && previous != nullptr && std::memcmp(block, previous, blockSize) == 0)
+                {
+                    chunkData.resize(chunkSize + previousSize);
+                    std::memcpy(&chunkData[chunkSize], &chunkData[chunkSize - previousSize], previousSize);
+                    compressed_sizes[i - first_block] = static_cast<std::uint32_t>(previousSize);
+                    previous = block;
+                    continue;
+                }
+
+                chunkData.resize(chunkSize + compressedBlockSize);
+                const auto destSize =
+                    compressBlock(block, sourceSize, &chunkData[chunkSize], compressedBlockSize, compression);
+
+                chunkData.resize(chunkSize + destSize);
+                compressed_sizes[i - first_block] = static_cast<std::uint32_t>(destSize);
+                previous = isPartialBlock ? nullptr : block;
+                previousSize = destSize;
+            }
+        });
+
+    std::size_t totalSize = destination.size();
+    for (const auto &chunkData : chunks) totalSize += chunkData.size();
+    destination.reserve(totalSize);
+    for (const auto &chunkData : chunks) destination.insert(destination.end(), chunkData.begin(), chunkData.end());
+}
+
+/**
+ * Mixes 8 bytes into a lane of the content hash, the round of xxHash64.
+ */
+constexpr std::uint64_t mixLane(std::uint64_t lane, std::uint64_t input)
+{
+    constexpr std::uint64_t Prime1 = 0x9e3779b185ebca87ull;
+    constexpr std::uint64_t Prime2 = 0xc2b2ae3d27d4eb4full;
+    return std::rotl(lane + input * Prime2, 31) * Prime1;
+}
+
+/**
+ * Distributes the bits of a hash over all bits, the finalizer of MurmurHash3.
+ */
+constexpr std::uint64_t avalanche(std::uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    return hash ^ (hash >> 33);
+}
+
+/**
+ * The size of the segments of an array hashed by a task of contentKey, fixed so the key does not depend on the threads.
+ */
+constexpr std::size_t hashSegmentSize = std::size_t{1} << 20;
+
+/**
+ * Hashes a segment of an array with four independent lanes, which keep the multipliers busy at memory speed.
+ */
+std::uint64_t hashSegment(std::span<const std::uint8_t> bytes)
+{
+    std::array<std::uint64_t, 4> lanes{1, 2, 3, 4};
+    std::size_t offset = 0;
+    for (; offset + 32 <= bytes.size(); offset += 32)
+    {
+        for (std::size_t lane = 0; lane < lanes.size(); ++lane)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, &bytes[offset + 8 * lane], sizeof(word));
+            lanes[lane] = mixLane(lanes[lane], word);
+        }
+    }
+    for (std::size_t lane = 0; offset < bytes.size(); offset += 8, ++lane)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, &bytes[offset], std::min<std::size_t>(8, bytes.size() - offset));
+        lanes[lane] = mixLane(lanes[lane], word);
+    }
+    return std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+}
+
+/**
+ * The number of blocks compressed by a task of compressDeferred, small enough to balance arrays of a few blocks.
+ */
+constexpr std::uint32_t deferredTaskBlocks = 8;
+}  // namespace
+
+std::uint64_t headerFieldSize(HeaderType header_type)
+{
+    return header_type == HeaderType::UInt64 ? sizeof(std::uint64_t) : sizeof(std::uint32_t);
+}
+
+std::uint32_t numberOfBlocks(std::uint64_t size, const compression::Info &compression)
+{
+    const std::uint32_t blockSize = resolveBlockSize(compression);
+    return static_cast<std::uint32_t>(size / blockSize + (size % blockSize != 0 ? 1 : 0));
+}
+
+void compressBlocks(const std::uint8_t *source, std::uint64_t size, std::uint32_t first_block,
+                    std::uint32_t last_block, const compression::Info &compression, Data &destination,
+                    std::uint32_t *compressed_sizes)
+{
+    const std::uint32_t blockSize = resolveBlockSize(compression);
+    compressBlockRange(size, first_block, last_block, compression, destination, compressed_sizes,
+                       [&](std::uint32_t i, std::uint32_t, Data &) { return &source[std::size_t{i} * blockSize]; });
+}
+
+Data compressionHeader(std::uint64_t size, const compression::Info &compression,
+                       const std::vector<std::uint32_t> &compressed_sizes, HeaderType header_type)
+{
+    // [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks]
+    const std::uint32_t blockSize = resolveBlockSize(compression);
+    const std::uint32_t numberOfBlocks = static_cast<std::uint32_t>(compressed_sizes.size());
+    const std::uint32_t lastPartialBlockSize = size % blockSize;
+    const auto field = headerFieldSize(header_type);
+
+    Data prequel(field * (1 + 1 + 1 + static_cast<std::size_t>(numberOfBlocks)));
+    // copy [#blocks]
+    writeField(&prequel[0], numberOfBlocks, header_type);
+    // copy [#u-size]
+    writeField(&prequel[field], blockSize, header_type);
+    // copy [#p-size]
+    writeField(&prequel[2 * field], lastPartialBlockSize, header_type);
+    // copy [#c-size-i]
+    if (header_type == HeaderType::UInt32 && numberOfBlocks > 0)
+        std::memcpy(&prequel[3 * field], compressed_sizes.data(), sizeof(std::uint32_t) * compressed_sizes.size());
+    else
+        for (std::size_t i = 0; i < compressed_sizes.size(); ++i)
+            writeField(&prequel[(3 + i) * field], compressed_sizes[i], header_type);
+    return prequel;
+}
+
+Data uncompressedHeader(std::uint64_t size, HeaderType header_type)
+{
+    Data header(headerFieldSize(header_type));
+    writeField(header.data(), size, header_type);
+    return header;
+}
+
+Data compressData(const std::uint8_t *source, std::uint64_t size, const compression::Info &compression,
+                  HeaderType header_type)
 {
     if (!compression.active)
     {
         // Uncompressed data has the following format
         // [#bytes][DATA]
-        // and [#bytes] is a std::uint32_t
+        // and [#bytes] is a std::uint32_t or std::uint64_t, depending on the header type
+        const auto field = headerFieldSize(header_type);
         Data blockData;
-        blockData.resize(static_cast<std::uint32_t>(sizeof(std::uint32_t) + size));
+        blockData.resize(static_cast<std::size_t>(field + size));
         // copy [#bytes]
-        std::memcpy(&blockData[0], &size, sizeof(std::uint32_t));
+        writeField(&blockData[0], size, header_type);
         // copy & encode [DATA]
-        std::memcpy(&blockData[sizeof(std::uint32_t)], source, size);
+        if (size > 0) std::memcpy(&blockData[field], source, size);
         return blockData;
     }
     // Compressed data has the following format
     // [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks][DATA]
-    // each [#...] is std::uint32_t
+    // each [#...] is std::uint32_t or std::uint64_t, depending on the header type
     // [#blocks] is the number of blocks
     // [#u-size] is the size of an uncompressed block
     // [#p-size] is the size of the last partial uncompressed block
     // [#c-size-i] is the size of the i-th compressed block
     // [DATA] the data
-    const std::uint32_t blockSize = compression.blockSize;
-    const std::uint32_t numberOfFullBlocks = size / blockSize;
-    const bool hasPartialBlock = size % blockSize != 0;
-    const std::uint32_t numberOfBlocks = numberOfFullBlocks + (hasPartialBlock ? 1 : 0);
-    const std::uint32_t lastPartialBlockSize = size - (numberOfFullBlocks)*blockSize;
+    const auto blockCount = numberOfBlocks(size, compression);
+    std::vector<std::uint32_t> compressedSizes(blockCount);
 
-    const std::uint32_t compressedBlockSize =
-        std::max((numberOfFullBlocks > 0) ? compressBound(blockSize) : 0, compressBound(lastPartialBlockSize));
-    auto compressedBlock = std::vector<std::uint8_t>(compressedBlockSize);
+    // The header is written in front of the data once the compressed sizes are known
+    Data rawData(headerFieldSize(header_type) * (1 + 1 + 1 + static_cast<std::size_t>(blockCount)));
+    compressBlocks(source, size, 0, blockCount, compression, rawData, compressedSizes.data());
 
-    Data prequel;  // We write [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks] in prequel
-    Data rawData;  // We write [DATA] in rawData and later combine the two buffers
+    const auto prequel = compressionHeader(size, compression, compressedSizes, header_type);
+    std::memcpy(rawData.data(), prequel.data(), prequel.size());
 
-    prequel.resize(sizeof(std::uint32_t) * (1 + 1 + 1 + numberOfBlocks));
-    // copy [#blocks]
-    std::memcpy(&prequel[0], &numberOfBlocks, sizeof(std::uint32_t));
-    // copy [#u-size]
-    std::memcpy(&prequel[sizeof(std::uint32_t)], &blockSize, sizeof(std::uint32_t));
-    // copy [#p-size]
-    std::memcpy(&prequel[2 * sizeof(std::uint32_t)], &lastPartialBlockSize, sizeof(std::uint32_t));
-    for (auto i = 0u; i < numberOfFullBlocks; ++i)
-    {
-        uLongf destSize = compressedBlockSize;
-        const auto ret = compress2(compressedBlock.data(), &destSize, &source[static_cast<std::size_t>(i) * blockSize],
-                                   blockSize, compression.level);
-        if (ret != Z_OK)
-            throw std::runtime_error("[tinyvtk::createBlockData] zlib compression failed for full block " +
-                                     std::to_string(i) + " with error code " + std::to_string(ret));
-
-        rawData.insert(rawData.end(), compressedBlock.data(), compressedBlock.data() + destSize);
-        // copy [#c-size-i]
-        std::memcpy(&prequel[static_cast<std::size_t>(3 + i) * sizeof(std::uint32_t)], &destSize,
-                    sizeof(std::uint32_t));
+    return rawData;
+}
+
+HeaderType requiredHeaderType(std::uint64_t size, const compression::Info &compression)
+{
+    if (!compression.active && size > std::numeric_limits<std::uint32_t>::max()) return HeaderType::UInt64;
+    return HeaderType::UInt32;
+}
+
+std::uint64_t headerSize(const DataBlock &data_block, const compression::Info &compression)
+{
+    const auto field = headerFieldSize(data_block.header_type);
+    if (!compression.active) return field;
+    // [#blocks] determines the number of [#c-size-i] fields
+    return field * (3 + readField(data_block.block.data(), data_block.header_type));
+}
+
+std::uint64_t contentKey(DataBlock::Type type, std::span<const std::uint8_t> bytes,
+                         const compression::Info &compression)
+{
+    // The segments are hashed in parallel before the array is compressed, a duplicate is then never compressed
+    const auto segmentCount = std::max<std::size_t>((bytes.size() + hashSegmentSize - 1) / hashSegmentSize, 1);
+    std::vector<std::uint64_t> segmentHashes(segmentCount);
+    parallelFor(segmentCount, compression.threads,
+                [&](const std::size_t i)
+                {
+                    const auto begin = i * hashSegmentSize;
+                    segmentHashes[i] =
+                        hashSegment(bytes.subspan(begin, std::min(hashSegmentSize, bytes.size() - begin)));
+                });
+
+    std::uint64_t hash = 0;
+    for (const auto segmentHash : segmentHashes) hash = mixLane(hash, segmentHash);
+    hash = mixLane(hash, bytes.size());
+    hash = mixLane(hash, type);
+    hash = mixLane(hash, compression.active);
+    if (compression.active)
+    {
+        // Everything which changes the compressed bytes
+        std::uint64_t minRatio;
+        std::memcpy(&minRatio, &compression.minRatio, sizeof(minRatio));
+        hash = mixLane(hash, resolveBlockSize(compression));
+        hash = mixLane(hash, static_cast<std::uint64_t>(compression.level));
+        hash = mixLane(hash, static_cast<std::uint64_t>(compression.codec));
+        hash = mixLane(hash, static_cast<std::uint64_t>(compression.deflate));
+        hash = mixLane(hash, minRatio);
     }
-    if (hasPartialBlock)
-    {
-        uLongf destSize = compressedBlockSize;
-        const auto ret = compress2(compressedBlock.data(), &destSize,
-                                   &source[static_cast<std::size_t>(numberOfFullBlocks * blockSize)],
-                                   lastPartialBlockSize, compression.level);
-        if (ret != Z_OK)
-            throw std::runtime_error("[tinyvtk::createBlockData] zlib compression failed for partial block of size " +
-                                     std::to_string(lastPartialBlockSize) + " with error code " + std::to_string(ret));
-
-        rawData.insert(rawData.end(), compressedBlock.data(), compressedBlock.data() + destSize);
-        // copy [#c-size-i]
-        std::memcpy(&prequel[((3 + numberOfFullBlocks) * sizeof(std::uint32_t))], &destSize, sizeof(std::uint32_t));
+    hash = avalanche(hash);
+    return hash != 0 ? hash : 1;
+}
+
+bool holdsData(const DataBlock &data_block, std::span<const std::uint8_t> bytes, const compression::Info &compression)
+{
+    auto equal = [](std::span<const std::uint8_t> a, std::span<const std::uint8_t> b)
+    { return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0); };
+
+    if (data_block.deferred) return equal(data_block.deferred->bytes, bytes);
+    if (uncompressedSize(data_block, compression) != bytes.size()) return false;
+    const auto header = headerSize(data_block, compression);
+    if (!compression.active)
+    {
+        return data_block.reference.empty() ? equal(std::span(data_block.block).subspan(header), bytes)
+                                            : equal(data_block.reference, bytes);
     }
-    rawData.insert(rawData.begin(), prequel.begin(), prequel.end());
 
-    return rawData;
+    // [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks][DATA]
+    const auto field = headerFieldSize(data_block.header_type);
+    const auto blocks = compressedBlockCount(data_block, compression);
+    const auto blockSize = readField(&data_block.block[field], data_block.header_type);
+    Data buffer(static_cast<std::size_t>(std::min<std::uint64_t>(blockSize, bytes.size())));
+    std::uint64_t source = header;
+    for (std::uint32_t i = 0; i < blocks; ++i)
+    {
+        const auto compressedSize = readField(&data_block.block[(3 + i) * field], data_block.header_type);
+        const auto begin = i * blockSize;
+        const auto expected = bytes.subspan(begin, std::min<std::uint64_t>(blockSize, bytes.size() - begin));
+        decompressBlock(compression.codec, &data_block.block[source], compressedSize, buffer.data(), expected.size());
+        if (!equal(std::span(buffer).first(expected.size()), expected)) return false;
+        source += compressedSize;
+    }
+    return true;
+}
+
+std::vector<DataBlock> compressDeferred(std::vector<const DataBlock *> &data_blocks, std::uint32_t threads)
+{
+    std::vector<std::size_t> arrays;
+    for (std::size_t i = 0; i < data_blocks.size(); ++i)
+        if (data_blocks[i]->deferred) arrays.push_back(i);
+    std::ranges::stable_sort(arrays, std::ranges::greater{},
+                             [&](std::size_t i) { return data_blocks[i]->deferred->bytes.size(); });
+
+    // A task compresses a few consecutive blocks of one array, the tasks of the largest array come first
+    struct Task
+    {
+        std::size_t array;
+        std::uint32_t first_block;
+        std::uint32_t last_block;
+    };
+    std::vector<Task> tasks;
+    std::vector<std::vector<std::uint32_t> > compressed_sizes(arrays.size());
+    for (std::size_t array = 0; array < arrays.size(); ++array)
+    {
+        const auto &deferred = *data_blocks[arrays[array]]->deferred;
+        const auto blocks = numberOfBlocks(deferred.bytes.size(), deferred.compression);
+        compressed_sizes[array].resize(blocks);
+        for (std::uint32_t first = 0; first < blocks; first += deferredTaskBlocks)
+            tasks.push_back({array, first, std::min(first + deferredTaskBlocks, blocks)});
+    }
+
+    std::vector<Data> outputs(tasks.size());
+    std::vector<TimeSpan> spans(tasks.size());
+    parallelFor(tasks.size(), threads,
+                [&](std::size_t i)
+                {
+                    const auto begin = std::chrono::steady_clock::now();
+                    const auto &[array, first, last] = tasks[i];
+                    const auto &deferred = *data_blocks[arrays[array]]->deferred;
+                    // The threads are spent on the tasks, hence each task compresses its blocks sequentially
+                    auto compression = deferred.compression;
+                    compression.threads = 1;
+                    compressBlocks(deferred.bytes.data(), deferred.bytes.size(), first, last, compression, outputs[i],
+                                   &compressed_sizes[array][first]);
+                    spans[i] = {begin, std::chrono::steady_clock::now()};
+                });
+
+    // The blocks are assembled as compressData lays them out, [HEADER][DATA]
+    std::vector<DataBlock> compressed;
+    compressed.reserve(arrays.size());
+    for (std::size_t array = 0, task = 0; array < arrays.size(); ++array)
+    {
+        const auto &source = *data_blocks[arrays[array]];
+        const auto &deferred = *source.deferred;
+        auto header = compressionHeader(deferred.bytes.size(), deferred.compression, compressed_sizes[array],
+                                        source.header_type);
+        TimeSpan creation{std::chrono::steady_clock::now(), {}};
+
+        const auto first_task = task;
+        std::size_t size = header.size();
+        for (; task < tasks.size() && tasks[task].array == array; ++task) size += outputs[task].size();
+        header.reserve(size);
+        for (auto i = first_task; i < task; ++i)
+        {
+            header.insert(header.end(), outputs[i].begin(), outputs[i].end());
+            creation.begin = std::min(creation.begin, spans[i].begin);
+            creation.end = std::max(creation.end, spans[i].end);
+        }
+
+        auto &data_block = compressed.emplace_back(DataBlock{source.type, source.name, source.number_of_components,
+                                                             std::move(header), {}, source.header_type});
+        data_block.creation = first_task < task ? creation : TimeSpan{creation.begin, creation.begin};
+    }
+
+    for (std::size_t array = 0; array < arrays.size(); ++array) data_blocks[arrays[array]] = &compressed[array];
+    return compressed;
+}
+
+std::uint64_t uncompressedSize(const DataBlock &data_block, const compression::Info &compression)
+{
+    const auto field = headerFieldSize(data_block.header_type);
+    if (!compression.active) return readField(data_block.block.data(), data_block.header_type);
+    // All blocks but the last one have [#u-size] bytes, a [#p-size] of 0 means the last one is full as well
+    const auto blocks = readField(data_block.block.data(), data_block.header_type);
+    if (blocks == 0) return 0;
+    const auto blockSize = readField(&data_block.block[field], data_block.header_type);
+    const auto partialSize = readField(&data_block.block[2 * field], data_block.header_type);
+    return (blocks - 1) * blockSize + (partialSize != 0 ? partialSize : blockSize);
+}
+
+std::uint32_t compressedBlockCount(const DataBlock &data_block, const compression::Info &compression)
+{
+    if (!compression.active) return 0;
+    return static_cast<std::uint32_t>(readField(data_block.block.data(), data_block.header_type));
+}
+
+Data widenHeader(const DataBlock &data_block, const compression::Info &compression)
+{
+    const auto field = headerFieldSize(data_block.header_type);
+    const auto fields = headerSize(data_block, compression) / field;
+    Data header(static_cast<std::size_t>(fields * sizeof(std::uint64_t)));
+    for (std::uint64_t i = 0; i < fields; ++i)
+    {
+        writeField(&header[i * sizeof(std::uint64_t)], readField(&data_block.block[i * field], data_block.header_type),
+                   HeaderType::UInt64);
+    }
+    return header;
+}
+
+DataBlock createBlock(DataBlock::Type type, const std::string &name, std::span<const std::uint8_t> bytes,
+                      std::uint32_t number_of_components, const compression::Info &compression, bool reference)
+{
+    const auto header_type = requiredHeaderType(bytes.size(), compression);
+    if (compression.active && compression.deferred)
+    {
+        // The data is only recorded, compressDeferred compresses it together with the other blocks of the grid
+        auto deferred = std::make_shared<DeferredData>();
+        deferred->compression = compression;
+        if (reference)
+        {
+            deferred->bytes = bytes;
+        }
+        else
+        {
+            deferred->owned.assign(bytes.begin(), bytes.end());
+            deferred->bytes = deferred->owned;
+        }
+        DataBlock data_block{type, name, number_of_components, {}, {}, header_type};
+        data_block.deferred = std::move(deferred);
+        return data_block;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    DataBlock data_block;
+    if (reference && !compression.active)
+    {
+        // Only [#bytes] is stored, [DATA] is written from the referenced memory
+        data_block = {type, name, number_of_components, uncompressedHeader(bytes.size(), header_type), bytes,
+                      header_type};
+    }
+    else
+    {
+        data_block = {type, name, number_of_components,
+                      compressData(bytes.data(), bytes.size(), compression, header_type), {}, header_type};
+    }
+    data_block.creation = {begin, std::chrono::steady_clock::now()};
+    return data_block;
+}
+
+DataBlock createBlock(DataBlock::Type type, const std::string &name, std::uint64_t size,
+                      std::uint32_t number_of_components, const compression::Info &compression,
+                      const Generator &generate)
+{
+    if (!compression.active || compression.deferred)
+    {
+        // The data is needed as a whole, either in the block or until the grid is written
+        Data data(static_cast<std::size_t>(size));
+        generate(0, data);
+        return createBlock(type, name, data, number_of_components, compression, false);
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const auto header_type = requiredHeaderType(size, compression);
+    const auto blockCount = numberOfBlocks(size, compression);
+    const std::uint64_t blockSize = resolveBlockSize(compression);
+    std::vector<std::uint32_t> compressedSizes(blockCount);
+
+    // Each block is generated right before it is compressed, hence the data is never held as a whole
+    Data rawData(headerFieldSize(header_type) * (1 + 1 + 1 + static_cast<std::size_t>(blockCount)));
+    compressBlockRange(size, 0, blockCount, compression, rawData, compressedSizes.data(),
+                       [&](std::uint32_t i, std::uint32_t blockBytes, Data &buffer)
+                       {
+                           buffer.resize(blockBytes);
+                           generate(i * blockSize, buffer);
+                           return buffer.data();
+                       });
+
+    const auto prequel = compressionHeader(size, compression, compressedSizes, header_type);
+    std::memcpy(rawData.data(), prequel.data(), prequel.size());
+
+    DataBlock data_block{type, name, number_of_components, std::move(rawData), {}, header_type};
+    data_block.creation = {begin, std::chrono::steady_clock::now()};
+    return data_block;
 }
 }  // namespace tinyvtu::internal
@@ -1,6 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "tinyvtu.hpp"
@@ -8,6 +17,39 @@
 namespace tinyvtu::internal {
 using Data = std::vector<std::uint8_t>;
 
+/**
+ * The width of the size fields in the header of an appended array, written as header_type of the VTKFile.
+ */
+enum class HeaderType
+{
+    UInt32,
+    UInt64,
+};
+
+/**
+ * Fills the destination with the bytes [offset, offset + destination.size()) of data which is not held in memory.
+ */
+using Generator = std::function<void(std::uint64_t offset, std::span<std::uint8_t> destination)>;
+
+/**
+ * An interval measured with the steady clock.
+ */
+struct TimeSpan
+{
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+};
+
+/**
+ * The uncompressed data of a block whose compression is deferred until its grid is written.
+ */
+struct DeferredData
+{
+    std::span<const std::uint8_t> bytes;  ///< The data, in the caller's memory or in owned
+    Data owned;                           ///< A copy of the data if it is not referenced
+    compression::Info compression;        ///< The settings the data is compressed with
+};
+
 struct DataBlock
 {
     enum Type
@@ -28,62 +70,342 @@ struct DataBlock
     std::string name;
     std::uint32_t number_of_components;
     Data block;
+    /**
+     * Uncompressed data which is referenced instead of copied into block. It follows block in the appended section,
+     * the referenced memory must outlive the DataBlock.
+     */
+    std::span<const std::uint8_t> reference = {};
+    /**
+     * The width of the size fields in the header at the start of block.
+     */
+    HeaderType header_type = HeaderType::UInt32;
+    /**
+     * When the data was compressed or copied into block, reported by the statistics of a write.
+     */
+    TimeSpan creation = {};
+    /**
+     * The data of a block created with compression::Info::deferred, block is empty until compressDeferred.
+     */
+    std::shared_ptr<const DeferredData> deferred = {};
+    /**
+     * Hash of the uncompressed data, its type, and the compression settings, 0 if unknown. Blocks with equal keys are
+     * candidates for sharing their appended data.
+     */
+    std::uint64_t content_key = 0;
+    /**
+     * The block of the same grid holding the data of this block, which is then empty. Both DataArray elements refer to
+     * the same appended data, which is written once.
+     */
+    const DataBlock *duplicate_of = nullptr;
+
+    /**
+     * Returns the number of bytes the DataBlock takes in the appended section.
+     */
+    [[nodiscard]] std::uint64_t size() const { return block.size() + reference.size(); }
 };
 
+/**
+ * Returns the number of bytes of a size field in the header of an appended array.
+ *
+ * @param header_type  The header type
+ * @return             4 for UInt32, 8 for UInt64
+ */
+std::uint64_t headerFieldSize(HeaderType header_type);
+
+/**
+ * Returns the number of compression blocks the passed data is split into.
+ *
+ * @param size         The size of the data
+ * @param compression  The compression information
+ * @return             The number of full and partial blocks
+ */
+std::uint32_t numberOfBlocks(std::uint64_t size, const compression::Info &compression);
+
+/**
+ * Compresses the blocks [first_block, last_block) of the passed data and appends them to the destination.
+ *
+ * Together with compressionHeader this allows to compress large data piece by piece, compressData is the one-shot
+ * variant. A full block equal to its predecessor reuses its compressed bytes instead of being compressed again.
+ *
+ * @param source            Pointer to the source data (all blocks, not only the ones to compress)
+ * @param size              The size of the data
+ * @param first_block       Index of the first block to compress
+ * @param last_block        Index one past the last block to compress
+ * @param compression       The compression information, must be active
+ * @param destination       The buffer the compressed blocks are appended to
+ * @param compressed_sizes  Receives the compressed size of each block, starting with first_block
+ */
+void compressBlocks(const std::uint8_t *source, std::uint64_t size, std::uint32_t first_block,
+                    std::uint32_t last_block, const compression::Info &compression, Data &destination,
+                    std::uint32_t *compressed_sizes);
+
+/**
+ * Creates the header [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks] of compressed data.
+ *
+ * @param size              The size of the uncompressed data
+ * @param compression       The compression information, must be active
+ * @param compressed_sizes  The compressed size of each block
+ * @param header_type       The width of the size fields
+ * @return                  The header, which precedes the compressed blocks
+ */
+Data compressionHeader(std::uint64_t size, const compression::Info &compression,
+                       const std::vector<std::uint32_t> &compressed_sizes,
+                       HeaderType header_type = HeaderType::UInt32);
+
+/**
+ * Creates the header [#bytes] of uncompressed data.
+ *
+ * @param size         The size of the data
+ * @param header_type  The width of the size field
+ * @return             The header, which precedes the data
+ */
+Data uncompressedHeader(std::uint64_t size, HeaderType header_type = HeaderType::UInt32);
+
 /**
  * Compresses the passed data if the compression info allows for it.
  *
  * @param source       Pointer to the source data
  * @param size         The size of the data
  * @param compression  The compression information
+ * @param header_type  The width of the size fields
  * @return             The compressed data
  */
-Data compressData(const std::uint8_t *source, std::uint64_t size, const compression::Info &compression);
+Data compressData(const std::uint8_t *source, std::uint64_t size, const compression::Info &compression,
+                  HeaderType header_type = HeaderType::UInt32);
 
 /**
- * Creates a DataBlock object from provided data, name, number of components, and compression info.
+ * Returns the header type needed for the header of the passed data.
  *
- * @param name                  The name of the data block
- * @param data                  The data to be stored in the data block
- * @param number_of_components  The number of components per data entry (can be zero for internal data)
- * @param compression           The compression information
- * @return                      A DataBlock object containing the specified data
- * @throws std::invalid_argument if the data size is not divisible by the number of components
+ * Only the size of uncompressed data can exceed 32 bits, the fields of compressed data refer to single blocks.
+ *
+ * @param size         The size of the uncompressed data
+ * @param compression  The compression information
+ * @return             UInt64 if a size field does not fit into 32 bits, UInt32 otherwise
+ */
+HeaderType requiredHeaderType(std::uint64_t size, const compression::Info &compression);
+
+/**
+ * Returns the number of bytes of the header at the start of the block of a DataBlock.
+ *
+ * @param data_block   The data block
+ * @param compression  The compression information the data block was created with
+ * @return             The size of the header in the width of the data block's header type
+ */
+std::uint64_t headerSize(const DataBlock &data_block, const compression::Info &compression);
+
+/**
+ * Returns the content key of data, see DataBlock::content_key.
+ *
+ * Segments of the data are hashed in parallel on compression.threads threads. Settings which do not change the written
+ * bytes, like the number of threads, do not change the key.
+ *
+ * @param type         The type of the data
+ * @param bytes        The uncompressed data
+ * @param compression  The compression information the data is written with
+ * @return             A 64 bit hash, never 0
+ */
+std::uint64_t contentKey(DataBlock::Type type, std::span<const std::uint8_t> bytes,
+                         const compression::Info &compression);
+
+/**
+ * Returns whether a DataBlock holds exactly the passed data, compressed blocks are decompressed to compare them.
+ *
+ * @param data_block   The data block, not a duplicate
+ * @param bytes        The uncompressed data
+ * @param compression  The compression information the data block was created with
+ * @return             True if the uncompressed data of the block equals bytes
+ */
+bool holdsData(const DataBlock &data_block, std::span<const std::uint8_t> bytes, const compression::Info &compression);
+
+/**
+ * Compresses the deferred ones of the passed blocks together and replaces them by their compressed blocks.
+ *
+ * The blocks of all arrays are split into tasks which are handed out to the threads largest array first, hence small
+ * arrays fill the gaps at the end and all threads stay busy. The compressed data equals the one of compressData.
+ *
+ * @param data_blocks  The blocks of a grid, the deferred ones are replaced by pointers into the returned vector
+ * @param threads      The number of threads, 0 selects the number of hardware threads
+ * @return             The compressed blocks, which must outlive the use of data_blocks
+ */
+std::vector<DataBlock> compressDeferred(std::vector<const DataBlock *> &data_blocks, std::uint32_t threads);
+
+/**
+ * Returns the size of the data of a DataBlock before compression, read from its header.
+ *
+ * @param data_block   The data block
+ * @param compression  The compression information the data block was created with
+ * @return             The number of bytes of the uncompressed data
+ */
+std::uint64_t uncompressedSize(const DataBlock &data_block, const compression::Info &compression);
+
+/**
+ * Returns the number of compression blocks of a DataBlock, read from its header.
+ *
+ * @param data_block   The data block
+ * @param compression  The compression information the data block was created with
+ * @return             The value of [#blocks], 0 if compression is inactive
+ */
+std::uint32_t compressedBlockCount(const DataBlock &data_block, const compression::Info &compression);
+
+/**
+ * Returns the header of a DataBlock with 64 bit size fields.
+ *
+ * Used if a file needs 64 bit headers, but the data block was created with 32 bit ones. The header does not depend on
+ * the data, hence it can be converted without compressing the data again.
+ *
+ * @param data_block   The data block
+ * @param compression  The compression information the data block was created with
+ * @return             The header with UInt64 fields, which replaces the first headerSize() bytes of the block
+ */
+Data widenHeader(const DataBlock &data_block, const compression::Info &compression);
+
+/**
+ * Maps an arithmetic type to the corresponding DataBlock type.
+ *
+ * @tparam T  The arithmetic type
+ * @return    The DataBlock type describing T
  */
 template <typename T>
 requires std::is_arithmetic_v<T>
-DataBlock createBlock(const std::string &name, const std::vector<T> &data, std::uint32_t number_of_components,
-                      const compression::Info &compression)
+constexpr DataBlock::Type blockType()
 {
-    if (number_of_components != 0 && (data.size() % number_of_components != 0))
-    {
-        throw std::invalid_argument("data size must be divisible by number_of_components");
-    }
-    const auto compressedData =
-        compressData(reinterpret_cast<const std::uint8_t *>(data.data()), data.size() * sizeof(T), compression);
     if constexpr (sizeof(T) == sizeof(std::uint8_t) && std::is_integral_v<T> && std::is_unsigned_v<T>)
-        return {DataBlock::UInt8, name, number_of_components, compressedData};
+        return DataBlock::UInt8;
     else if constexpr (sizeof(T) == sizeof(std::uint8_t) && std::is_integral_v<T>)
-        return {DataBlock::Int8, name, number_of_components, compressedData};
+        return DataBlock::Int8;
     else if constexpr (sizeof(T) == sizeof(std::uint16_t) && std::is_integral_v<T> && std::is_unsigned_v<T>)
-        return {DataBlock::UInt16, name, number_of_components, compressedData};
+        return DataBlock::UInt16;
     else if constexpr (sizeof(T) == sizeof(std::uint16_t) && std::is_integral_v<T>)
-        return {DataBlock::Int16, name, number_of_components, compressedData};
+        return DataBlock::Int16;
     else if constexpr (sizeof(T) == sizeof(std::uint32_t) && std::is_integral_v<T> && std::is_unsigned_v<T>)
-        return {DataBlock::UInt32, name, number_of_components, compressedData};
+        return DataBlock::UInt32;
     else if constexpr (sizeof(T) == sizeof(std::uint32_t) && std::is_integral_v<T>)
-        return {DataBlock::Int32, name, number_of_components, compressedData};
+        return DataBlock::Int32;
     else if constexpr (sizeof(T) == sizeof(std::uint64_t) && std::is_integral_v<T> && std::is_unsigned_v<T>)
-        return {DataBlock::UInt64, name, number_of_components, compressedData};
+        return DataBlock::UInt64;
     else if constexpr (sizeof(T) == sizeof(std::uint64_t) && std::is_integral_v<T>)
-        return {DataBlock::Int64, name, number_of_components, compressedData};
+        return DataBlock::Int64;
     else if constexpr (sizeof(T) == sizeof(float) && std::is_floating_point_v<T>)
-        return {DataBlock::Float32, name, number_of_components, compressedData};
+        return DataBlock::Float32;
     else if constexpr (sizeof(T) == sizeof(double) && std::is_floating_point_v<T>)
-        return {DataBlock::Float64, name, number_of_components, compressedData};
+        return DataBlock::Float64;
     else
         static_assert(!sizeof(T), "Unsupported data type");
-    return {};
+}
+
+/**
+ * Creates a DataBlock object from raw bytes, name, number of components, and compression info.
+ *
+ * @param type                  The type of the data
+ * @param name                  The name of the data block
+ * @param bytes                 The data to be stored in the data block
+ * @param number_of_components  The number of components per data entry (can be zero for internal data)
+ * @param compression           The compression information
+ * @param reference             If true and compression is inactive or deferred, the data is referenced instead of
+ *                              copied
+ * @return                      A DataBlock object containing the specified data
+ */
+DataBlock createBlock(DataBlock::Type type, const std::string &name, std::span<const std::uint8_t> bytes,
+                      std::uint32_t number_of_components, const compression::Info &compression, bool reference);
+
+/**
+ * Creates a DataBlock object from data which is generated block by block, e.g. the constant types of a grid.
+ *
+ * If compression is active and not deferred, only one block per thread is generated at a time. As for data in memory,
+ * equal consecutive blocks are compressed once, so constant data costs one compression per thread.
+ *
+ * @param type                  The type of the data
+ * @param name                  The name of the data block
+ * @param size                  The size of the data in bytes
+ * @param number_of_components  The number of components per data entry (can be zero for internal data)
+ * @param compression           The compression information
+ * @param generate              Generates the requested range of the data, possibly concurrently for several ranges
+ * @return                      A DataBlock object containing the generated data
+ */
+DataBlock createBlock(DataBlock::Type type, const std::string &name, std::uint64_t size,
+                      std::uint32_t number_of_components, const compression::Info &compression,
+                      const Generator &generate);
+
+/**
+ * Returns a generator of an array of T which calls gather(first, count, destination) to write the count elements
+ * starting at element first to destination.
+ *
+ * Blocks need not start or end at an element boundary, elements they cut are written through a temporary.
+ */
+template <typename T, typename Gather>
+Generator valueGenerator(Gather gather)
+{
+    return [gather](std::uint64_t offset, std::span<std::uint8_t> destination)
+    {
+        if (destination.empty()) return;
+        const auto end = offset + destination.size();
+        auto copyCut = [&](std::uint64_t element)
+        {
+            std::array<std::uint8_t, sizeof(T)> bytes;
+            gather(element, 1, bytes.data());
+            const auto begin = std::max<std::uint64_t>(offset, element * sizeof(T));
+            const auto last = std::min<std::uint64_t>(end, (element + 1) * sizeof(T));
+            std::memcpy(&destination[begin - offset], &bytes[begin - element * sizeof(T)], last - begin);
+        };
+
+        const auto firstWhole = (offset + sizeof(T) - 1) / sizeof(T);
+        const auto endWhole = end / sizeof(T);
+        if (firstWhole > endWhole)
+        {
+            copyCut(endWhole);
+            return;
+        }
+        if (offset % sizeof(T) != 0) copyCut(firstWhole - 1);
+        if (endWhole > firstWhole)
+            gather(firstWhole, endWhole - firstWhole, &destination[firstWhole * sizeof(T) - offset]);
+        if (end % sizeof(T) != 0) copyCut(endWhole);
+    };
+}
+
+/**
+ * Creates a DataBlock object from provided data, name, number of components, and compression info.
+ *
+ * The data is passed to the compressor as is. If compression is inactive and reference is set, the DataBlock only
+ * references the data, which then has to outlive the DataBlock.
+ *
+ * @param name                  The name of the data block
+ * @param data                  The data to be stored in the data block
+ * @param number_of_components  The number of components per data entry (can be zero for internal data)
+ * @param compression           The compression information
+ * @param reference             If true and compression is inactive, the data is referenced instead of copied
+ * @return                      A DataBlock object containing the specified data
+ * @throws std::invalid_argument if the data size is not divisible by the number of components
+ */
+template <typename T>
+requires std::is_arithmetic_v<T>
+DataBlock createBlock(const std::string &name, std::span<const T> data, std::uint32_t number_of_components,
+                      const compression::Info &compression, bool reference = false)
+{
+    if (number_of_components != 0 && (data.size() % number_of_components != 0))
+    {
+        throw std::invalid_argument("data size must be divisible by number_of_components");
+    }
+    return createBlock(blockType<T>(), name,
+                       std::span(reinterpret_cast<const std::uint8_t *>(data.data()), data.size_bytes()),
+                       number_of_components, compression, reference);
+}
+
+/**
+ * Creates a DataBlock object from provided data, name, number of components, and compression info.
+ *
+ * @param name                  The name of the data block
+ * @param data                  The data to be stored in the data block
+ * @param number_of_components  The number of components per data entry (can be zero for internal data)
+ * @param compression           The compression information
+ * @return                      A DataBlock object containing the specified data
+ * @throws std::invalid_argument if the data size is not divisible by the number of components
+ */
+template <typename T>
+requires std::is_arithmetic_v<T>
+DataBlock createBlock(const std::string &name, const std::vector<T> &data, std::uint32_t number_of_components,
+                      const compression::Info &compression)
+{
+    return createBlock(name, std::span<const T>(data), number_of_components, compression);
 }
 
 }  // namespace tinyvtu::internal
@@ -1,8 +1,17 @@
 #include "internal/GridData.hpp"
 
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <charconv>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
 #include "XMLWriter.hpp"
+#include "internal/Base64.hpp"
+#include "internal/Compressor.hpp"
 
 namespace {
 std::string endian()
@@ -16,75 +25,522 @@ std::string endian()
 }  // namespace
 
 namespace tinyvtu::internal {
-void GridData::write(const std::filesystem::path &file_path) const
+namespace {
+/**
+ * An array in the order of the appended section, written from the data of content and handed to the file during io.
+ */
+struct WrittenArray
 {
-    using Attr = XMLWriter::Attribute;
-    XMLWriter writer(file_path);
-    if (!compression_.active)
-        writer.openXMLElement("VTKFile",
-                              {Attr{"type", "UnstructuredGrid"}, Attr{"version", "0.1"}, Attr{"byte_order", endian()}});
+    const DataBlock *data_block;
+    const DataBlock *content;
+    TimeSpan io;
+};
+
+/**
+ * Fills the statistics of a write from the arrays in the order they were written.
+ */
+void collectStatistics(const std::vector<WrittenArray> &written, const compression::Info &compression, TimeSpan write,
+                       std::uint64_t peak_memory, statistics::Info &statistics)
+{
+    // The trace starts with the earliest event, usually the compression of the points in createGrid
+    auto origin = write.begin;
+    for (const auto &array : written) origin = std::min(origin, array.data_block->creation.begin);
+    auto seconds = [](auto begin, auto end) { return std::chrono::duration<double>(end - begin).count(); };
+
+    statistics.arrays.clear();
+    statistics.arrays.reserve(written.size());
+    for (const auto &[data_block, content, io] : written)
+    {
+        // A duplicate adds no bytes to the file, its creation is the time finding the block holding its data
+        const auto &creation = data_block->creation;
+        statistics.arrays.push_back({data_block->name.empty() ? "points" : data_block->name,
+                                     uncompressedSize(*content, compression),
+                                     data_block == content ? content->size() : 0,
+                                     compressedBlockCount(*content, compression),
+                                     seconds(origin, creation.begin),
+                                     seconds(creation.begin, creation.end),
+                                     seconds(origin, io.begin),
+                                     seconds(io.begin, io.end)});
+    }
+    statistics.peakMemory = peak_memory;
+    statistics.writeStart = seconds(origin, write.begin);
+    statistics.writeSeconds = seconds(write.begin, write.end);
+}
+
+/**
+ * Returns the values separated by spaces, each in the shortest representation which reads back to the same value.
+ */
+std::string formatNumbers(const std::array<double, 3> &values)
+{
+    std::string text;
+    for (const auto value : values)
+    {
+        std::array<char, 32> buffer{};
+        const auto end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value).ptr;
+        if (!text.empty()) text += ' ';
+        text.append(buffer.data(), end);
+    }
+    return text;
+}
+
+/**
+ * Returns the extent of a structured grid, the first and last point index along each axis.
+ */
+std::string formatExtent(const std::array<std::uint64_t, 3> &dimensions)
+{
+    std::string text;
+    for (const auto dimension : dimensions)
+    {
+        if (!text.empty()) text += ' ';
+        text += "0 " + std::to_string(dimension - 1);
+    }
+    return text;
+}
+
+const char *datasetTypeName(DatasetType type)
+{
+    constexpr const char *Names[] = {"UnstructuredGrid", "ImageData", "RectilinearGrid", "StructuredGrid",
+                                     "PolyData"};
+    return Names[static_cast<std::size_t>(type)];
+}
+
+/**
+ * Writes the data of a block in base64. Like vtk, the header and the compressed data are encoded as separate streams,
+ * the header and the data of uncompressed blocks as one.
+ */
+void writeBase64Block(XMLWriter &writer, const DataBlock &data_block, const compression::Info &compression,
+                      HeaderType header_type)
+{
+    const auto header_size = headerSize(data_block, compression);
+    const auto widened = header_type == HeaderType::UInt64 && data_block.header_type == HeaderType::UInt32
+                             ? widenHeader(data_block, compression)
+                             : Data{};
+    const std::span<const std::uint8_t> header =
+        widened.empty() ? std::span(data_block.block).first(header_size) : std::span(widened);
+    const std::span<const std::uint8_t> data = std::span(data_block.block).subspan(header_size);
+    if (compression.active)
+    {
+        writer.writeBase64(std::array{header}, compression.threads);
+        writer.writeBase64(std::array{data, data_block.reference}, compression.threads);
+    }
     else
-        writer.openXMLElement("VTKFile", {Attr{"type", "UnstructuredGrid"}, Attr{"version", "0.1"},
-                                          Attr{"byte_order", endian()}, Attr{"compressor", "vtkZLibDataCompressor"}});
+    {
+        writer.writeBase64(std::array{header, data, data_block.reference}, compression.threads);
+    }
+}
+
+/**
+ * Returns the number of characters writeBase64Block writes for a block.
+ */
+std::uint64_t base64BlockSize(const DataBlock &data_block, const compression::Info &compression,
+                              HeaderType header_type)
+{
+    auto header_size = headerSize(data_block, compression);
+    const auto data_size = data_block.size() - header_size;
+    // A widened header has twice the number of bytes
+    if (header_type == HeaderType::UInt64 && data_block.header_type == HeaderType::UInt32) header_size *= 2;
+    if (compression.active) return base64Size(header_size) + base64Size(data_size);
+    return base64Size(header_size + data_size);
+}
+
+/**
+ * The settings a piece writes its DataArray elements with.
+ */
+struct ArrayFormat
+{
+    const compression::Info &compression;
+    HeaderType header_type;
+};
 
-    writer.openXMLElement("UnstructuredGrid");
+/**
+ * Writes a DataArray element, which either refers to the appended section or holds the data in base64.
+ */
+void writeArray(XMLWriter &writer, const ArrayFormat &format, const AppendedBlock &array)
+{
+    if (format.compression.encoding != compression::Encoding::InlineBase64)
     {
-        writer.openXMLElement("Piece", {Attr{"NumberOfPoints", std::to_string(point_count_)},
-                                        Attr{"NumberOfCells", std::to_string(cell_count_)}});
+        writer.writeDataArrayElement(*array.data_block, array.offset);
+        return;
+    }
+    writer.openDataArrayElement(*array.data_block);
+    writer.writeContent("", true, false);
+    writeBase64Block(writer, *array.content, format.compression, format.header_type);
+    writer.writeContent("", false, true);
+    writer.endXMLElement();
+}
+
+void writePointAndCellData(XMLWriter &writer, const ArrayFormat &format, const PieceDescription &piece)
+{
+    writer.openXMLElement("PointData");
+    for (const auto &array : piece.point_data) writeArray(writer, format, array);
+    writer.endXMLElement();
+
+    writer.openXMLElement("CellData");
+    for (const auto &array : piece.cell_data) writeArray(writer, format, array);
+    writer.endXMLElement();
+}
+
+void writeUnstructuredPiece(XMLWriter &writer, const ArrayFormat &format, const PieceDescription &piece)
+{
+    using Attr = XMLWriter::Attribute;
+    writer.openXMLElement("Piece", {Attr{"NumberOfPoints", std::to_string(piece.point_count)},
+                                    Attr{"NumberOfCells", std::to_string(piece.cell_count)}});
+    {
+        writer.openXMLElement("Points");
+        writeArray(writer, format, piece.points);
+        writer.endXMLElement();
+
+        writer.openXMLElement("Cells");
+        writeArray(writer, format, piece.cell_connectivity);
+        writeArray(writer, format, piece.cell_offsets);
+        writeArray(writer, format, piece.cell_types);
+        writer.endXMLElement();
+
+        writePointAndCellData(writer, format, piece);
+    }
+    writer.endXMLElement();
+}
+
+/**
+ * Writes the piece of an image, rectilinear, or structured grid, whose cells follow from its extent.
+ */
+void writeStructuredPiece(XMLWriter &writer, const ArrayFormat &format, const PieceDescription &piece)
+{
+    using Attr = XMLWriter::Attribute;
+    writer.openXMLElement("Piece", {Attr{"Extent", formatExtent(piece.structure.dimensions)}});
+    {
+        // The order of the vtk writers, whose readers accept any order
+        writePointAndCellData(writer, format, piece);
+        if (piece.structure.type == DatasetType::StructuredGrid)
         {
-            std::uint32_t currentOffset = 0;
             writer.openXMLElement("Points");
-            writer.writeDataArrayElement(points_, currentOffset);
-            currentOffset += static_cast<std::uint32_t>(points_.block.size());
+            writeArray(writer, format, piece.points);
             writer.endXMLElement();
+        }
+        else if (piece.structure.type == DatasetType::RectilinearGrid)
+        {
+            writer.openXMLElement("Coordinates");
+            for (const auto &coordinate : piece.coordinates) writeArray(writer, format, coordinate);
+            writer.endXMLElement();
+        }
+    }
+    writer.endXMLElement();
+}
 
-            writer.openXMLElement("Cells");
-            writer.writeDataArrayElement(cell_connectivity_, currentOffset);
-            currentOffset += static_cast<std::uint32_t>(cell_connectivity_.block.size());
+/**
+ * Writes the piece of a PolyData, whose cells are split into verts, lines, and polys. Sections without cells are
+ * omitted, strips are never written.
+ */
+void writePolyPiece(XMLWriter &writer, const ArrayFormat &format, const PieceDescription &piece)
+{
+    using Attr = XMLWriter::Attribute;
+    const auto &[verts, lines, polys] = piece.structure.poly_counts;
+    writer.openXMLElement("Piece", {Attr{"NumberOfPoints", std::to_string(piece.point_count)},
+                                    Attr{"NumberOfVerts", std::to_string(verts)},
+                                    Attr{"NumberOfLines", std::to_string(lines)}, Attr{"NumberOfStrips", "0"},
+                                    Attr{"NumberOfPolys", std::to_string(polys)}});
+    {
+        writePointAndCellData(writer, format, piece);
 
-            writer.writeDataArrayElement(cell_offsets_, currentOffset);
-            currentOffset += static_cast<std::uint32_t>(cell_offsets_.block.size());
+        writer.openXMLElement("Points");
+        writeArray(writer, format, piece.points);
+        writer.endXMLElement();
 
-            writer.writeDataArrayElement(cell_types_, currentOffset);
-            currentOffset += static_cast<std::uint32_t>(cell_types_.block.size());
+        constexpr const char *Sections[] = {"Verts", "Lines", "Polys"};
+        auto cell_blocks = piece.poly_cells.begin();
+        for (std::size_t section = 0; section < piece.structure.poly_counts.size(); ++section)
+        {
+            if (piece.structure.poly_counts[section] == 0) continue;
+            writer.openXMLElement(Sections[section]);
+            for (const auto end = cell_blocks + 2; cell_blocks != end; ++cell_blocks)
+                writeArray(writer, format, *cell_blocks);
             writer.endXMLElement();
+        }
+    }
+    writer.endXMLElement();
+}
 
-            writer.openXMLElement("PointData");
-            for (const auto &data : point_data_)
-            {
-                writer.writeDataArrayElement(data, currentOffset);
-                currentOffset += static_cast<std::uint32_t>(data.block.size());
-            }
-            writer.endXMLElement();
+/**
+ * Returns the header type of a file holding the passed blocks.
+ */
+HeaderType headerType(const std::vector<const DataBlock *> &data_blocks)
+{
+    std::uint64_t totalSize = 0;
+    bool wide = false;
+    for (const auto *data_block : data_blocks)
+    {
+        totalSize += data_block->size();
+        wide = wide || data_block->header_type == HeaderType::UInt64;
+    }
+    return wide || totalSize > std::numeric_limits<std::uint32_t>::max() ? HeaderType::UInt64 : HeaderType::UInt32;
+}
+}  // namespace
 
-            writer.openXMLElement("CellData");
-            for (const auto &data : cell_data_)
-            {
-                writer.writeDataArrayElement(data, currentOffset);
-                currentOffset += static_cast<std::uint32_t>(data.block.size());
-            }
-            writer.endXMLElement();
+std::uint64_t structuredCellCount(const std::array<std::uint64_t, 3> &dimensions)
+{
+    std::uint64_t cell_count = 1;
+    for (const auto dimension : dimensions)
+    {
+        if (dimension == 0)
+            throw std::invalid_argument("[structuredCellCount] a grid needs at least one point per axis");
+        cell_count *= std::max<std::uint64_t>(dimension - 1, 1);
+    }
+    return cell_count;
+}
+
+std::vector<const DataBlock *> Topology::blocks() const
+{
+    switch (structure.type)
+    {
+    case DatasetType::ImageData:
+        return {};
+    case DatasetType::RectilinearGrid:
+    {
+        std::vector<const DataBlock *> blocks;
+        for (const auto &coordinate : coordinates) blocks.push_back(&coordinate);
+        return blocks;
+    }
+    case DatasetType::StructuredGrid:
+        return {&points};
+    case DatasetType::PolyData:
+    {
+        std::vector<const DataBlock *> blocks{&points};
+        for (const auto &cells : poly_cells) blocks.push_back(&cells);
+        return blocks;
+    }
+    case DatasetType::UnstructuredGrid:
+        break;
+    }
+    return {&points, &cell_connectivity, &cell_offsets, &cell_types};
+}
+
+void writeHeader(XMLWriter &writer, const compression::Info &compression, HeaderType header_type,
+                 const PieceDescription &piece)
+{
+    using Attr = XMLWriter::Attribute;
+    const auto &structure = piece.structure;
+    const std::string type = datasetTypeName(structure.type);
+    std::vector<Attr> attributes{Attr{"type", type}, Attr{"version", "0.1"}, Attr{"byte_order", endian()}};
+    // UInt32 is the default header type, the attribute is only written if needed to keep small files unchanged
+    if (header_type == HeaderType::UInt64) attributes.emplace_back(Attr{"header_type", "UInt64"});
+    if (compression.active) attributes.emplace_back(Attr{"compressor", compressorName(compression)});
+    writer.openXMLElement("VTKFile", attributes);
+
+    const ArrayFormat format{compression, header_type};
+    if (structure.type == DatasetType::UnstructuredGrid || structure.type == DatasetType::PolyData)
+    {
+        writer.openXMLElement(type);
+        if (structure.type == DatasetType::PolyData)
+            writePolyPiece(writer, format, piece);
+        else
+            writeUnstructuredPiece(writer, format, piece);
+    }
+    else
+    {
+        std::vector<Attr> grid_attributes{Attr{"WholeExtent", formatExtent(structure.dimensions)}};
+        if (structure.type == DatasetType::ImageData)
+        {
+            grid_attributes.emplace_back(Attr{"Origin", formatNumbers(structure.origin)});
+            grid_attributes.emplace_back(Attr{"Spacing", formatNumbers(structure.spacing)});
         }
-        writer.endXMLElement();
+        writer.openXMLElement(type, grid_attributes);
+        writeStructuredPiece(writer, format, piece);
     }
     writer.endXMLElement();
 
-    writer.openXMLElement("AppendedData", {Attr{"encoding", "raw"}});
+    if (compression.encoding == compression::Encoding::InlineBase64) return;
+    const bool base64 = compression.encoding == compression::Encoding::AppendedBase64;
+    writer.openXMLElement("AppendedData", {Attr{"encoding", base64 ? "base64" : "raw"}});
+}
+
+const compression::Info &GridData::checkOverride(const std::string &name, const compression::Info &compression) const
+{
+    // The VTKFile element declares one compressor for all arrays, hence only the settings within a codec can differ
+    if (compression.active != compression_.active || (compression.active && compression.codec != compression_.codec))
+        throw std::invalid_argument("[GridData::addData] array '" + name +
+                                    "' must be compressed if and only if the grid is, and with the codec of the grid");
+    return compression;
+}
+
+DataBlock GridData::createUniqueBlock(DataBlock::Type type, const std::string &name,
+                                      std::span<const std::uint8_t> bytes, std::uint32_t number_of_components,
+                                      const compression::Info &compression, bool reference) const
+{
+    if (!compression.deduplicate) return createBlock(type, name, bytes, number_of_components, compression, reference);
+
+    const auto begin = std::chrono::steady_clock::now();
+    const auto key = contentKey(type, bytes, compression);
+    auto holdsBytes = [&](const DataBlock &candidate)
     {
-        writer.writeContent("_", true, false);
-        writer.writeData(points_.block);
-        writer.writeData(cell_connectivity_.block);
-        writer.writeData(cell_offsets_.block);
-        writer.writeData(cell_types_.block);
+        return candidate.content_key == key && candidate.duplicate_of == nullptr &&
+               holdsData(candidate, bytes, compression);
+    };
 
-        for (const auto &data : point_data_)
+    const DataBlock *original = nullptr;
+    if (const auto it = std::ranges::find_if(point_data_, holdsBytes); it != point_data_.end())
+        original = &*it;
+    else if (const auto it = std::ranges::find_if(cell_data_, holdsBytes); it != cell_data_.end())
+        original = &*it;
+
+    if (original != nullptr)
+    {
+        DataBlock duplicate{type, name, number_of_components, {}, {}, original->header_type};
+        duplicate.content_key = key;
+        duplicate.duplicate_of = original;
+        duplicate.creation = {begin, std::chrono::steady_clock::now()};
+        return duplicate;
+    }
+    auto data_block = createBlock(type, name, bytes, number_of_components, compression, reference);
+    data_block.content_key = key;
+    return data_block;
+}
+
+void GridData::write(const std::filesystem::path &file_path, std::uint64_t bandwidth,
+                     statistics::Info *statistics) const
+{
+    XMLWriter writer(file_path);
+    writer.limitBandwidth(bandwidth);
+    write(writer, statistics);
+}
+
+void GridData::write(Sink &sink, std::uint64_t bandwidth, statistics::Info *statistics) const
+{
+    XMLWriter writer(sink);
+    writer.limitBandwidth(bandwidth);
+    write(writer, statistics);
+}
+
+void GridData::write(XMLWriter &writer, statistics::Info *statistics) const
+{
+    const auto write_begin = std::chrono::steady_clock::now();
+    // The blocks in the order of the appended section, deferred ones are replaced by their compressed blocks
+    auto data_blocks = topology_->blocks();
+    const auto point_data_begin = data_blocks.size();
+    for (const auto &data : point_data_) data_blocks.push_back(&data);
+    for (const auto &data : cell_data_) data_blocks.push_back(&data);
+    // The index of the block holding the data of each block, duplicates share the appended data of another block
+    std::vector<std::size_t> contents(data_blocks.size());
+    for (std::size_t i = 0; i < data_blocks.size(); ++i)
+    {
+        const auto *original = data_blocks[i]->duplicate_of;
+        contents[i] = original == nullptr ? i : static_cast<std::size_t>(std::ranges::find(data_blocks, original) -
+                                                                          data_blocks.begin());
+    }
+    const auto compressed_blocks = compressDeferred(data_blocks, compression_.threads);
+
+    const auto header_type = headerType(data_blocks);
+    // Blocks with 32 bit headers in a file with 64 bit headers grow by their header size
+    auto needsWidening = [&](const DataBlock &data_block)
+    { return header_type == HeaderType::UInt64 && data_block.header_type == HeaderType::UInt32; };
+
+    // The offsets of base64 data count the characters
+    const auto encoding = compression_.encoding;
+    std::vector<std::uint64_t> offsets(data_blocks.size());
+    std::uint64_t currentOffset = 0;
+    for (std::size_t i = 0; i < data_blocks.size(); ++i)
+    {
+        if (contents[i] != i) continue;
+        offsets[i] = currentOffset;
+        if (encoding == compression::Encoding::AppendedBase64)
         {
-            writer.writeData(data.block);
+            currentOffset += base64BlockSize(*data_blocks[i], compression_, header_type);
+            continue;
         }
+        currentOffset += data_blocks[i]->size();
+        if (needsWidening(*data_blocks[i])) currentOffset += headerSize(*data_blocks[i], compression_);
+    }
+    for (std::size_t i = 0; i < data_blocks.size(); ++i) offsets[i] = offsets[contents[i]];
+    auto appended = [&](std::size_t i) { return AppendedBlock{data_blocks[i], offsets[i], data_blocks[contents[i]]}; };
 
-        for (const auto &data : cell_data_)
+    PieceDescription piece{point_count_, cell_count_, {}, {}, {}, {}, {}, {}, topology_->structure, {}};
+    switch (topology_->structure.type)
+    {
+    case DatasetType::UnstructuredGrid:
+        piece.cell_connectivity = appended(1);
+        piece.cell_offsets = appended(2);
+        piece.cell_types = appended(3);
+        [[fallthrough]];
+    case DatasetType::StructuredGrid:
+        piece.points = appended(0);
+        break;
+    case DatasetType::RectilinearGrid:
+        for (std::size_t i = 0; i < point_data_begin; ++i) piece.coordinates.emplace_back(appended(i));
+        break;
+    case DatasetType::PolyData:
+        piece.points = appended(0);
+        for (std::size_t i = 1; i < point_data_begin; ++i) piece.poly_cells.emplace_back(appended(i));
+        break;
+    case DatasetType::ImageData:
+        break;
+    }
+    const auto cell_data_begin = point_data_begin + point_data_.size();
+    for (std::size_t i = point_data_begin; i < cell_data_begin; ++i) piece.point_data.emplace_back(appended(i));
+    for (std::size_t i = cell_data_begin; i < data_blocks.size(); ++i) piece.cell_data.emplace_back(appended(i));
+
+    writeHeader(writer, compression_, header_type, piece);
+    // With statistics, every block is flushed on its own to measure its I/O time
+    std::vector<WrittenArray> written;
+    std::uint64_t held_memory = 0;
+    if (encoding == compression::Encoding::InlineBase64)
+    {
+        // The data was encoded into the XML, which is written at once
+        writer.endXMLElement();
+        held_memory = writer.bufferedBytes();
+        const auto begin = std::chrono::steady_clock::now();
+        writer.flush();
+        const TimeSpan io{begin, std::chrono::steady_clock::now()};
+        if (statistics == nullptr) return;
+        for (std::size_t i = 0; i < data_blocks.size(); ++i)
+            written.push_back({data_blocks[i], data_blocks[contents[i]], io});
+        collectStatistics(written, compression_, {write_begin, std::chrono::steady_clock::now()}, held_memory,
+                          *statistics);
+        return;
+    }
+    // The writer references the data until it is flushed, hence the widened headers are kept until then
+    std::vector<Data> widened_headers;
+    {
+        auto writeBlock = [&](const DataBlock &data_block)
+        {
+            if (encoding == compression::Encoding::AppendedBase64)
+            {
+                writeBase64Block(writer, data_block, compression_, header_type);
+            }
+            else if (needsWidening(data_block))
+            {
+                writer.writeData(widened_headers.emplace_back(widenHeader(data_block, compression_)));
+                writer.writeData(std::span(data_block.block).subspan(headerSize(data_block, compression_)));
+                writer.writeData(data_block.reference);
+                held_memory += widened_headers.back().size();
+            }
+            else
+            {
+                writer.writeData(data_block.block);
+                writer.writeData(data_block.reference);
+            }
+            if (statistics == nullptr) return;
+
+            held_memory += data_block.block.size();
+            const auto begin = std::chrono::steady_clock::now();
+            writer.flush();
+            written.push_back({&data_block, &data_block, {begin, std::chrono::steady_clock::now()}});
+        };
+        writer.writeContent("_", true, false);
+        if (statistics != nullptr)
         {
-            writer.writeData(data.block);
+            held_memory = writer.bufferedBytes();
+            writer.flush();
+        }
+        for (std::size_t i = 0; i < data_blocks.size(); ++i)
+        {
+            if (contents[i] == i)
+            {
+                writeBlock(*data_blocks[i]);
+            }
+            else if (statistics != nullptr)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                written.push_back({data_blocks[i], data_blocks[contents[i]], {now, now}});
+            }
         }
 
         writer.writeContent("", false, true);
@@ -92,5 +548,66 @@ void GridData::write(const std::filesystem::path &file_path) const
     writer.endXMLElement();
 
     writer.endXMLElement();
+    writer.flush();
+
+    if (statistics != nullptr)
+        collectStatistics(written, compression_, {write_begin, std::chrono::steady_clock::now()}, held_memory,
+                          *statistics);
+}
+
+void GridData::writeParallel(const std::filesystem::path &file_path, const std::vector<std::string> &sources) const
+{
+    using Attr = XMLWriter::Attribute;
+    XMLWriter writer(file_path);
+    writer.openXMLElement("VTKFile", {Attr{"type", "PUnstructuredGrid"}, Attr{"version", "0.1"},
+                                      Attr{"byte_order", endian()}});
+    writer.openXMLElement("PUnstructuredGrid", {Attr{"GhostLevel", "0"}});
+    {
+        writer.openXMLElement("PPointData");
+        for (const auto &data : point_data_) writer.writePDataArrayElement(data);
+        writer.endXMLElement();
+
+        writer.openXMLElement("PCellData");
+        for (const auto &data : cell_data_) writer.writePDataArrayElement(data);
+        writer.endXMLElement();
+
+        writer.openXMLElement("PPoints");
+        writer.writePDataArrayElement(topology_->points);
+        writer.endXMLElement();
+
+        for (const auto &source : sources) writer.inlineXMLElement("Piece", {Attr{"Source", source}});
+    }
+    writer.endXMLElement();
+    writer.endXMLElement();
+    writer.flush();
+}
+
+bool GridData::hasSameArrays(const GridData &other) const
+{
+    auto same = [](const DataBlock &a, const DataBlock &b)
+    { return a.type == b.type && a.name == b.name && a.number_of_components == b.number_of_components; };
+    return same(topology_->points, other.topology_->points) &&
+           std::ranges::equal(point_data_, other.point_data_, same) &&
+           std::ranges::equal(cell_data_, other.cell_data_, same);
+}
+
+void writeCollection(const std::filesystem::path &file_path, const std::vector<CollectionEntry> &entries)
+{
+    using Attr = XMLWriter::Attribute;
+    XMLWriter writer(file_path);
+    writer.openXMLElement("VTKFile",
+                          {Attr{"type", "Collection"}, Attr{"version", "0.1"}, Attr{"byte_order", endian()}});
+    writer.openXMLElement("Collection");
+    for (const auto &[time, file] : entries)
+    {
+        // The shortest representation which reads back to the same value
+        std::array<char, 32> buffer{};
+        const auto end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), time).ptr;
+        writer.inlineXMLElement("DataSet", {Attr{"timestep", std::string(buffer.data(), end)}, Attr{"part", "0"},
+                                            Attr{"file", file}});
+    }
+    writer.endXMLElement();
+    writer.endXMLElement();
+    writer.flush();
 }
 }  // namespace tinyvtu::internal
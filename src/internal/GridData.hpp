@@ -1,10 +1,132 @@
 #pragma once
+#include <array>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <utility>
 
 #include "internal/DataBlock.hpp"
+#include "internal/Precision.hpp"
 
 namespace tinyvtu::internal {
+class XMLWriter;
+
+/**
+ * The grid types, named like the type attribute of a VTKFile.
+ */
+enum class DatasetType : std::uint8_t
+{
+    UnstructuredGrid,
+    ImageData,
+    RectilinearGrid,
+    StructuredGrid,
+    PolyData
+};
+
+/**
+ * The type of a grid and, for the structured types, the extent their points and cells follow from.
+ *
+ * The cells of a PolyData are split into sections, poly_counts holds the number of cells of each.
+ */
+struct Structure
+{
+    DatasetType type = DatasetType::UnstructuredGrid;
+    std::array<std::uint64_t, 3> dimensions{};   ///< The number of points along each axis of structured grids
+    std::array<double, 3> origin{};              ///< The position of the first point of an image
+    std::array<double, 3> spacing{};             ///< The distance between the points of an image along each axis
+    std::array<std::uint64_t, 3> poly_counts{};  ///< The number of verts, lines, and polys of a PolyData
+};
+
+/**
+ * Returns the number of cells of a structured grid with the passed number of points along each axis.
+ *
+ * Axes with a single point are flat and do not multiply the cells, e.g. a 2D image of 4x3 points has 6 cells.
+ *
+ * @throws std::invalid_argument if a dimension is zero
+ */
+std::uint64_t structuredCellCount(const std::array<std::uint64_t, 3> &dimensions);
+
+/**
+ * A data block together with its offset in the appended section.
+ *
+ * The content is the block holding the data, which differs from data_block for duplicates. It is only needed to write
+ * the data inline, see compression::Encoding::InlineBase64.
+ */
+struct AppendedBlock
+{
+    const DataBlock *data_block;
+    std::uint64_t offset;
+    const DataBlock *content = nullptr;
+};
+
+/**
+ * Describes a piece of a grid whose arrays are stored in the appended section.
+ *
+ * The cells of an unstructured grid are written from cell_connectivity, cell_offsets, and cell_types. Structured grids
+ * only write points, image data writes neither points nor cells, and rectilinear grids write their coordinates. A
+ * PolyData writes its points and the connectivity and offsets of each section holding cells.
+ */
+struct PieceDescription
+{
+    std::uint64_t point_count;
+    std::uint64_t cell_count;
+    AppendedBlock points;
+    AppendedBlock cell_connectivity;
+    AppendedBlock cell_offsets;
+    AppendedBlock cell_types;
+    std::vector<AppendedBlock> point_data;
+    std::vector<AppendedBlock> cell_data;
+    Structure structure = {};
+    std::vector<AppendedBlock> coordinates = {};
+    std::vector<AppendedBlock> poly_cells = {};
+};
+
+/**
+ * Writes the XML description of a grid up to and including the opening AppendedData element.
+ *
+ * The caller continues with the appended data and closes the AppendedData and VTKFile elements. With
+ * compression::Encoding::InlineBase64 the DataArray elements hold their data and no AppendedData element is opened,
+ * the caller only closes the VTKFile element.
+ *
+ * @param writer The writer to write to.
+ * @param compression The compression settings the data blocks were created with.
+ * @param header_type The width of the size fields of all appended arrays.
+ * @param piece The description of the piece.
+ */
+void writeHeader(XMLWriter &writer, const compression::Info &compression, HeaderType header_type,
+                 const PieceDescription &piece);
+
+/**
+ * The points and cells of a grid.
+ *
+ * The topology is shared between grids with the same points and cells, e.g. the steps of a time series, so its blocks
+ * are compressed only once. Only unstructured grids hold cell blocks, see blocks().
+ */
+struct Topology
+{
+    std::uint64_t point_count = 0;
+    std::uint64_t cell_count = 0;
+    DataBlock points;
+    DataBlock cell_connectivity;
+    DataBlock cell_offsets;
+    DataBlock cell_types;
+    Structure structure = {};
+    /**
+     * The coordinates along the x, y, and z axis of a rectilinear grid.
+     */
+    std::vector<DataBlock> coordinates = {};
+    /**
+     * The connectivity and offsets of the verts, lines, and polys of a PolyData, of the sections holding cells only.
+     */
+    std::vector<DataBlock> poly_cells = {};
+
+    /**
+     * Returns the blocks written for the type of the grid, in the order of the appended section.
+     */
+    [[nodiscard]] std::vector<const DataBlock *> blocks() const;
+};
+
 class GridData final
 {
 public:
@@ -19,14 +141,24 @@ public:
      * @param cell_types A DataBlock containing the types of the cells.
      * @param compression Compression settings to be applied on the grid data.
      */
-    GridData(std::uint32_t point_count, DataBlock &&points, std::uint32_t cell_count, DataBlock &&cell_connectivity,
-             DataBlock &&cell_offsets, DataBlock &&cell_types, compression::Info const &compression) noexcept
-        : point_count_(point_count),
-          cell_count_(cell_count),
-          points_(std::move(points)),
-          cell_connectivity_(std::move(cell_connectivity)),
-          cell_offsets_(std::move(cell_offsets)),
-          cell_types_(std::move(cell_types)),
+    GridData(std::uint64_t point_count, DataBlock &&points, std::uint64_t cell_count, DataBlock &&cell_connectivity,
+             DataBlock &&cell_offsets, DataBlock &&cell_types, compression::Info const &compression)
+        : GridData(std::make_shared<const Topology>(Topology{point_count, cell_count, std::move(points),
+                                                             std::move(cell_connectivity), std::move(cell_offsets),
+                                                             std::move(cell_types)}),
+                   compression)
+    {}
+
+    /**
+     * Constructs a GridData object sharing the passed topology.
+     *
+     * @param topology The points and cells of the grid, compressed with the passed compression settings.
+     * @param compression Compression settings to be applied on the grid data.
+     */
+    GridData(std::shared_ptr<const Topology> topology, compression::Info const &compression) noexcept
+        : point_count_(topology->point_count),
+          cell_count_(topology->cell_count),
+          topology_(std::move(topology)),
           compression_(compression)
     {}
 
@@ -42,39 +174,177 @@ public:
     template <bool is_cell_data, typename T>
     requires std::is_arithmetic_v<T>
     void addData(std::string const &name, std::vector<T> const &data, const std::uint32_t number_of_components)
+    {
+        addData<is_cell_data, T>(name, std::span<const T>(data), number_of_components, false);
+    }
+
+    /**
+     * Adds data to the grid, either as cell data or point data.
+     *
+     * @tparam is_cell_data Boolean indicating whether the data being added is for cells (true) or points (false).
+     * @tparam T Type of the data elements, which must be an arithmetic type.
+     * @param name The name associated with the data block.
+     * @param data A view of the data elements.
+     * @param number_of_components The number of components per data element.
+     * @param reference If true and compression is inactive, the data is referenced instead of copied and must stay
+     *                  valid until the grid is written.
+     * @param compression Overrides the compression settings of the grid for this data block.
+     * @param precision The precision the data is written with, reducing it never references the data.
+     * @throws std::invalid_argument if the override differs from the grid in activity or codec
+     */
+    template <bool is_cell_data, typename T>
+    requires std::is_arithmetic_v<T>
+    void addData(std::string const &name, std::span<const T> data, const std::uint32_t number_of_components,
+                 bool reference, const std::optional<compression::Info> &compression = std::nullopt,
+                 const precision::Info &precision = {})
     {
         const auto expected_size = (is_cell_data ? cell_count_ : point_count_) * number_of_components;
         if (data.size() != expected_size)
         {
             throw std::invalid_argument("Data size mismatch");
         }
+        const auto &block_compression = compression ? checkOverride(name, *compression) : compression_;
+        auto data_block =
+            reducesPrecision(precision)
+                ? createBlock(name, data, number_of_components, block_compression, precision)
+                : createUniqueBlock(blockType<T>(), name,
+                                    std::span(reinterpret_cast<const std::uint8_t *>(data.data()), data.size_bytes()),
+                                    number_of_components, block_compression, reference);
+        if constexpr (is_cell_data)
+        {
+            cell_data_.emplace_back(std::move(data_block));
+        }
+        else
+        {
+            point_data_.emplace_back(std::move(data_block));
+        }
+    }
+
+    /**
+     * Adds data which is generated one block at a time while it is compressed, either as cell data or point data.
+     *
+     * @tparam is_cell_data Boolean indicating whether the data being added is for cells (true) or points (false).
+     * @tparam T Type of the data elements, which must be an arithmetic type.
+     * @param name The name associated with the data block.
+     * @param size The number of data elements.
+     * @param number_of_components The number of components per data element.
+     * @param generate Writes the bytes of the data at an offset, may be called concurrently for different blocks.
+     * @param compression Overrides the compression settings of the grid for this data block.
+     * @throws std::invalid_argument if the size does not match or the override differs from the grid in activity or
+     *                               codec
+     */
+    template <bool is_cell_data, typename T>
+    requires std::is_arithmetic_v<T>
+    void addGenerated(std::string const &name, std::uint64_t size, const std::uint32_t number_of_components,
+                      const Generator &generate, const std::optional<compression::Info> &compression = std::nullopt)
+    {
+        const auto expected_size = (is_cell_data ? cell_count_ : point_count_) * number_of_components;
+        if (size != expected_size)
+        {
+            throw std::invalid_argument("Data size mismatch");
+        }
+        const auto &block_compression = compression ? checkOverride(name, *compression) : compression_;
+        auto data_block =
+            createBlock(blockType<T>(), name, size * sizeof(T), number_of_components, block_compression, generate);
         if constexpr (is_cell_data)
         {
-            cell_data_.emplace_back(createBlock(name, data, number_of_components, compression_));
+            cell_data_.emplace_back(std::move(data_block));
         }
         else
         {
-            point_data_.emplace_back(createBlock(name, data, number_of_components, compression_));
+            point_data_.emplace_back(std::move(data_block));
         }
     }
 
     /**
      * Writes the GridData to a file specified by the given file path.
      *
+     * The size fields are written with 64 bits if a data block needs them or the appended section exceeds 4 GiB,
+     * data blocks created with 32 bit headers are widened while writing.
+     *
      * @param file_path The file path where the GridData will be written.
+     * @param bandwidth The maximal average rate in bytes per second the data is written with, 0 is unlimited.
+     * @param statistics If not null, receives the sizes and times of all data blocks.
+     */
+    void write(const std::filesystem::path &file_path, std::uint64_t bandwidth = 0,
+               statistics::Info *statistics = nullptr) const;
+
+    /**
+     * Writes the GridData to a sink.
+     *
+     * @param sink The sink receiving the output.
+     * @param bandwidth The maximal average rate in bytes per second the data is written with, 0 is unlimited.
+     * @param statistics If not null, receives the sizes and times of all data blocks.
+     */
+    void write(Sink &sink, std::uint64_t bandwidth = 0, statistics::Info *statistics = nullptr) const;
+
+    /**
+     * Returns the number of tuples cell data (true) or point data (false) holds, i.e. the number of cells or points.
+     */
+    [[nodiscard]] std::uint64_t tupleCount(bool is_cell_data) const
+    {
+        return is_cell_data ? cell_count_ : point_count_;
+    }
+
+    /**
+     * Writes a parallel file (.pvtu) declaring the arrays of this grid and referencing the passed pieces.
+     *
+     * All pieces are expected to hold the same arrays as this grid, see hasSameArrays.
+     *
+     * @param file_path The file path where the parallel file will be written.
+     * @param sources The paths of the piece files, relative to the directory of the parallel file.
+     */
+    void writeParallel(const std::filesystem::path &file_path, const std::vector<std::string> &sources) const;
+
+    /**
+     * Returns whether the other grid holds arrays of the same names, types, and number of components in the same order,
+     * which is required for pieces of a parallel file.
      */
-    void write(const std::filesystem::path &file_path) const;
+    [[nodiscard]] bool hasSameArrays(const GridData &other) const;
 
 private:
-    const std::uint32_t point_count_ = 0;
-    const std::uint32_t cell_count_ = 0;
-    const DataBlock points_;
-    const DataBlock cell_connectivity_;
-    const DataBlock cell_offsets_;
-    const DataBlock cell_types_;
-    std::vector<DataBlock> point_data_;
-    std::vector<DataBlock> cell_data_;
+    /**
+     * Returns the override if the file can declare it, i.e. it is active and uses the codec if the grid does.
+     */
+    const compression::Info &checkOverride(const std::string &name, const compression::Info &compression) const;
+
+    /**
+     * Creates a data block, or with compression::Info::deduplicate a duplicate of a block of the grid holding the same
+     * data with the same settings.
+     *
+     * Duplicates are found by their content key, which is computed before compressing, and confirmed by comparing the
+     * data, they are not compressed.
+     */
+    DataBlock createUniqueBlock(DataBlock::Type type, const std::string &name, std::span<const std::uint8_t> bytes,
+                                std::uint32_t number_of_components, const compression::Info &compression,
+                                bool reference) const;
+
+    void write(XMLWriter &writer, statistics::Info *statistics) const;
+
+    const std::uint64_t point_count_ = 0;
+    const std::uint64_t cell_count_ = 0;
+    const std::shared_ptr<const Topology> topology_;
+    // Duplicates point to blocks of the grid, which hence must not move when data is added
+    std::deque<DataBlock> point_data_;
+    std::deque<DataBlock> cell_data_;
 
     const compression::Info compression_;
 };
+
+/**
+ * A dataset of a collection (.pvd) file.
+ */
+struct CollectionEntry
+{
+    double time;
+    std::string file;
+};
+
+/**
+ * Writes a collection (.pvd) file referencing the passed datasets, e.g. the steps of a time series.
+ *
+ * @param file_path The file path where the collection will be written.
+ * @param entries The time value and file of each dataset, the file is relative to the directory of the collection.
+ */
+void writeCollection(const std::filesystem::path &file_path, const std::vector<CollectionEntry> &entries);
 }  // namespace tinyvtu::internal
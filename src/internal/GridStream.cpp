@@ -0,0 +1,287 @@
+#include "internal/GridStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "internal/Compressor.hpp"
+#include "internal/GridData.hpp"
+#include "internal/XMLWriter.hpp"
+
+namespace tinyvtu::internal {
+namespace {
+/**
+ * Returns the compression settings if a stream can write them. The offsets of a stream are known before its data is
+ * compressed, which holds for raw data only.
+ */
+const compression::Info &checkEncoding(const compression::Info &compression)
+{
+    if (compression.encoding != compression::Encoding::AppendedRaw)
+        throw std::invalid_argument(
+            "[GridStream::GridStream] streaming grids are written with the AppendedRaw encoding");
+    return compression;
+}
+}  // namespace
+
+GridStream::GridStream(const std::filesystem::path &file_path, std::uint64_t point_count, std::uint64_t cell_count,
+                       const compression::Info &compression, const streaming::Info &streaming)
+    : point_count_(point_count),
+      cell_count_(cell_count),
+      compression_(checkEncoding(compression)),
+      streaming_(streaming),
+      header_type_(streaming.uint64Headers ? HeaderType::UInt64 : HeaderType::UInt32),
+      file_(file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc),
+      end_(streaming.headerReserve)
+{
+    if (!file_.is_open())
+        throw std::runtime_error(std::string("[GridStream::GridStream] could not open file '") + file_path.string() +
+                                 "'");
+    // The header space is filled with blanks until close() writes the header
+    const std::string blanks(streaming_.headerReserve, ' ');
+    file_.write(blanks.data(), static_cast<std::streamsize>(blanks.size()));
+
+    writer_ = std::thread(&GridStream::runWriter, this);
+}
+
+GridStream::~GridStream()
+{
+    if (closed_) return;
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        stopWriter();
+    }
+}
+
+void GridStream::append(Section section, DataBlock &&description, const std::uint8_t *source, std::uint64_t size)
+{
+    if (closed_) throw std::logic_error("[GridStream::append] stream is already closed");
+
+    if (requiredHeaderType(size, compression_) == HeaderType::UInt64 && header_type_ == HeaderType::UInt32)
+        throw std::invalid_argument("[GridStream::append] array '" + description.name +
+                                    "' needs 64 bit headers, set streaming::Info::uint64Headers");
+    description.header_type = header_type_;
+
+    const auto position = end_;
+    const auto field = headerFieldSize(header_type_);
+    if (!compression_.active)
+    {
+        // [#bytes][DATA], the data is written straight from the caller's memory
+        auto header = uncompressedHeader(size, header_type_);
+        acquire(header.size());
+        enqueue(end_, std::move(header), field);
+        enqueue(end_ + field, std::span(source, size));
+        end_ += field + size;
+        flush();
+    }
+    else
+    {
+        // [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks][DATA], the header is written after the data, as
+        // the compressed sizes are only known then
+        const auto blockCount = numberOfBlocks(size, compression_);
+        std::vector<std::uint32_t> compressedSizes(blockCount);
+        end_ += field * (3 + static_cast<std::uint64_t>(blockCount));
+
+        // A group of blocks is held twice while it is compressed with several threads, hence a group takes at most a
+        // quarter of the budget. This leaves room for the previous group being written in the meantime.
+        const auto blockBound = compressedBlockBound(resolveBlockSize(compression_), compression_);
+        const auto blocksPerGroup = static_cast<std::uint32_t>(
+            std::clamp<std::uint64_t>(streaming_.memoryBudget / 4 / blockBound, 1, std::max(blockCount, 1u)));
+        for (std::uint32_t firstBlock = 0; firstBlock < blockCount; firstBlock += blocksPerGroup)
+        {
+            const auto lastBlock = std::min(firstBlock + blocksPerGroup, blockCount);
+            const auto acquired = blockBound * (lastBlock - firstBlock);
+            acquire(acquired);
+
+            Data group;
+            compressBlocks(source, size, firstBlock, lastBlock, compression_, group, &compressedSizes[firstBlock]);
+            const auto groupSize = group.size();
+            enqueue(end_, std::move(group), acquired);
+            end_ += groupSize;
+        }
+
+        auto header = compressionHeader(size, compression_, compressedSizes, header_type_);
+        acquire(header.size());
+        const auto headerSize = header.size();
+        enqueue(position, std::move(header), headerSize);
+    }
+
+    WrittenBlock written{std::move(description), position - streaming_.headerReserve};
+    switch (section)
+    {
+    case Section::Points:
+        points_ = std::move(written);
+        break;
+    case Section::CellConnectivity:
+        cell_connectivity_ = std::move(written);
+        break;
+    case Section::CellOffsets:
+        cell_offsets_ = std::move(written);
+        break;
+    case Section::CellTypes:
+        cell_types_ = std::move(written);
+        break;
+    case Section::PointData:
+        point_data_.emplace_back(std::move(written));
+        break;
+    case Section::CellData:
+        cell_data_.emplace_back(std::move(written));
+        break;
+    }
+}
+
+void GridStream::acquire(std::uint64_t bytes)
+{
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [&]
+                  { return error_ || pending_bytes_ == 0 || pending_bytes_ + bytes <= streaming_.memoryBudget; });
+    if (error_) std::rethrow_exception(error_);
+    pending_bytes_ += bytes;
+}
+
+void GridStream::enqueue(std::uint64_t position, Data &&data, std::uint64_t acquired)
+{
+    const std::scoped_lock lock(mutex_);
+    // Only the actual size stays accounted until the writer is done with the data
+    pending_bytes_ = pending_bytes_ - acquired + data.size();
+    jobs_.emplace_back(Job{position, std::move(data), {}});
+    changed_.notify_all();
+}
+
+void GridStream::enqueue(std::uint64_t position, std::span<const std::uint8_t> view)
+{
+    const std::scoped_lock lock(mutex_);
+    jobs_.emplace_back(Job{position, {}, view});
+    changed_.notify_all();
+}
+
+void GridStream::flush()
+{
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [&] { return error_ || jobs_.empty(); });
+    if (error_) std::rethrow_exception(error_);
+}
+
+void GridStream::stopWriter()
+{
+    {
+        const std::scoped_lock lock(mutex_);
+        stop_ = true;
+        changed_.notify_all();
+    }
+    if (writer_.joinable()) writer_.join();
+}
+
+void GridStream::runWriter()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        changed_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) return;
+
+        const auto job = std::move(jobs_.front());
+        const bool failed = error_ != nullptr;
+        lock.unlock();
+
+        // After a failure the remaining jobs are only dropped to release their memory
+        std::exception_ptr error;
+        if (!failed)
+        {
+            const auto bytes = job.view.empty() ? std::span<const std::uint8_t>(job.data) : job.view;
+            file_.seekp(static_cast<std::streamoff>(job.position));
+            file_.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file_)
+                error = std::make_exception_ptr(std::runtime_error("[GridStream::runWriter] writing to file failed"));
+        }
+
+        lock.lock();
+        if (error) error_ = error;
+        pending_bytes_ -= job.data.size();
+        jobs_.pop_front();
+        changed_.notify_all();
+    }
+}
+
+void GridStream::moveAppendedData(std::uint64_t from, std::uint64_t to)
+{
+    // Moves [from, end_) to [to, ...) with to > from, starting at the end so no data is overwritten before it is read
+    Data buffer(static_cast<std::size_t>(std::clamp<std::uint64_t>(streaming_.memoryBudget, 1, 1 << 22)));
+    auto remaining = end_ - from;
+    while (remaining > 0)
+    {
+        const auto chunk = std::min<std::uint64_t>(remaining, buffer.size());
+        remaining -= chunk;
+        file_.seekg(static_cast<std::streamoff>(from + remaining));
+        file_.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(chunk));
+        file_.seekp(static_cast<std::streamoff>(to + remaining));
+        file_.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(chunk));
+    }
+    end_ += to - from;
+}
+
+void GridStream::close()
+{
+    if (closed_) return;
+    closed_ = true;
+
+    {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [&] { return jobs_.empty(); });
+    }
+    stopWriter();
+    if (error_) std::rethrow_exception(error_);
+
+    if (!points_ || !cell_connectivity_ || !cell_offsets_ || !cell_types_)
+        throw std::logic_error("[GridStream::close] points and cells must be written before closing");
+
+    auto appended = [](const WrittenBlock &written) { return AppendedBlock{&written.data_block, written.offset}; };
+    PieceDescription piece{point_count_,
+                           cell_count_,
+                           appended(*points_),
+                           appended(*cell_connectivity_),
+                           appended(*cell_offsets_),
+                           appended(*cell_types_),
+                           {},
+                           {}};
+    for (const auto &data : point_data_) piece.point_data.emplace_back(appended(data));
+    for (const auto &data : cell_data_) piece.cell_data.emplace_back(appended(data));
+
+    std::ostringstream rendered;
+    {
+        XMLWriter writer(rendered);
+        writeHeader(writer, compression_, header_type_, piece);
+        writer.writeContent("_", true, false);
+        writer.writeContent("", false, true);
+        writer.endXMLElement();
+        writer.endXMLElement();
+    }
+
+    // Everything in front of the '_' marker goes into the reserved space, the rest follows the appended data
+    const auto text = rendered.str();
+    const auto marker = text.rfind('_');
+    auto header = text.substr(0, marker);
+    const auto trailer = text.substr(marker + 1);
+
+    std::uint64_t dataStart = streaming_.headerReserve;
+    if (header.size() + 1 > dataStart)
+    {
+        moveAppendedData(dataStart, header.size() + 1);
+        dataStart = header.size() + 1;
+    }
+    header.append(dataStart - header.size() - 1, ' ');
+    header.push_back('_');
+
+    file_.seekp(0);
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file_.seekp(static_cast<std::streamoff>(end_));
+    file_.write(trailer.data(), static_cast<std::streamsize>(trailer.size()));
+    file_.close();
+    if (!file_) throw std::runtime_error("[GridStream::close] writing to file failed");
+}
+}  // namespace tinyvtu::internal
@@ -0,0 +1,175 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+
+#include "internal/DataBlock.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * @class GridStream
+ * @brief Writes an unstructured grid array by array straight into a file.
+ *
+ * Contrary to GridData, the compressed arrays are not kept until the grid is written. Each array is compressed in
+ * groups of blocks, every group is handed to a background thread writing it into the appended section and is freed
+ * afterward. Hence, compression of the next group overlaps with the disk write of the previous one, and the memory held
+ * by compressed data is bounded by the memory budget instead of the output size.
+ *
+ * The XML header is only known once all arrays are written. Its space is reserved at the start of the file and filled
+ * in by close(). If the header does not fit into the reserved space, the appended section is moved backwards.
+ */
+class GridStream final
+{
+public:
+    /**
+     * Identifies the part of the grid an array belongs to.
+     */
+    enum class Section
+    {
+        Points,
+        CellConnectivity,
+        CellOffsets,
+        CellTypes,
+        PointData,
+        CellData,
+    };
+
+    /**
+     * Creates the file and starts the background writer.
+     *
+     * @param file_path The file path where the grid will be written.
+     * @param point_count The number of points in the grid.
+     * @param cell_count The number of cells in the grid.
+     * @param compression Compression settings to be applied on the grid data.
+     * @param streaming The memory budget and header reserve of the stream.
+     * @throws std::invalid_argument if the compression settings do not use compression::Encoding::AppendedRaw
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    GridStream(const std::filesystem::path &file_path, std::uint64_t point_count, std::uint64_t cell_count,
+               const compression::Info &compression, const streaming::Info &streaming);
+
+    /**
+     * Closes the stream if close() was not called. Errors are swallowed, call close() to observe them.
+     */
+    ~GridStream();
+
+    GridStream(const GridStream &) = delete;
+
+    GridStream &operator=(const GridStream &) = delete;
+
+    /**
+     * Compresses an array and writes it to the file.
+     *
+     * The array is not referenced after the call returns.
+     *
+     * @tparam T Type of the data elements, which must be an arithmetic type.
+     * @param section The part of the grid the array belongs to.
+     * @param name The name of the array.
+     * @param data A view of the data elements.
+     * @param number_of_components The number of components per data element (can be zero for internal data).
+     * @throws std::invalid_argument if the array needs 64 bit headers, but the stream writes 32 bit ones
+     */
+    template <typename T>
+    requires std::is_arithmetic_v<T>
+    void addArray(Section section, std::string const &name, std::span<const T> data,
+                  const std::uint32_t number_of_components)
+    {
+        if (number_of_components != 0 && (data.size() % number_of_components != 0))
+        {
+            throw std::invalid_argument("data size must be divisible by number_of_components");
+        }
+        append(section, DataBlock{blockType<T>(), name, number_of_components, {}},
+               reinterpret_cast<const std::uint8_t *>(data.data()), data.size_bytes());
+    }
+
+    /**
+     * Adds data to the grid, either as cell data or point data.
+     *
+     * @tparam is_cell_data Boolean indicating whether the data being added is for cells (true) or points (false).
+     * @tparam T Type of the data elements, which must be an arithmetic type.
+     * @param name The name associated with the data block.
+     * @param data A view of the data elements.
+     * @param number_of_components The number of components per data element.
+     */
+    template <bool is_cell_data, typename T>
+    requires std::is_arithmetic_v<T>
+    void addData(std::string const &name, std::span<const T> data, const std::uint32_t number_of_components)
+    {
+        const auto expected_size = (is_cell_data ? cell_count_ : point_count_) * number_of_components;
+        if (data.size() != expected_size)
+        {
+            throw std::invalid_argument("Data size mismatch");
+        }
+        addArray(is_cell_data ? Section::CellData : Section::PointData, name, data, number_of_components);
+    }
+
+    /**
+     * Waits for all pending writes, writes the XML header and closes the file.
+     *
+     * @throws std::logic_error if the points or cells have not been written
+     * @throws std::runtime_error if writing to the file failed
+     */
+    void close();
+
+private:
+    struct Job
+    {
+        std::uint64_t position;
+        Data data;
+        std::span<const std::uint8_t> view;
+    };
+
+    struct WrittenBlock
+    {
+        DataBlock data_block;
+        std::uint64_t offset;
+    };
+
+    void append(Section section, DataBlock &&description, const std::uint8_t *source, std::uint64_t size);
+
+    void acquire(std::uint64_t bytes);
+
+    void enqueue(std::uint64_t position, Data &&data, std::uint64_t acquired);
+
+    void enqueue(std::uint64_t position, std::span<const std::uint8_t> view);
+
+    void flush();
+
+    void stopWriter();
+
+    void runWriter();
+
+    void moveAppendedData(std::uint64_t from, std::uint64_t to);
+
+    const std::uint64_t point_count_ = 0;
+    const std::uint64_t cell_count_ = 0;
+    const compression::Info compression_;
+    const streaming::Info streaming_;
+    const HeaderType header_type_;
+
+    std::fstream file_;
+    std::uint64_t end_;
+    bool closed_ = false;
+
+    std::optional<WrittenBlock> points_;
+    std::optional<WrittenBlock> cell_connectivity_;
+    std::optional<WrittenBlock> cell_offsets_;
+    std::optional<WrittenBlock> cell_types_;
+    std::vector<WrittenBlock> point_data_;
+    std::vector<WrittenBlock> cell_data_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<Job> jobs_;
+    std::uint64_t pending_bytes_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::thread writer_;
+};
+}  // namespace tinyvtu::internal
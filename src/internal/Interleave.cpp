@@ -0,0 +1,179 @@
+#include "internal/Interleave.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TINYVTU_INTERLEAVE_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TINYVTU_INTERLEAVE_NEON 1
+#endif
+
+namespace tinyvtu::internal {
+namespace {
+#if defined(TINYVTU_INTERLEAVE_SSE2) || defined(TINYVTU_INTERLEAVE_NEON)
+/**
+ * Interleaves the tuples [first, last) element by element, the tail left by the vector kernels.
+ */
+void interleaveElements(std::span<const std::uint8_t *const> components, std::size_t element_size, std::uint64_t first,
+                        std::uint64_t last, std::uint8_t *destination)
+{
+    for (auto tuple = first; tuple < last; ++tuple)
+    {
+        for (const auto *component : components)
+        {
+            std::memcpy(destination, component + tuple * element_size, element_size);
+            destination += element_size;
+        }
+    }
+}
+
+#if defined(TINYVTU_INTERLEAVE_SSE2)
+/**
+ * Combines the two lower 32-bit lanes of low with the two upper lanes of high as selected by Select.
+ */
+template <int Select>
+__m128i combine(__m128i low, __m128i high)
+{
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), Select));
+}
+#endif
+
+/**
+ * Interleaves the 16 bytes loaded from each of the Components arrays, i.e. 16 / ElementSize tuples, per iteration.
+ *
+ * The shuffles only move bits, hence floating point and integer data of the same size share the kernels.
+ *
+ * @return  The number of tuples interleaved, a multiple of 16 / ElementSize
+ */
+template <std::size_t ElementSize, std::size_t Components>
+std::uint64_t interleaveVectors(std::span<const std::uint8_t *const> components, std::uint64_t first,
+                                std::uint64_t count, std::uint8_t *destination)
+{
+    constexpr std::size_t tuplesPerVector = 16 / ElementSize;
+    std::array<const std::uint8_t *, Components> bases;
+    for (std::size_t c = 0; c < Components; ++c) bases[c] = components[c] + first * ElementSize;
+
+    std::uint64_t done = 0;
+    for (; done + tuplesPerVector <= count; done += tuplesPerVector, destination += 16 * Components)
+    {
+        const auto offset = done * ElementSize;
+#if defined(TINYVTU_INTERLEAVE_SSE2)
+        auto store = [destination](std::size_t i, __m128i value)
+        { _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + 16 * i), value); };
+        __m128i v[Components];
+        for (std::size_t c = 0; c < Components; ++c)
+            v[c] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bases[c] + offset));
+
+        if constexpr (ElementSize == 8 && Components == 2)
+        {
+            store(0, _mm_unpacklo_epi64(v[0], v[1]));
+            store(1, _mm_unpackhi_epi64(v[0], v[1]));
+        }
+        else if constexpr (ElementSize == 8 && Components == 3)
+        {
+            // a0 b0 | c0 a1 | b1 c1
+            store(0, _mm_unpacklo_epi64(v[0], v[1]));
+            store(1, _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(v[2]), _mm_castsi128_pd(v[0]), 2)));
+            store(2, _mm_unpackhi_epi64(v[1], v[2]));
+        }
+        else if constexpr (ElementSize == 8)
+        {
+            store(0, _mm_unpacklo_epi64(v[0], v[1]));
+            store(1, _mm_unpacklo_epi64(v[2], v[3]));
+            store(2, _mm_unpackhi_epi64(v[0], v[1]));
+            store(3, _mm_unpackhi_epi64(v[2], v[3]));
+        }
+        else if constexpr (Components == 2)
+        {
+            store(0, _mm_unpacklo_epi32(v[0], v[1]));
+            store(1, _mm_unpackhi_epi32(v[0], v[1]));
+        }
+        else if constexpr (Components == 3)
+        {
+            // a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3, each the lower half of one and the upper half of another pair
+            const auto ab0 = _mm_unpacklo_epi32(v[0], v[1]);
+            const auto ab2 = _mm_unpackhi_epi32(v[0], v[1]);
+            const auto bc0 = _mm_unpacklo_epi32(v[1], v[2]);
+            const auto bc2 = _mm_unpackhi_epi32(v[1], v[2]);
+            const auto ca0 = _mm_unpacklo_epi32(v[2], v[0]);
+            const auto ca2 = _mm_unpackhi_epi32(v[2], v[0]);
+            store(0, combine<_MM_SHUFFLE(3, 0, 1, 0)>(ab0, ca0));
+            store(1, combine<_MM_SHUFFLE(1, 0, 3, 2)>(bc0, ab2));
+            store(2, combine<_MM_SHUFFLE(3, 2, 3, 0)>(ca2, bc2));
+        }
+        else
+        {
+            // Transposes the 4 x 4 values
+            const auto ab0 = _mm_unpacklo_epi32(v[0], v[1]);
+            const auto ab2 = _mm_unpackhi_epi32(v[0], v[1]);
+            const auto cd0 = _mm_unpacklo_epi32(v[2], v[3]);
+            const auto cd2 = _mm_unpackhi_epi32(v[2], v[3]);
+            store(0, _mm_unpacklo_epi64(ab0, cd0));
+            store(1, _mm_unpackhi_epi64(ab0, cd0));
+            store(2, _mm_unpacklo_epi64(ab2, cd2));
+            store(3, _mm_unpackhi_epi64(ab2, cd2));
+        }
+#else
+        // The structure stores of NEON interleave 2 to 4 vectors
+        if constexpr (ElementSize == 8)
+        {
+            auto load = [&](std::size_t c)
+            { return vld1q_u64(reinterpret_cast<const std::uint64_t *>(bases[c] + offset)); };
+            auto *target = reinterpret_cast<std::uint64_t *>(destination);
+            if constexpr (Components == 2)
+                vst2q_u64(target, (uint64x2x2_t{{load(0), load(1)}}));
+            else if constexpr (Components == 3)
+                vst3q_u64(target, (uint64x2x3_t{{load(0), load(1), load(2)}}));
+            else
+                vst4q_u64(target, (uint64x2x4_t{{load(0), load(1), load(2), load(3)}}));
+        }
+        else
+        {
+            auto load = [&](std::size_t c)
+            { return vld1q_u32(reinterpret_cast<const std::uint32_t *>(bases[c] + offset)); };
+            auto *target = reinterpret_cast<std::uint32_t *>(destination);
+            if constexpr (Components == 2)
+                vst2q_u32(target, (uint32x4x2_t{{load(0), load(1)}}));
+            else if constexpr (Components == 3)
+                vst3q_u32(target, (uint32x4x3_t{{load(0), load(1), load(2)}}));
+            else
+                vst4q_u32(target, (uint32x4x4_t{{load(0), load(1), load(2), load(3)}}));
+        }
+#endif
+    }
+    return done;
+}
+
+template <std::size_t ElementSize>
+std::uint64_t interleaveVectors(std::span<const std::uint8_t *const> components, std::uint64_t first,
+                                std::uint64_t count, std::uint8_t *destination)
+{
+    switch (components.size())
+    {
+    case 2: return interleaveVectors<ElementSize, 2>(components, first, count, destination);
+    case 3: return interleaveVectors<ElementSize, 3>(components, first, count, destination);
+    default: return interleaveVectors<ElementSize, 4>(components, first, count, destination);
+    }
+}
+#endif
+}  // namespace
+
+bool interleave([[maybe_unused]] std::span<const std::uint8_t *const> components,
+                [[maybe_unused]] std::size_t element_size, [[maybe_unused]] std::uint64_t first,
+                [[maybe_unused]] std::uint64_t count, [[maybe_unused]] std::uint8_t *destination)
+{
+#if defined(TINYVTU_INTERLEAVE_SSE2) || defined(TINYVTU_INTERLEAVE_NEON)
+    if (components.size() < 2 || components.size() > 4 || (element_size != 4 && element_size != 8)) return false;
+    const auto done = element_size == 4 ? interleaveVectors<4>(components, first, count, destination)
+                                        : interleaveVectors<8>(components, first, count, destination);
+    interleaveElements(components, element_size, first + done, first + count,
+                       destination + done * components.size() * element_size);
+    return true;
+#else
+    return false;
+#endif
+}
+}  // namespace tinyvtu::internal
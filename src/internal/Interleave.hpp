@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace tinyvtu::internal {
+/**
+ * Interleaves tuples whose components are separate contiguous arrays, e.g. vx, vy, and vz, with vector instructions.
+ *
+ * Tuples of 2 to 4 components of 4 or 8 bytes are interleaved with SSE2 on x86-64 and NEON on AArch64, both part of
+ * the baseline of their architecture. Other tuples and other architectures are left to the caller.
+ *
+ * @param components    The arrays of the components
+ * @param element_size  The size of a component in bytes
+ * @param first         The first tuple to interleave
+ * @param count         The number of tuples
+ * @param destination   Receives count * components.size() * element_size bytes, need not be aligned
+ * @return              false if no vector kernel covers the tuples, destination is then unchanged
+ */
+bool interleave(std::span<const std::uint8_t *const> components, std::size_t element_size, std::uint64_t first,
+                std::uint64_t count, std::uint8_t *destination);
+}  // namespace tinyvtu::internal
@@ -0,0 +1,72 @@
+#include "internal/MappedFile.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TINYVTU_HAS_MMAP 1
+#else
+#define TINYVTU_HAS_MMAP 0
+#endif
+
+namespace tinyvtu::internal {
+namespace {
+[[noreturn]] void throwUnreadable(const std::filesystem::path &file_path)
+{
+    throw std::runtime_error("[MappedFile::MappedFile] could not read file '" + file_path.string() + "'");
+}
+}  // namespace
+
+MappedFile::MappedFile(const std::filesystem::path &file_path)
+{
+#if TINYVTU_HAS_MMAP
+    const int file_descriptor = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor < 0) throwUnreadable(file_path);
+    struct stat status{};
+    if (::fstat(file_descriptor, &status) != 0)
+    {
+        ::close(file_descriptor);
+        throwUnreadable(file_path);
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    // Mapping an empty file fails, its data stays empty
+    void *mapping = size_ > 0 ? ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0) : nullptr;
+    // The mapping keeps the file open
+    ::close(file_descriptor);
+    if (mapping == MAP_FAILED) throwUnreadable(file_path);
+    data_ = static_cast<const std::uint8_t *>(mapping);
+#else
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file) throwUnreadable(file_path);
+    contents_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = contents_.data();
+    size_ = contents_.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if TINYVTU_HAS_MMAP
+    if (data_ != nullptr) ::munmap(const_cast<std::uint8_t *>(data_), size_);
+#endif
+}
+
+void MappedFile::willNeed([[maybe_unused]] std::span<const std::uint8_t> range) const
+{
+#if TINYVTU_HAS_MMAP && defined(MADV_WILLNEED)
+    if (range.empty()) return;
+    // madvise needs an address aligned to pages
+    static const auto pageSize = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<std::uintptr_t>(range.data()) / pageSize * pageSize;
+    const auto end = reinterpret_cast<std::uintptr_t>(range.data() + range.size());
+    // The hint is optional, failures are ignored
+    static_cast<void>(::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED));
+#endif
+}
+}  // namespace tinyvtu::internal
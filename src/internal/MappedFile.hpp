@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace tinyvtu::internal {
+/**
+ * A read-only view of a file's contents.
+ *
+ * The file is memory-mapped where the system supports it, hence only the pages which are accessed are read from the
+ * disk. Otherwise, the whole file is read into memory.
+ */
+class MappedFile final
+{
+public:
+    /**
+     * Maps the file.
+     *
+     * @param file_path The path of the file
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::filesystem::path &file_path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::span<const std::uint8_t> data() const { return {data_, size_}; }
+
+    /**
+     * Hints the system that a range of the file is read soon, so it is read ahead while earlier ranges are processed.
+     *
+     * @param range A subrange of data()
+     */
+    void willNeed(std::span<const std::uint8_t> range) const;
+
+private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    /**
+     * The contents of the file if it cannot be memory-mapped.
+     */
+    std::vector<std::uint8_t> contents_;
+};
+}  // namespace tinyvtu::internal
@@ -0,0 +1,72 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tinyvtu::internal {
+/**
+ * Resolves the requested number of worker threads.
+ *
+ * @param threads  The requested number of threads, 0 selects the number of hardware threads
+ * @return         The number of threads to use, at least 1
+ */
+inline std::uint32_t resolveThreads(std::uint32_t threads)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max<std::uint32_t>(threads, 1);
+}
+
+/**
+ * Calls task(i) for every i in [0, count) on up to `threads` threads.
+ *
+ * Tasks are handed out dynamically, so tasks of different cost are balanced between the threads. The calling thread
+ * takes part in the work. If a task throws, the remaining tasks are skipped and the first exception is rethrown on the
+ * calling thread.
+ *
+ * @param count    The number of tasks
+ * @param threads  The maximal number of threads, 0 selects the number of hardware threads
+ * @param task     Callable invoked with the index of the task
+ */
+template <typename Task>
+void parallelFor(std::size_t count, std::uint32_t threads, Task &&task)
+{
+    const auto workerCount = static_cast<std::size_t>(std::min<std::size_t>(resolveThreads(threads), count));
+    if (workerCount <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next = 0;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&]
+    {
+        for (auto i = next++; i < count; i = next++)
+        {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                const std::scoped_lock lock(errorMutex);
+                if (!error) error = std::current_exception();
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::jthread> pool;
+    pool.reserve(workerCount - 1);
+    for (std::size_t i = 1; i < workerCount; ++i) pool.emplace_back(worker);
+    worker();
+    pool.clear();
+
+    if (error) std::rethrow_exception(error);
+}
+}  // namespace tinyvtu::internal
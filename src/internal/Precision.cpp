@@ -0,0 +1,273 @@
+#include "internal/Precision.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "internal/Parallel.hpp"
+
+namespace tinyvtu::internal {
+namespace {
+/**
+ * The number of values converted per task, large enough to amortize the scheduling.
+ */
+constexpr std::size_t valuesPerTask = 65536;
+
+/**
+ * Rounds the mantissa of floating point values to nearest, keeping kept_bits explicit mantissa bits.
+ *
+ * The operations are branch free on the bit pattern, so the loops calling it have no branches per value.
+ */
+template <typename T>
+class MantissaRounding
+{
+public:
+    using Bits = std::conditional_t<sizeof(T) == sizeof(std::uint64_t), std::uint64_t, std::uint32_t>;
+    static constexpr std::uint32_t mantissaBits = std::numeric_limits<T>::digits - 1;
+
+    explicit MantissaRounding(std::uint32_t kept_bits)
+    {
+        if (kept_bits >= mantissaBits) return;
+        const auto dropped = mantissaBits - kept_bits;
+        mask_ = ~((Bits{1} << dropped) - 1);
+        half_ = Bits{1} << (dropped - 1);
+    }
+
+    [[nodiscard]] bool active() const { return half_ != 0; }
+
+    T operator()(T value) const
+    {
+        constexpr Bits exponentMask = (~Bits{0} >> 1) & ~((Bits{1} << mantissaBits) - 1);
+        const auto bits = std::bit_cast<Bits>(value);
+        // The carry of rounding up moves into the exponent, which is exact unless the result overflows to infinity
+        const Bits rounded = (bits + half_) & mask_;
+        const Bits finite = (rounded & exponentMask) == exponentMask ? bits & mask_ : rounded;
+        // Infinities and NaNs are kept as they are
+        return std::bit_cast<T>((bits & exponentMask) == exponentMask ? bits : finite);
+    }
+
+private:
+    Bits mask_ = ~Bits{0};
+    Bits half_ = 0;
+};
+
+/**
+ * Returns whether a converted value does not fit into Target, NaNs and infinities always fit into floating point types.
+ */
+template <typename Target, typename T>
+bool outOfRange(T value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        const auto magnitude = std::abs(value);
+        return magnitude > static_cast<T>(std::numeric_limits<Target>::max()) &&
+               magnitude != std::numeric_limits<T>::infinity();
+    }
+    else
+    {
+        return std::cmp_less(value, std::numeric_limits<Target>::lowest()) ||
+               std::cmp_greater(value, std::numeric_limits<Target>::max());
+    }
+}
+
+/**
+ * Creates a DataBlock of size values of Target which convert(first, count, destination) writes block by block while
+ * the array is compressed, like other generated data, so the converted array is not held as a whole.
+ */
+template <typename Target, typename Convert>
+DataBlock createGeneratedBlock(const std::string &name, std::size_t size, std::uint32_t number_of_components,
+                               const compression::Info &compression, const Convert &convert)
+{
+    if (number_of_components != 0 && size % number_of_components != 0)
+        throw std::invalid_argument("data size must be divisible by number_of_components");
+
+    // Compressed blocks are converted on the compression threads, only whole arrays are split here
+    const auto threads = compression.active && !compression.deferred ? std::uint32_t{1} : compression.threads;
+    return createBlock(blockType<Target>(), name, std::uint64_t{size} * sizeof(Target), number_of_components,
+                       compression,
+                       valueGenerator<Target>(
+                           [&](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+                           {
+                               const auto taskCount = (count + valuesPerTask - 1) / valuesPerTask;
+                               parallelFor(taskCount, threads,
+                                           [&](const std::size_t task)
+                                           {
+                                               const auto begin = task * valuesPerTask;
+                                               const auto end = std::min<std::uint64_t>(begin + valuesPerTask, count);
+                                               convert(first + begin, end - begin,
+                                                       destination + begin * sizeof(Target));
+                                           });
+                           }));
+}
+
+/**
+ * Throws if a range of converted values had a value out of the range of Target or above the relative error bound.
+ */
+void checkConverted(const std::string &name, bool out_of_range, bool above_bound)
+{
+    if (out_of_range)
+        throw std::invalid_argument("[tinyvtu::createBlock] array '" + name +
+                                    "' has values out of the range of the narrowed type");
+    if (above_bound)
+        throw std::invalid_argument("[tinyvtu::createBlock] array '" + name +
+                                    "' has values, e.g. denormals, which cannot be written within the relative error");
+}
+
+/**
+ * Creates a DataBlock of the data converted to Target, rounding floating point mantissas before narrowing.
+ */
+template <typename Target, typename T>
+DataBlock createConvertedBlock(const std::string &name, std::span<const T> data, std::uint32_t number_of_components,
+                               const compression::Info &compression, const precision::Info &precision)
+{
+    // The checks are accumulated without branches and evaluated once per range of values
+    constexpr bool narrowing = !std::is_same_v<Target, T>;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        constexpr auto writtenBits = MantissaRounding<Target>::mantissaBits;
+        const auto kept = keptMantissaBits(precision, MantissaRounding<T>::mantissaBits, writtenBits);
+        // Rounding to the bits of Target is left to the conversion, otherwise it is exact for normal values
+        const MantissaRounding<T> round(kept < writtenBits ? kept : MantissaRounding<T>::mantissaBits);
+        const auto bound = precision.relativeError;
+        return createGeneratedBlock<Target>(
+            name, data.size(), number_of_components, compression,
+            [&](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+            {
+                std::uint8_t anyOutOfRange = 0;
+                std::uint8_t anyAboveBound = 0;
+                for (std::uint64_t i = 0; i < count; ++i)
+                {
+                    const auto original = data[first + i];
+                    const auto value = round.active() ? round(original) : original;
+                    if constexpr (narrowing) anyOutOfRange |= outOfRange<Target>(value);
+                    const auto converted = static_cast<Target>(value);
+                    // Denormals have fewer mantissa bits, so the error of the written value is checked
+                    const auto error = std::abs(static_cast<double>(converted) - original);
+                    anyAboveBound |= std::isfinite(original) && !(error <= bound * std::abs(original));
+                    std::memcpy(destination + i * sizeof(Target), &converted, sizeof(Target));
+                }
+                checkConverted(name, anyOutOfRange, bound > 0 && anyAboveBound);
+            });
+    }
+    else if constexpr (narrowing)
+    {
+        return createGeneratedBlock<Target>(
+            name, data.size(), number_of_components, compression,
+            [&](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+            {
+                std::uint8_t anyOutOfRange = 0;
+                for (std::uint64_t i = 0; i < count; ++i)
+                {
+                    anyOutOfRange |= outOfRange<Target>(data[first + i]);
+                    const auto converted = static_cast<Target>(data[first + i]);
+                    std::memcpy(destination + i * sizeof(Target), &converted, sizeof(Target));
+                }
+                checkConverted(name, anyOutOfRange, false);
+            });
+    }
+    else
+    {
+        return createBlock(name, data, number_of_components, compression);
+    }
+}
+
+[[noreturn]] void throwNotApplicable(const std::string &name, const char *reason)
+{
+    throw std::invalid_argument("[tinyvtu::createBlock] the precision of array '" + name + "' " + reason);
+}
+}  // namespace
+
+bool reducesPrecision(const precision::Info &precision)
+{
+    return precision.significantBits != 0 || precision.relativeError != 0 ||
+           precision.narrowing != precision::Narrowing::None;
+}
+
+std::uint32_t keptMantissaBits(const precision::Info &precision, std::uint32_t mantissa_bits,
+                               std::uint32_t written_bits)
+{
+    if (precision.relativeError < 0)
+        throw std::invalid_argument("[tinyvtu::createBlock] the relative error must not be negative");
+
+    std::uint32_t kept = mantissa_bits;
+    if (precision.significantBits != 0) kept = std::min(kept, precision.significantBits - 1);
+    if (precision.relativeError > 0)
+    {
+        // Rounding to nearest with k explicit bits has a relative error of at most 2^-(k+1)
+        std::uint32_t bound = 0;
+        while (bound < mantissa_bits && std::ldexp(1., -static_cast<int>(bound + 1)) > precision.relativeError)
+            ++bound;
+        // All bits of the data meet any bound, the bits of a narrower type may not
+        if (bound > written_bits && written_bits < mantissa_bits)
+            throw std::invalid_argument("[tinyvtu::createBlock] the relative error cannot be met by the narrowed type");
+        kept = precision.significantBits != 0 ? std::max(kept, bound) : bound;
+    }
+    return std::min(kept, written_bits);
+}
+
+template <typename T>
+requires std::is_arithmetic_v<T>
+DataBlock createBlock(const std::string &name, std::span<const T> data, std::uint32_t number_of_components,
+                      const compression::Info &compression, const precision::Info &precision)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        switch (precision.narrowing)
+        {
+        case precision::Narrowing::None:
+            return createConvertedBlock<T>(name, data, number_of_components, compression, precision);
+        case precision::Narrowing::Float32:
+            if constexpr (std::is_same_v<T, double>)
+                return createConvertedBlock<float>(name, data, number_of_components, compression, precision);
+            else
+                return createConvertedBlock<T>(name, data, number_of_components, compression, precision);
+        case precision::Narrowing::Int32:
+        case precision::Narrowing::Int16:
+            break;
+        }
+        throwNotApplicable(name, "cannot narrow floating point data to integers");
+    }
+    else
+    {
+        if (precision.significantBits != 0 || precision.relativeError != 0)
+            throwNotApplicable(name, "cannot round integers, significant bits apply to floating point data");
+        switch (precision.narrowing)
+        {
+        case precision::Narrowing::None:
+            return createBlock(name, data, number_of_components, compression);
+        case precision::Narrowing::Int32:
+            return createConvertedBlock<std::int32_t>(name, data, number_of_components, compression, precision);
+        case precision::Narrowing::Int16:
+            return createConvertedBlock<std::int16_t>(name, data, number_of_components, compression, precision);
+        case precision::Narrowing::Float32:
+            break;
+        }
+        throwNotApplicable(name, "cannot narrow integers to floating point data");
+    }
+}
+
+template DataBlock createBlock<float>(const std::string &, std::span<const float>, std::uint32_t,
+                                      const compression::Info &, const precision::Info &);
+template DataBlock createBlock<double>(const std::string &, std::span<const double>, std::uint32_t,
+                                       const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::uint8_t>(const std::string &, std::span<const std::uint8_t>, std::uint32_t,
+                                             const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::int8_t>(const std::string &, std::span<const std::int8_t>, std::uint32_t,
+                                            const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::uint16_t>(const std::string &, std::span<const std::uint16_t>, std::uint32_t,
+                                              const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::int16_t>(const std::string &, std::span<const std::int16_t>, std::uint32_t,
+                                             const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::uint32_t>(const std::string &, std::span<const std::uint32_t>, std::uint32_t,
+                                              const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::int32_t>(const std::string &, std::span<const std::int32_t>, std::uint32_t,
+                                             const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::uint64_t>(const std::string &, std::span<const std::uint64_t>, std::uint32_t,
+                                              const compression::Info &, const precision::Info &);
+template DataBlock createBlock<std::int64_t>(const std::string &, std::span<const std::int64_t>, std::uint32_t,
+                                             const compression::Info &, const precision::Info &);
+}  // namespace tinyvtu::internal
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "internal/DataBlock.hpp"
+#include "tinyvtu.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * Returns whether the precision settings change the data, otherwise it is passed to createBlock as is.
+ *
+ * @param precision  The precision settings
+ * @return           True if values are rounded or the type is narrowed
+ */
+bool reducesPrecision(const precision::Info &precision);
+
+/**
+ * Returns the number of explicit mantissa bits kept by the precision settings.
+ *
+ * The bits are counted in the written type, so a relative error bound has to be met by its mantissa.
+ *
+ * @param precision      The precision settings
+ * @param mantissa_bits  The number of explicit mantissa bits of the type of the data, e.g. 52 for double
+ * @param written_bits   The number of explicit mantissa bits of the written type, e.g. 23 if narrowed to float
+ * @return               The number of mantissa bits to keep, at most written_bits
+ * @throws std::invalid_argument if the relative error is negative or needs more bits than the written type has
+ */
+std::uint32_t keptMantissaBits(const precision::Info &precision, std::uint32_t mantissa_bits,
+                               std::uint32_t written_bits);
+
+/**
+ * Creates a DataBlock from data written with reduced precision.
+ *
+ * The mantissas are rounded and the type is narrowed block by block while the array is compressed, like generated
+ * data, so the converted array is only held as a whole if compression is inactive or deferred.
+ *
+ * @param name                  The name of the data block
+ * @param data                  The data to be stored in the data block
+ * @param number_of_components  The number of components per data entry
+ * @param compression           The compression information
+ * @param precision             The precision settings
+ * @return                      A DataBlock object containing the converted data
+ * @throws std::invalid_argument if the settings do not apply to the type, a value is out of the narrower range, or a
+ *         value, e.g. a denormal, does not meet the relative error bound in the written type
+ */
+template <typename T>
+requires std::is_arithmetic_v<T>
+DataBlock createBlock(const std::string &name, std::span<const T> data, std::uint32_t number_of_components,
+                      const compression::Info &compression, const precision::Info &precision);
+}  // namespace tinyvtu::internal
@@ -0,0 +1,607 @@
+#include "internal/Reader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "internal/Base64.hpp"
+#include "internal/Compressor.hpp"
+#include "internal/DataBlock.hpp"
+#include "internal/GridData.hpp"
+#include "internal/MappedFile.hpp"
+#include "internal/Parallel.hpp"
+
+namespace tinyvtu::internal {
+namespace {
+static_assert(static_cast<int>(DataType::Float32) == DataBlock::Float32 &&
+                  static_cast<int>(DataType::UInt64) == DataBlock::UInt64,
+              "DataType and DataBlock::Type must list the types in the same order");
+
+/**
+ * Uncompressed arrays are copied in parts of this size, so large arrays are copied by several threads.
+ */
+constexpr std::uint64_t CopySize = 1024 * 1024;
+
+/**
+ * The largest uncompressed block accepted in a compression header.
+ */
+constexpr std::uint64_t MaxBlockSize = std::numeric_limits<std::uint32_t>::max();
+
+[[noreturn]] void throwMalformed(const std::string &reason)
+{
+    throw std::runtime_error("[tinyvtu::read] " + reason);
+}
+
+/**
+ * An XML element of the header, the attribute values are unescaped.
+ */
+struct Element
+{
+    std::string_view name;
+    std::vector<std::pair<std::string_view, std::string>> attributes;
+    bool closing = false;      // </name>
+    bool selfClosing = false;  // <name/>
+
+    [[nodiscard]] const std::string *attribute(std::string_view key) const
+    {
+        for (const auto &[attributeKey, value] : attributes)
+            if (attributeKey == key) return &value;
+        return nullptr;
+    }
+};
+
+std::string unescape(std::string_view text)
+{
+    constexpr std::array<std::pair<std::string_view, char>, 5> entities{
+        {{"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}, {"&quot;", '"'}, {"&apos;", '\''}}};
+    std::string result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '&')
+        {
+            const auto entity = std::ranges::find_if(
+                entities, [&](const auto &candidate) { return text.substr(i).starts_with(candidate.first); });
+            if (entity != entities.end())
+            {
+                result += entity->second;
+                i += entity->first.size() - 1;
+                continue;
+            }
+        }
+        result += text[i];
+    }
+    return result;
+}
+
+/**
+ * Splits the XML header into elements, skipping text, comments, and declarations.
+ */
+class ElementScanner
+{
+public:
+    explicit ElementScanner(std::string_view text) : text_(text) {}
+
+    std::optional<Element> next()
+    {
+        while (true)
+        {
+            const auto begin = text_.find('<', position_);
+            if (begin == std::string_view::npos) return std::nullopt;
+            const auto end = text_.find('>', begin);
+            if (end == std::string_view::npos) throwMalformed("unterminated XML element");
+            position_ = end + 1;
+
+            auto tag = text_.substr(begin + 1, end - begin - 1);
+            if (tag.starts_with('?') || tag.starts_with('!')) continue;
+            return parse(tag);
+        }
+    }
+
+    /**
+     * Returns the position after the last element, where the content of an element starts.
+     */
+    [[nodiscard]] std::size_t position() const { return position_; }
+
+private:
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    static Element parse(std::string_view tag)
+    {
+        Element element;
+        if (tag.starts_with('/'))
+        {
+            element.closing = true;
+            tag.remove_prefix(1);
+        }
+        if (tag.ends_with('/'))
+        {
+            element.selfClosing = true;
+            tag.remove_suffix(1);
+        }
+
+        const auto nameEnd = std::min(tag.size(), static_cast<std::size_t>(std::ranges::find_if(tag, isSpace) -
+                                                                            tag.begin()));
+        element.name = tag.substr(0, nameEnd);
+        for (auto position = nameEnd; position < tag.size();)
+        {
+            if (isSpace(tag[position]))
+            {
+                ++position;
+                continue;
+            }
+            const auto equals = tag.find('=', position);
+            if (equals == std::string_view::npos || equals + 1 >= tag.size()) throwMalformed("malformed attribute");
+            const auto quote = tag[equals + 1];
+            const auto valueEnd = tag.find(quote, equals + 2);
+            if ((quote != '"' && quote != '\'') || valueEnd == std::string_view::npos)
+                throwMalformed("malformed attribute");
+
+            auto key = tag.substr(position, equals - position);
+            while (!key.empty() && isSpace(key.back())) key.remove_suffix(1);
+            element.attributes.emplace_back(key, unescape(tag.substr(equals + 2, valueEnd - equals - 2)));
+            position = valueEnd + 1;
+        }
+        return element;
+    }
+
+    std::string_view text_;
+    std::size_t position_ = 0;
+};
+
+std::uint64_t parseNumber(const std::string *text, const char *what)
+{
+    std::uint64_t value = 0;
+    if (text == nullptr) throwMalformed(std::string("missing ") + what);
+    const auto [end, error] = std::from_chars(text->data(), text->data() + text->size(), value);
+    if (error != std::errc{} || end != text->data() + text->size()) throwMalformed(std::string("invalid ") + what);
+    return value;
+}
+
+/**
+ * Returns the number of points along each axis of an extent, given as the first and last index along each axis.
+ */
+std::array<std::uint64_t, 3> parseDimensions(const std::string *text)
+{
+    if (text == nullptr) throwMalformed("missing Extent");
+    std::array<std::int64_t, 6> extent{};
+    const auto *position = text->data();
+    const auto *end = text->data() + text->size();
+    for (auto &index : extent)
+    {
+        while (position != end && *position == ' ') ++position;
+        const auto [next, error] = std::from_chars(position, end, index);
+        if (error != std::errc{}) throwMalformed("invalid Extent");
+        position = next;
+    }
+    std::array<std::uint64_t, 3> dimensions{};
+    for (std::size_t axis = 0; axis < dimensions.size(); ++axis)
+    {
+        if (extent[2 * axis + 1] < extent[2 * axis]) throwMalformed("invalid Extent");
+        dimensions[axis] = static_cast<std::uint64_t>(extent[2 * axis + 1] - extent[2 * axis]) + 1;
+    }
+    return dimensions;
+}
+
+DataType parseType(const std::string *text)
+{
+    constexpr std::array<std::string_view, 10> TypeNames = {"Float32", "Float64", "Int8",  "UInt8",  "Int16",
+                                                            "UInt16",  "Int32",   "UInt32", "Int64", "UInt64"};
+    if (text == nullptr) throwMalformed("DataArray without type");
+    const auto type = std::ranges::find(TypeNames, *text);
+    if (type == TypeNames.end()) throwMalformed("unsupported DataArray type '" + *text + "'");
+    return static_cast<DataType>(type - TypeNames.begin());
+}
+
+std::uint64_t typeSize(DataType type)
+{
+    constexpr std::array<std::uint64_t, 10> Sizes = {4, 8, 1, 1, 2, 2, 4, 4, 8, 8};
+    return Sizes[static_cast<std::size_t>(type)];
+}
+
+/**
+ * An array declared in the header together with its position in the appended section.
+ *
+ * Point and cell data is located by its index, as the vectors holding it grow while the header is parsed.
+ */
+struct DeclaredArray
+{
+    std::vector<Array> *arrays;  // The point or cell data, nullptr for the points and cells
+    std::size_t index;
+    Array *array;  // The points or a cell array if arrays is nullptr
+    std::uint64_t offset;
+    std::string_view base64 = {};  // The encoded data from its start to the end of the text holding it, if base64
+
+    [[nodiscard]] Array &get() const { return arrays != nullptr ? (*arrays)[index] : *array; }
+};
+
+/**
+ * A part of an array which is decompressed or copied independently of the others.
+ */
+struct Task
+{
+    const std::uint8_t *source;
+    std::uint64_t size;
+    std::uint8_t *destination;
+    std::uint64_t capacity;
+    bool compressed;
+};
+
+/**
+ * Reads the fields of array headers, checking that they are within the file.
+ */
+class HeaderReader
+{
+public:
+    HeaderReader(std::span<const std::uint8_t> appended, HeaderType header_type)
+        : appended_(appended), field_(headerFieldSize(header_type))
+    {
+    }
+
+    [[nodiscard]] std::uint64_t field(std::uint64_t position) const
+    {
+        const auto bytes = range(position, field_);
+        if (field_ == sizeof(std::uint32_t))
+        {
+            std::uint32_t value;
+            std::memcpy(&value, bytes.data(), sizeof(value));
+            return value;
+        }
+        std::uint64_t value;
+        std::memcpy(&value, bytes.data(), sizeof(value));
+        return value;
+    }
+
+    [[nodiscard]] std::span<const std::uint8_t> range(std::uint64_t position, std::uint64_t size) const
+    {
+        if (position > appended_.size() || size > appended_.size() - position)
+            throwMalformed("array exceeds the end of the file");
+        return appended_.subspan(static_cast<std::size_t>(position), static_cast<std::size_t>(size));
+    }
+
+    [[nodiscard]] std::uint64_t fieldSize() const { return field_; }
+
+    [[nodiscard]] std::uint64_t size() const { return appended_.size(); }
+
+private:
+    std::span<const std::uint8_t> appended_;
+    std::uint64_t field_;
+};
+
+/**
+ * Decodes the header and data of a base64 encoded array into the layout of raw appended data.
+ *
+ * The header and the data of compressed arrays are separate streams, uncompressed arrays are a single stream.
+ */
+Data decodeArray(std::string_view text, HeaderType header_type, bool compressed)
+{
+    const auto field = headerFieldSize(header_type);
+    Data bytes;
+    auto decode = [&](std::uint64_t position, std::uint64_t size)
+    {
+        // The decoded data is smaller than its text, which bounds sizes read from the file
+        if (position > text.size() || size > text.size() - position || base64Size(size) > text.size() - position)
+            throwMalformed("array exceeds the end of the file");
+        // A prefix of a stream decodes to up to 2 bytes more than needed
+        const auto start = bytes.size();
+        const auto encoded =
+            text.substr(static_cast<std::size_t>(position), static_cast<std::size_t>(base64Size(size)));
+        if (!decodeBase64(encoded, bytes) || bytes.size() - start < size) throwMalformed("invalid base64 data");
+        bytes.resize(static_cast<std::size_t>(start + size));
+    };
+
+    // The first field holds [#bytes] or [#blocks]
+    decode(0, field);
+    const HeaderReader first(bytes, header_type);
+    const auto value = first.field(0);
+    bytes.clear();
+    if (!compressed)
+    {
+        decode(0, field + std::min<std::uint64_t>(value, text.size()));
+        return bytes;
+    }
+
+    const auto headerBytes = field * (3 + std::min<std::uint64_t>(value, text.size()));
+    decode(0, headerBytes);
+    const HeaderReader header(bytes, header_type);
+    std::uint64_t dataBytes = 0;
+    for (std::uint64_t i = 0; i < value; ++i) dataBytes += header.field(field * (3 + i));
+    decode(base64Size(headerBytes), dataBytes);
+    return bytes;
+}
+
+/**
+ * Allocates the array and splits its data into tasks, the data is read by the tasks afterward.
+ *
+ * The file is advised about the data it holds, it is nullptr if the data was decoded into memory.
+ */
+void planArray(const DeclaredArray &declared, const HeaderReader &header, bool compressed, const MappedFile *file,
+               std::vector<Task> &tasks)
+{
+    auto &array = declared.get();
+    const auto field = header.fieldSize();
+    if (!compressed)
+    {
+        // [#bytes][DATA]
+        const auto size = header.field(declared.offset);
+        const auto data = header.range(declared.offset + field, size);
+        if (file != nullptr) file->willNeed(data);
+        array.bytes.resize(static_cast<std::size_t>(size));
+        for (std::uint64_t part = 0; part < size; part += CopySize)
+        {
+            const auto partSize = std::min(CopySize, size - part);
+            tasks.push_back({data.data() + part, partSize, array.bytes.data() + part, partSize, false});
+        }
+    }
+    else
+    {
+        // [#blocks][#u-size][#p-size][#c-size-1]...[#c-size-#blocks][DATA]
+        const auto blockCount = header.field(declared.offset);
+        const auto blockSize = header.field(declared.offset + field);
+        const auto partialSize = header.field(declared.offset + 2 * field);
+        auto throwInvalid = [&] { throwMalformed("invalid compression header of array '" + array.name + "'"); };
+        // Every block takes a field of the header, which bounds the count before the header size is computed
+        if (blockCount > header.size() / field) throwMalformed("array exceeds the end of the file");
+        static_cast<void>(header.range(declared.offset, field * (3 + blockCount)));
+        // The compressors write blocks of at most 32 bit, which bounds the uncompressed size of crafted headers
+        if ((blockCount > 0 && blockSize == 0) || blockSize > MaxBlockSize || partialSize > blockSize)
+            throwInvalid();
+        if (blockCount > 0 && blockCount > std::numeric_limits<std::size_t>::max() / blockSize) throwInvalid();
+        // The last block is partial unless [#p-size] is 0
+        const auto size =
+            blockCount == 0 ? 0 : (blockCount - 1) * blockSize + (partialSize != 0 ? partialSize : blockSize);
+        array.bytes.resize(static_cast<std::size_t>(size));
+
+        auto position = declared.offset + field * (3 + blockCount);
+        const auto dataBegin = position;
+        for (std::uint64_t i = 0; i < blockCount; ++i)
+        {
+            const auto compressedSize = header.field(declared.offset + field * (3 + i));
+            const auto block = header.range(position, compressedSize);
+            const auto capacity = i + 1 == blockCount ? size - i * blockSize : blockSize;
+            if (i * blockSize + capacity > size) throwInvalid();
+            tasks.push_back({block.data(), compressedSize, array.bytes.data() + i * blockSize, capacity, true});
+            position += compressedSize;
+        }
+        if (file != nullptr) file->willNeed(header.range(dataBegin, position - dataBegin));
+    }
+
+    if (array.bytes.size() % (typeSize(array.type) * std::max(array.numberOfComponents, 1u)) != 0)
+        throwMalformed("size of array '" + array.name + "' does not match its type and number of components");
+}
+}  // namespace
+
+Dataset readDataset(const std::filesystem::path &file_path, const reading::Info &reading)
+{
+    const MappedFile file(file_path);
+    const auto contents = file.data();
+    const std::string_view text(reinterpret_cast<const char *>(contents.data()), contents.size());
+
+    // The header ends with the AppendedData element, the data follows the '_' marker. Files whose arrays hold their
+    // data inline have no AppendedData element and are scanned as a whole.
+    const auto appendedTag = text.find("<AppendedData");
+    const auto appendedTagEnd = appendedTag == std::string_view::npos ? appendedTag : text.find('>', appendedTag);
+    const auto marker = appendedTagEnd == std::string_view::npos ? appendedTagEnd : text.find('_', appendedTagEnd);
+    if (appendedTag != std::string_view::npos && marker == std::string_view::npos)
+        throwMalformed("missing start of the appended data");
+    const auto appended =
+        appendedTag == std::string_view::npos ? std::span<const std::uint8_t>() : contents.subspan(marker + 1);
+    const auto xmlHeader = appendedTag == std::string_view::npos ? text : text.substr(0, appendedTagEnd + 1);
+    bool base64Appended = false;
+
+    Dataset dataset;
+    bool vtkFile = false;
+    bool structured = false;
+    bool polyData = false;
+    std::size_t coordinates = 0;
+    std::optional<compression::Codec> codec;
+    HeaderType header_type = HeaderType::UInt32;
+    std::uint32_t pieces = 0;
+    std::vector<std::string_view> sections;
+    std::vector<DeclaredArray> declared;
+
+    auto selected = [&](const std::string &name)
+    { return reading.arrays.empty() || std::ranges::find(reading.arrays, name) != reading.arrays.end(); };
+
+    ElementScanner scanner(xmlHeader);
+    while (auto element = scanner.next())
+    {
+        if (element->closing)
+        {
+            if (!sections.empty()) sections.pop_back();
+            continue;
+        }
+
+        if (element->name == "VTKFile")
+        {
+            vtkFile = true;
+            const auto *type = element->attribute("type");
+            constexpr std::array<std::string_view, 3> StructuredTypes{"ImageData", "RectilinearGrid", "StructuredGrid"};
+            structured = type != nullptr && std::ranges::find(StructuredTypes, *type) != StructuredTypes.end();
+            polyData = type != nullptr && *type == "PolyData";
+            if (!structured && !polyData && (type == nullptr || *type != "UnstructuredGrid"))
+                throwMalformed("unsupported grid type");
+            const auto *byteOrder = element->attribute("byte_order");
+            const auto *nativeOrder = std::endian::native == std::endian::little ? "LittleEndian" : "BigEndian";
+            if (byteOrder != nullptr && *byteOrder != nativeOrder)
+                throwMalformed("the byte order of the file differs from the machine");
+            if (const auto *headerType = element->attribute("header_type"))
+            {
+                if (*headerType == "UInt64")
+                    header_type = HeaderType::UInt64;
+                else if (*headerType != "UInt32")
+                    throwMalformed("unsupported header type '" + *headerType + "'");
+            }
+            if (const auto *compressor = element->attribute("compressor"))
+            {
+                if (*compressor == "vtkZLibDataCompressor")
+                    codec = compression::Codec::ZLib;
+                else if (*compressor == "vtkLZ4DataCompressor")
+                    codec = compression::Codec::LZ4;
+                else if (*compressor == "vtkLZMADataCompressor")
+                    codec = compression::Codec::LZMA;
+                else
+                    throwMalformed("unsupported compressor '" + *compressor + "'");
+            }
+        }
+        else if (element->name == "AppendedData")
+        {
+            const auto *encoding = element->attribute("encoding");
+            if (encoding == nullptr || (*encoding != "raw" && *encoding != "base64"))
+                throwMalformed("only raw and base64 appended data is supported");
+            base64Appended = *encoding == "base64";
+        }
+        else if (element->name == "Piece")
+        {
+            if (++pieces > 1) throwMalformed("only files with a single piece are supported");
+            if (structured)
+            {
+                // The points and cells of structured grids follow from the extent of the piece
+                dataset.dimensions = parseDimensions(element->attribute("Extent"));
+                const auto &[nx, ny, nz] = dataset.dimensions;
+                dataset.numberOfPoints = nx * ny * nz;
+                dataset.numberOfCells = structuredCellCount(dataset.dimensions);
+            }
+            else if (polyData)
+            {
+                // The cells of all sections are numbered together, missing sections have no cells
+                dataset.numberOfPoints = parseNumber(element->attribute("NumberOfPoints"), "NumberOfPoints");
+                for (const auto *section : {"NumberOfVerts", "NumberOfLines", "NumberOfStrips", "NumberOfPolys"})
+                    if (const auto *count = element->attribute(section))
+                        dataset.numberOfCells += parseNumber(count, section);
+            }
+            else
+            {
+                dataset.numberOfPoints = parseNumber(element->attribute("NumberOfPoints"), "NumberOfPoints");
+                dataset.numberOfCells = parseNumber(element->attribute("NumberOfCells"), "NumberOfCells");
+            }
+        }
+        else if (element->name == "DataArray")
+        {
+            const auto *format = element->attribute("format");
+            if (format == nullptr || (*format != "appended" && *format != "binary"))
+                throwMalformed("only appended and binary DataArrays are supported");
+            const bool inline_data = *format == "binary";
+            if (!inline_data && appendedTag == std::string_view::npos)
+                throwMalformed("appended DataArray without AppendedData");
+            const auto section = sections.empty() ? std::string_view() : sections.back();
+            const auto *nameAttribute = element->attribute("Name");
+            const auto name = nameAttribute != nullptr ? *nameAttribute : std::string();
+
+            DeclaredArray array{nullptr, 0, nullptr, 0};
+            if (section == "Points" && reading.topology)
+                array.array = &dataset.points;
+            else if (section == "Coordinates" && reading.topology)
+            {
+                if (coordinates == dataset.coordinates.size()) throwMalformed("more than three coordinate arrays");
+                array.array = &dataset.coordinates[coordinates++];
+            }
+            else if (section == "Cells" && reading.topology)
+            {
+                if (name == "connectivity")
+                    array.array = &dataset.connectivity;
+                else if (name == "offsets")
+                    array.array = &dataset.offsets;
+                else if (name == "types")
+                    array.array = &dataset.types;
+            }
+            else if ((section == "Verts" || section == "Lines" || section == "Polys") && reading.topology)
+            {
+                auto &cells = section == "Verts" ? dataset.verts : section == "Lines" ? dataset.lines : dataset.polys;
+                if (name == "connectivity")
+                    array.array = &cells.connectivity;
+                else if (name == "offsets")
+                    array.array = &cells.offsets;
+            }
+            else if ((section == "PointData" || section == "CellData") && selected(name))
+            {
+                array.arrays = section == "PointData" ? &dataset.pointData : &dataset.cellData;
+                array.index = array.arrays->size();
+                array.arrays->emplace_back();
+            }
+
+            if (array.array != nullptr || array.arrays != nullptr)
+            {
+                auto &target = array.get();
+                target.name = name;
+                target.type = parseType(element->attribute("type"));
+                const auto *components = element->attribute("NumberOfComponents");
+                target.numberOfComponents =
+                    components != nullptr ? static_cast<std::uint32_t>(parseNumber(components, "NumberOfComponents"))
+                                          : 1;
+                if (inline_data)
+                {
+                    // The content of the element up to the next element, without surrounding whitespace
+                    const auto begin = text.find_first_not_of(" \t\r\n", scanner.position());
+                    const auto end = text.find('<', scanner.position());
+                    if (element->selfClosing || begin == std::string_view::npos || end == std::string_view::npos ||
+                        begin >= end)
+                        throwMalformed("binary DataArray without data");
+                    array.base64 = text.substr(begin, end - begin);
+                    while (std::string_view(" \t\r\n").find(array.base64.back()) != std::string_view::npos)
+                        array.base64.remove_suffix(1);
+                }
+                else
+                {
+                    array.offset = parseNumber(element->attribute("offset"), "offset");
+                }
+                declared.push_back(array);
+            }
+        }
+        if (!element->selfClosing) sections.push_back(element->name);
+    }
+    if (!vtkFile) throwMalformed("missing VTKFile element");
+    if (pieces == 0) throwMalformed("missing Piece element");
+
+    // The encoding of the appended data is known once its element, which follows the arrays, was parsed
+    for (auto &array : declared)
+    {
+        if (!base64Appended || !array.base64.empty()) continue;
+        if (array.offset >= appended.size()) throwMalformed("array exceeds the end of the file");
+        array.base64 = text.substr(static_cast<std::size_t>(marker + 1 + array.offset));
+    }
+
+    // Base64 arrays are decoded in parallel into the layout of raw appended data, which is kept until the tasks ran
+    std::vector<Data> decoded(declared.size());
+    parallelFor(declared.size(), reading.threads,
+                [&](const std::size_t i)
+                {
+                    if (!declared[i].base64.empty())
+                        decoded[i] = decodeArray(declared[i].base64, header_type, codec.has_value());
+                });
+
+    const HeaderReader header(appended, header_type);
+    std::vector<Task> tasks;
+    for (std::size_t i = 0; i < declared.size(); ++i)
+    {
+        if (declared[i].base64.empty())
+        {
+            planArray(declared[i], header, codec.has_value(), &file, tasks);
+            continue;
+        }
+        auto array = declared[i];
+        array.offset = 0;
+        planArray(array, HeaderReader(decoded[i], header_type), codec.has_value(), nullptr, tasks);
+    }
+
+    parallelFor(tasks.size(), reading.threads,
+                [&](const std::size_t i)
+                {
+                    const auto &task = tasks[i];
+                    if (task.compressed)
+                        decompressBlock(*codec, task.source, task.size, task.destination, task.capacity);
+                    else
+                        std::memcpy(task.destination, task.source, static_cast<std::size_t>(task.size));
+                });
+    return dataset;
+}
+}  // namespace tinyvtu::internal
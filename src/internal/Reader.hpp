@@ -0,0 +1,17 @@
+#pragma once
+#include <filesystem>
+
+#include "tinyvtu.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * Reads a grid file whose arrays are appended raw or in base64, or held inline in base64.
+ *
+ * @param file_path The file path of the grid
+ * @param reading   The selected arrays and the number of threads
+ * @return          The points, cells, and selected arrays of the grid
+ * @throws std::runtime_error if the file cannot be read, is malformed, or uses an unsupported format
+ * @see tinyvtu::read
+ */
+Dataset readDataset(const std::filesystem::path &file_path, const reading::Info &reading);
+}  // namespace tinyvtu::internal
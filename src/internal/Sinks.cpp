@@ -0,0 +1,117 @@
+#include "internal/Sinks.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __has_include(<sys/uio.h>)
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define TINYVTU_HAS_WRITEV 1
+#else
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#define TINYVTU_HAS_WRITEV 0
+#endif
+
+namespace {
+/**
+ * Writes all chunks to the file descriptor, with as few gathered writes as the system allows.
+ */
+void writeChunks(int file_descriptor, std::span<const std::span<const std::uint8_t> > chunks)
+{
+#if TINYVTU_HAS_WRITEV
+    constexpr std::size_t MaxVectors = IOV_MAX;
+    std::vector<iovec> vectors;
+    vectors.reserve(std::min(chunks.size(), MaxVectors));
+
+    std::size_t index = 0;
+    std::size_t done = 0;  // Bytes of chunks[index] already written
+    while (index < chunks.size())
+    {
+        vectors.clear();
+        for (auto i = index, skip = done; i < chunks.size() && vectors.size() < MaxVectors; ++i, skip = 0)
+            vectors.push_back({const_cast<std::uint8_t *>(chunks[i].data() + skip), chunks[i].size() - skip});
+
+        const auto written = ::writev(file_descriptor, vectors.data(), static_cast<int>(vectors.size()));
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("[Sink::write] could not write to file descriptor");
+        }
+
+        // A partial write continues within the chunk it stopped at
+        for (auto remaining = static_cast<std::size_t>(written); index < chunks.size();)
+        {
+            const auto left = chunks[index].size() - done;
+            if (remaining < left)
+            {
+                done += remaining;
+                break;
+            }
+            remaining -= left;
+            ++index;
+            done = 0;
+        }
+    }
+#else
+    for (auto chunk : chunks)
+    {
+        while (!chunk.empty())
+        {
+            const auto size =
+                static_cast<unsigned>(std::min<std::size_t>(chunk.size(), std::numeric_limits<int>::max()));
+            const auto written = ::_write(file_descriptor, chunk.data(), size);
+            if (written < 0) throw std::runtime_error("[Sink::write] could not write to file descriptor");
+            chunk = chunk.subspan(static_cast<std::size_t>(written));
+        }
+    }
+#endif
+}
+}  // namespace
+
+namespace tinyvtu {
+FileDescriptorSink::FileDescriptorSink(int fileDescriptor) : file_descriptor_(fileDescriptor) {}
+
+void FileDescriptorSink::write(std::span<const std::span<const std::uint8_t> > chunks)
+{
+    writeChunks(file_descriptor_, chunks);
+}
+}  // namespace tinyvtu
+
+namespace tinyvtu::internal {
+FileSink::FileSink(const std::filesystem::path &file_path)
+#if TINYVTU_HAS_WRITEV
+    : file_descriptor_(::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666))
+#else
+    : file_descriptor_(
+          ::_wopen(file_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE))
+#endif
+{
+    if (file_descriptor_ < 0)
+        throw std::runtime_error(std::string("[Writer::Writer] could not open file '") + file_path.string() + "'");
+}
+
+FileSink::~FileSink()
+{
+#if TINYVTU_HAS_WRITEV
+    ::close(file_descriptor_);
+#else
+    ::_close(file_descriptor_);
+#endif
+}
+
+void FileSink::write(std::span<const std::span<const std::uint8_t> > chunks) { writeChunks(file_descriptor_, chunks); }
+
+void StreamSink::write(std::span<const std::span<const std::uint8_t> > chunks)
+{
+    for (const auto &chunk : chunks)
+        stream_.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+    if (!stream_) throw std::runtime_error("[Sink::write] could not write to stream");
+}
+}  // namespace tinyvtu::internal
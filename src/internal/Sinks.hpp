@@ -0,0 +1,47 @@
+#pragma once
+#include <filesystem>
+#include <ostream>
+
+#include "tinyvtu.hpp"
+
+namespace tinyvtu::internal {
+/**
+ * Writes the output to a file it creates and owns.
+ */
+class FileSink final : public Sink
+{
+public:
+    /**
+     * Creates or truncates the file.
+     *
+     * @param file_path The path of the file
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit FileSink(const std::filesystem::path &file_path);
+
+    ~FileSink() override;
+
+    FileSink(const FileSink &) = delete;
+
+    FileSink &operator=(const FileSink &) = delete;
+
+    void write(std::span<const std::span<const std::uint8_t> > chunks) override;
+
+private:
+    int file_descriptor_;
+};
+
+/**
+ * Writes the output to a std::ostream, which must outlive the sink.
+ */
+class StreamSink final : public Sink
+{
+public:
+    explicit StreamSink(std::ostream &stream) : stream_(stream) {}
+
+    void write(std::span<const std::span<const std::uint8_t> > chunks) override;
+
+private:
+    std::ostream &stream_;
+};
+}  // namespace tinyvtu::internal
@@ -0,0 +1,97 @@
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "tinyvtu.hpp"
+
+namespace {
+/**
+ * Writes a string as a JSON string literal.
+ */
+void writeString(std::ostream &stream, std::string_view text)
+{
+    constexpr char Hex[] = "0123456789abcdef";
+    stream << '"';
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            stream << "\\u00" << Hex[(c >> 4) & 0xf] << Hex[c & 0xf];
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+
+/**
+ * Writes a time given in seconds as microseconds with nanosecond digits, independent of the stream's formatting.
+ */
+void writeMicroseconds(std::ostream &stream, double seconds)
+{
+    std::array<char, 32> buffer{};
+    const auto end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), seconds * 1e6,
+                                   std::chars_format::fixed, 3).ptr;
+    stream.write(buffer.data(), end - buffer.data());
+}
+
+/**
+ * The threads of the trace, compression and I/O are shown as separate tracks.
+ */
+enum Track
+{
+    Compression = 1,
+    IO = 2,
+};
+
+/**
+ * Writes a complete event ("ph": "X") of the track, the arguments of the array are attached if it is given.
+ */
+void writeEvent(std::ostream &stream, std::string_view name, Track track, double start, double seconds,
+                const tinyvtu::statistics::Array *array)
+{
+    stream << ",\n{\"name\":";
+    writeString(stream, name);
+    stream << ",\"cat\":\"" << (track == Compression ? "compression" : "io") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+           << static_cast<int>(track) << ",\"ts\":";
+    writeMicroseconds(stream, start);
+    stream << ",\"dur\":";
+    writeMicroseconds(stream, seconds);
+    if (array != nullptr)
+        stream << ",\"args\":{\"rawBytes\":" << array->rawBytes << ",\"compressedBytes\":" << array->compressedBytes
+               << ",\"blocks\":" << array->blocks << "}";
+    stream << "}";
+}
+}  // namespace
+
+namespace tinyvtu::statistics {
+void Info::writeTrace(std::ostream &stream) const
+{
+    // Chrome's JSON trace event format, the metadata events name the tracks
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+           << R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"compression"}},)" << "\n"
+           << R"({"name":"thread_name","ph":"M","pid":1,"tid":2,"args":{"name":"io"}})";
+    writeEvent(stream, "write", IO, writeStart, writeSeconds, nullptr);
+    for (const auto &array : arrays)
+    {
+        writeEvent(stream, "compress " + array.name, Compression, array.compressionStart, array.compressionSeconds,
+                   &array);
+        writeEvent(stream, "write " + array.name, IO, array.ioStart, array.ioSeconds, &array);
+    }
+    stream << "\n]}\n";
+}
+
+void Info::writeTrace(const std::filesystem::path &file_path) const
+{
+    std::ofstream stream(file_path);
+    if (!stream)
+        throw std::runtime_error("[statistics::Info::writeTrace] could not open file '" + file_path.string() + "'");
+    writeTrace(stream);
+    if (!stream.flush())
+        throw std::runtime_error("[statistics::Info::writeTrace] could not write file '" + file_path.string() + "'");
+}
+}  // namespace tinyvtu::statistics
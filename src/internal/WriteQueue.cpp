@@ -0,0 +1,69 @@
+#include "internal/WriteQueue.hpp"
+
+#include <algorithm>
+
+#include "internal/Parallel.hpp"
+
+namespace tinyvtu::internal {
+WriteQueue::WriteQueue(std::uint32_t max_in_flight, std::uint32_t threads)
+    : max_in_flight_(std::max<std::uint32_t>(max_in_flight, 1))
+{
+    const auto workerCount = resolveThreads(threads);
+    workers_.reserve(workerCount);
+    for (std::uint32_t i = 0; i < workerCount; ++i) workers_.emplace_back(&WriteQueue::run, this);
+}
+
+WriteQueue::~WriteQueue()
+{
+    {
+        const std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all();
+    for (auto &worker : workers_) worker.join();
+}
+
+std::future<void> WriteQueue::submit(std::packaged_task<void()> &&task)
+{
+    auto future = task.get_future();
+    {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this] { return in_flight_ < max_in_flight_; });
+        ++in_flight_;
+        tasks_.push_back(std::move(task));
+    }
+    changed_.notify_all();
+    return future;
+}
+
+void WriteQueue::wait()
+{
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void WriteQueue::run()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            // Pending tasks are finished before stopping, their futures would be broken otherwise
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        // A packaged_task stores exceptions in its future, hence it does not throw
+        task();
+
+        {
+            const std::scoped_lock lock(mutex_);
+            --in_flight_;
+        }
+        changed_.notify_all();
+    }
+}
+}  // namespace tinyvtu::internal
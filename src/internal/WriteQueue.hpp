@@ -0,0 +1,64 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tinyvtu::internal {
+/**
+ * @class WriteQueue
+ * @brief Runs write tasks on background threads with a bound on the tasks in flight.
+ *
+ * A task is in flight from its submission until it has finished. If the bound is reached, submit() blocks until a task
+ * has finished, which bounds the memory held by grids waiting to be written. With a bound of 2, the next grid can be
+ * prepared while the previous one is written, i.e. output is double-buffered.
+ */
+class WriteQueue final
+{
+public:
+    /**
+     * Starts the worker threads.
+     *
+     * @param max_in_flight The maximal number of submitted but unfinished tasks, at least 1
+     * @param threads The number of worker threads, 0 selects the number of hardware threads
+     */
+    WriteQueue(std::uint32_t max_in_flight, std::uint32_t threads);
+
+    /**
+     * Runs all submitted tasks to completion and stops the worker threads.
+     */
+    ~WriteQueue();
+
+    WriteQueue(const WriteQueue &) = delete;
+
+    WriteQueue &operator=(const WriteQueue &) = delete;
+
+    /**
+     * Submits a task, blocking while the maximal number of tasks is in flight.
+     *
+     * @param task The task, exceptions it throws are stored in the returned future
+     * @return A future which becomes ready once the task has finished
+     */
+    std::future<void> submit(std::packaged_task<void()> &&task);
+
+    /**
+     * Blocks until all submitted tasks have finished.
+     */
+    void wait();
+
+private:
+    void run();
+
+    const std::uint32_t max_in_flight_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::packaged_task<void()>> tasks_;
+    std::uint32_t in_flight_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+}  // namespace tinyvtu::internal
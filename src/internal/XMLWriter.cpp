@@ -1,68 +1,290 @@
 #include "XMLWriter.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <thread>
+
+#include "internal/Base64.hpp"
+#include "internal/Parallel.hpp"
+#include "internal/Sinks.hpp"
+
+namespace {
+// Data up to this size is copied into the buffer, which saves a chunk of the gathered write
+constexpr std::size_t CopyLimit = 4096;
+
+// Base64 is encoded in chunks of this many bytes, a multiple of 3, and the buffer is flushed once it holds a chunk
+constexpr std::size_t Base64Chunk = 3 * 1024 * 1024;
+
+// The least number of bytes a thread encodes, smaller chunks are not split
+constexpr std::size_t Base64ThreadBytes = 3 * 64 * 1024;
+}  // namespace
 
 namespace tinyvtu::internal {
-XMLWriter::XMLWriter(const std::filesystem::path &file_path) : file_(file_path, std::ios::binary)
+XMLWriter::XMLWriter(const std::filesystem::path &file_path)
+    : owned_sink_(std::make_unique<FileSink>(file_path)), sink_(owned_sink_.get())
 {
-    if (!file_.is_open())
-        throw std::runtime_error(std::string("[Writer::Writer] could not open file '") + file_path.string() + "'");
+    buffer_.reserve(16384);
+    segments_.reserve(64);
 }
 
-XMLWriter::~XMLWriter() { file_.close(); }
+XMLWriter::XMLWriter(std::ostream &stream)
+    : owned_sink_(std::make_unique<StreamSink>(stream)), sink_(owned_sink_.get())
+{
+    buffer_.reserve(16384);
+}
+
+XMLWriter::XMLWriter(Sink &sink) : sink_(&sink)
+{
+    buffer_.reserve(16384);
+    segments_.reserve(64);
+}
+
+XMLWriter::~XMLWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+    }
+}
 
 void XMLWriter::openXMLElement(const std::string &name, const std::vector<Attribute> &attributes)
 {
-    file_ << indent() << "<" << name;
-    for (const auto &[name, attribute] : attributes) file_ << " " << name << "=\"" << attribute << "\"";
-    file_ << ">\n";
+    appendIndent();
+    append("<");
+    append(name);
+    for (const auto &[name, attribute] : attributes) appendAttribute(name, attribute);
+    append(">\n");
 
-    elements_.push(name);
+    element_starts_.push_back(element_names_.size());
+    element_names_.append(name);
 }
 
 void XMLWriter::endXMLElement()
 {
-    const auto name = elements_.top();
-    elements_.pop();
+    const auto start = element_starts_.back();
+    element_starts_.pop_back();
 
-    file_ << indent() << "</" << name << ">\n";
+    appendIndent();
+    append("</");
+    append(std::string_view(element_names_).substr(start));
+    append(">\n");
+    element_names_.resize(start);
 }
 
 void XMLWriter::inlineXMLElement(const std::string &name, const std::vector<Attribute> &attributes)
 {
-    file_ << indent() << "<" << name;
-    for (const auto &[name, attribute] : attributes) file_ << " " << name << "=\"" << attribute << "\"";
-    file_ << "/>\n";
+    appendIndent();
+    append("<");
+    append(name);
+    for (const auto &[name, attribute] : attributes) appendAttribute(name, attribute);
+    append("/>\n");
 }
 
 void XMLWriter::writeContent(const std::string &content, bool useIndent, bool addNewline)
 {
-    if (useIndent) file_ << indent();
-    file_ << content;
-    if (addNewline) file_ << "\n";
+    if (useIndent) appendIndent();
+    append(content);
+    if (addNewline) append("\n");
+}
+
+void XMLWriter::writeData(std::span<const std::uint8_t> content)
+{
+    if (content.empty()) return;
+    if (content.size() <= CopyLimit)
+    {
+        append(std::string_view(reinterpret_cast<const char *>(content.data()), content.size()));
+        return;
+    }
+    segments_.push_back({content.data(), 0, content.size()});
+}
+
+void XMLWriter::limitBandwidth(std::uint64_t bytes_per_second) { bandwidth_ = bytes_per_second; }
+
+void XMLWriter::flush()
+{
+    writeSegments();
+    buffer_.clear();
+    segments_.clear();
+}
+
+void XMLWriter::writeDataArrayElement(const DataBlock &dataBlock, std::uint64_t offset)
+{
+    appendIndent();
+    append("<DataArray");
+    appendDataArrayAttributes(dataBlock);
+    appendAttribute("format", "appended");
+    append(" offset=\"");
+    append(offset);
+    append("\"/>\n");
+}
+
+void XMLWriter::openDataArrayElement(const DataBlock &dataBlock)
+{
+    appendIndent();
+    append("<DataArray");
+    appendDataArrayAttributes(dataBlock);
+    appendAttribute("format", "binary");
+    append(">\n");
+
+    element_starts_.push_back(element_names_.size());
+    element_names_.append("DataArray");
 }
 
-void XMLWriter::writeData(const Data &content)
+void XMLWriter::writeBase64(std::span<const std::span<const std::uint8_t> > parts, std::uint32_t threads)
 {
-    file_.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    // A group of 3 bytes spanning two parts is completed from the next part before it is encoded
+    std::array<std::uint8_t, 3> group{};
+    std::size_t grouped = 0;
+    for (auto part : parts)
+    {
+        for (; grouped != 0 && grouped < group.size() && !part.empty(); part = part.subspan(1))
+            group[grouped++] = part.front();
+        if (grouped == group.size())
+        {
+            appendBase64(group, threads);
+            grouped = 0;
+        }
+        if (grouped != 0) continue;
+
+        const auto whole = part.size() / 3 * 3;
+        for (std::size_t begin = 0; begin < whole; begin += Base64Chunk)
+            appendBase64(part.subspan(begin, std::min(Base64Chunk, whole - begin)), threads);
+        grouped = part.size() - whole;
+        std::ranges::copy(part.subspan(whole), group.begin());
+    }
+    if (grouped != 0) appendBase64(std::span(group).first(grouped), threads);
 }
 
-void XMLWriter::writeDataArrayElement(const DataBlock &dataBlock, std::uint32_t offset)
+void XMLWriter::writePDataArrayElement(const DataBlock &dataBlock)
+{
+    appendIndent();
+    append("<PDataArray");
+    appendDataArrayAttributes(dataBlock);
+    append("/>\n");
+}
+
+void XMLWriter::appendDataArrayAttributes(const DataBlock &dataBlock)
 {
     constexpr char TypeToName[][10] = {"Float32", "Float64", "Int8",   "UInt8", "Int16",
                                        "UInt16",  "Int32",   "UInt32", "Int64", "UInt64"};
 
-    auto attributes = std::vector<Attribute>();
-    if (!dataBlock.name.empty()) attributes.emplace_back(Attribute{"Name", dataBlock.name});
+    if (!dataBlock.name.empty()) appendAttribute("Name", dataBlock.name);
     if (dataBlock.number_of_components != 0)
-        attributes.emplace_back(Attribute{"NumberOfComponents", std::to_string(dataBlock.number_of_components)});
-    attributes.emplace_back(Attribute{"type", TypeToName[dataBlock.type]});
-    attributes.emplace_back(Attribute{"format", "appended"});
-    attributes.emplace_back(Attribute{"offset", std::to_string(offset)});
+    {
+        append(" NumberOfComponents=\"");
+        append(dataBlock.number_of_components);
+        append("\"");
+    }
+    appendAttribute("type", TypeToName[dataBlock.type]);
+}
 
-    inlineXMLElement("DataArray", attributes);
+void XMLWriter::append(std::string_view text)
+{
+    if (text.empty()) return;
+    // Consecutive text extends the last range of the buffer
+    if (segments_.empty() || segments_.back().data != nullptr)
+        segments_.push_back({nullptr, buffer_.size(), 0});
+    buffer_.append(text);
+    segments_.back().size += text.size();
+}
+
+void XMLWriter::append(std::uint64_t value)
+{
+    char digits[std::numeric_limits<std::uint64_t>::digits10 + 1];
+    const auto end = std::to_chars(std::begin(digits), std::end(digits), value).ptr;
+    append(std::string_view(digits, static_cast<std::size_t>(end - digits)));
+}
+
+void XMLWriter::appendAttribute(std::string_view name, std::string_view value)
+{
+    append(" ");
+    append(name);
+    append("=\"");
+    append(value);
+    append("\"");
 }
 
-std::string XMLWriter::indent() const { return std::string(elements_.size() * 2, ' '); }
+void XMLWriter::appendBase64(std::span<const std::uint8_t> bytes, std::uint32_t threads)
+{
+    if (bytes.empty()) return;
+    if (segments_.empty() || segments_.back().data != nullptr) segments_.push_back({nullptr, buffer_.size(), 0});
+    const auto offset = buffer_.size();
+    const auto size = static_cast<std::size_t>(base64Size(bytes.size()));
+    buffer_.resize(offset + size);
+    segments_.back().size += size;
+
+    // Groups of 3 bytes are encoded independently, hence the threads encode consecutive parts of the chunk
+    auto *destination = reinterpret_cast<std::uint8_t *>(buffer_.data()) + offset;
+    const auto tasks = std::max<std::size_t>(std::min<std::size_t>(resolveThreads(threads),
+                                                                   bytes.size() / Base64ThreadBytes), 1);
+    const auto taskBytes = (bytes.size() / tasks + 2) / 3 * 3;
+    parallelFor(tasks, threads,
+                [&](std::size_t task)
+                {
+                    const auto begin = std::min(task * taskBytes, bytes.size());
+                    const auto end = task + 1 == tasks ? bytes.size() : std::min(begin + taskBytes, bytes.size());
+                    encodeBase64(bytes.subspan(begin, end - begin), destination + begin / 3 * 4);
+                });
+
+    if (buffer_.size() >= Base64Chunk) flush();
+}
+
+void XMLWriter::appendIndent()
+{
+    static constexpr std::string_view Spaces = "                                                                ";
+    for (auto width = element_starts_.size() * 2; width > 0;)
+    {
+        const auto part = std::min(width, Spaces.size());
+        append(Spaces.substr(0, part));
+        width -= part;
+    }
+}
+
+void XMLWriter::writeSegments()
+{
+    // Without a bandwidth limit all segments are handed over at once, otherwise in chunks of a tenth of a second
+    const auto chunkSize =
+        bandwidth_ == 0 ? std::numeric_limits<std::uint64_t>::max() : std::max<std::uint64_t>(bandwidth_ / 10, 4096);
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t total = 0;
+
+    std::vector<std::span<const std::uint8_t> > chunks;
+    chunks.reserve(segments_.size());
+    for (std::size_t index = 0, done = 0; index < segments_.size();)
+    {
+        chunks.clear();
+        std::uint64_t batch = 0;
+        // done is the number of bytes of segments_[index] handed over by the previous batch
+        for (; index < segments_.size() && batch < chunkSize; ++index, done = 0)
+        {
+            const auto &[data, offset, size] = segments_[index];
+            const auto *begin =
+                data != nullptr ? data : reinterpret_cast<const std::uint8_t *>(buffer_.data()) + offset;
+            const auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size - done, chunkSize - batch));
+            chunks.emplace_back(begin + done, length);
+            batch += length;
+            if (done + length < size)
+            {
+                done += length;
+                break;
+            }
+        }
+        sink_->write(chunks);
+
+        total += batch;
+        if (bandwidth_ != 0)
+        {
+            const std::chrono::duration<double> due(static_cast<double>(total) / static_cast<double>(bandwidth_));
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::nanoseconds>(due));
+        }
+    }
+}
 }  // namespace tinyvtu::internal
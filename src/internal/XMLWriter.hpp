@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
-#include <fstream>
-#include <stack>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "internal/DataBlock.hpp"
@@ -18,6 +21,11 @@ namespace tinyvtu::internal {
  *
  * Typical usage includes creating an instance of XMLWriter, adding elements,
  * setting attributes, and finally generating the XML string.
+ *
+ * Nothing is written until flush() is called or the writer is destroyed. XML content is rendered into one buffer, and
+ * binary data is only referenced. Flushing hands the buffer and all data to the sink as one list of chunks, a file is
+ * written with a single gathered write (writev). Hence, writing a file takes a constant number of system calls and
+ * allocations regardless of the number of arrays.
  */
 class XMLWriter final
 {
@@ -59,16 +67,36 @@ public:
      */
     explicit XMLWriter(const std::filesystem::path &file_path);
 
+    /**
+     * @brief Constructs an XMLWriter object writing to the given stream.
+     *
+     * The stream is not owned by the XMLWriter and must outlive it. This allows to render XML content into memory,
+     * e.g. to place it into an already existing file.
+     *
+     * @param stream The stream to write to.
+     */
+    explicit XMLWriter(std::ostream &stream);
+
+    /**
+     * @brief Constructs an XMLWriter object writing to the given sink.
+     *
+     * The sink is not owned by the XMLWriter and must outlive it.
+     *
+     * @param sink The sink to write to.
+     */
+    explicit XMLWriter(Sink &sink);
+
+    /**
+     * @brief Flushes pending content and closes the file.
+     *
+     * Errors are swallowed, call flush() to observe them.
+     */
     ~XMLWriter();
 
     XMLWriter(const XMLWriter &) = delete;
 
-    XMLWriter(XMLWriter &&) noexcept = default;
-
     XMLWriter &operator=(const XMLWriter &) = delete;
 
-    XMLWriter &operator=(XMLWriter &&) noexcept = default;
-
     /**
      * @brief Opens an XML element and writes it to the file with given attributes.
      *
@@ -119,12 +147,36 @@ public:
     /**
      * @brief Writes binary data to the file.
      *
-     * This method takes a Data object (vector of unsigned 8-bit integers) and writes its content
+     * This method takes a view of unsigned 8-bit integers, e.g. a Data object, and writes its content
      * to the associated file stream in binary format.
      *
+     * Small data is copied into the buffer. Larger data is referenced and must stay valid until the next flush().
+     *
      * @param content The binary data to be written to the file.
      */
-    void writeData(const Data &content);
+    void writeData(std::span<const std::uint8_t> content);
+
+    /**
+     * @brief Writes all pending content and data to the file or stream.
+     *
+     * @throws std::runtime_error if writing failed
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of bytes of rendered XML content and copied data waiting for the next flush().
+     */
+    [[nodiscard]] std::size_t bufferedBytes() const { return buffer_.size(); }
+
+    /**
+     * @brief Limits the rate binary data is written with.
+     *
+     * The output is handed to the file in chunks when flushing, and writing pauses whenever the average rate since the
+     * start of the flush would exceed the limit.
+     *
+     * @param bytes_per_second The maximal average rate, 0 disables the limit.
+     */
+    void limitBandwidth(std::uint64_t bytes_per_second);
 
     /**
      * @brief Writes a data block as an XML element with attributes.
@@ -136,12 +188,72 @@ public:
      * @param dataBlock The data block containing information about the data to be written.
      * @param offset The offset value to be used in the "offset" attribute of the XML element.
      */
-    void writeDataArrayElement(const DataBlock &dataBlock, std::uint32_t offset);
+    void writeDataArrayElement(const DataBlock &dataBlock, std::uint64_t offset);
+
+    /**
+     * @brief Opens a "DataArray" XML element whose content is the data of the block in base64.
+     *
+     * The element has the attributes of writeDataArrayElement except for the offset, its format is "binary". The data
+     * is written with writeBase64, endXMLElement closes the element.
+     *
+     * @param dataBlock The data block containing information about the data to be written.
+     */
+    void openDataArrayElement(const DataBlock &dataBlock);
+
+    /**
+     * @brief Writes binary data encoded in base64.
+     *
+     * The parts are encoded as one stream, which is padded at its end only. The characters are rendered into the
+     * buffer, large streams are encoded in chunks by up to threads threads and flushed in between.
+     *
+     * @param parts The binary data to be encoded.
+     * @param threads The maximal number of threads, 0 selects the number of hardware threads.
+     */
+    void writeBase64(std::span<const std::span<const std::uint8_t> > parts, std::uint32_t threads);
+
+    /**
+     * @brief Writes the declaration of a data block as a "PDataArray" XML element.
+     *
+     * The element is used by parallel files to declare the arrays every piece holds, it has the same attributes as the
+     * "DataArray" element except for the format and offset.
+     *
+     * @param dataBlock The data block to declare.
+     */
+    void writePDataArrayElement(const DataBlock &dataBlock);
 
 private:
-    [[nodiscard]] std::string indent() const;
+    /**
+     * A part of the output, either a range of the buffer or referenced data.
+     */
+    struct Segment
+    {
+        const std::uint8_t *data;  ///< The referenced data, nullptr for a range of the buffer
+        std::size_t offset;        ///< The start of the range in the buffer
+        std::size_t size;
+    };
+
+    void append(std::string_view text);
+
+    void append(std::uint64_t value);
+
+    void appendAttribute(std::string_view name, std::string_view value);
+
+    void appendIndent();
+
+    void appendDataArrayAttributes(const DataBlock &dataBlock);
+
+    void appendBase64(std::span<const std::uint8_t> bytes, std::uint32_t threads);
+
+    void writeSegments();
+
+    std::unique_ptr<Sink> owned_sink_;
+    Sink *sink_;
+
+    std::string buffer_;
+    std::vector<Segment> segments_;
+    std::string element_names_;
+    std::vector<std::size_t> element_starts_;
 
-    std::ofstream file_;
-    std::stack<std::string> elements_;
+    std::uint64_t bandwidth_ = 0;
 };
 }  // namespace tinyvtu::internal
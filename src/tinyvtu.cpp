@@ -1,118 +1,1052 @@
 #include "tinyvtu.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <ranges>
+#include <utility>
 
 #include "internal/GridData.hpp"
+#include "internal/GridStream.hpp"
+#include "internal/Interleave.hpp"
+#include "internal/Parallel.hpp"
+#include "internal/Reader.hpp"
+#include "internal/WriteQueue.hpp"
 
 namespace tinyvtu {
-UnstructuredGrid::UnstructuredGrid(std::unique_ptr<internal::GridData> &&gridData) : grid_data_(std::move(gridData)) {}
+GridBase::GridBase(std::unique_ptr<internal::GridData> &&gridData) : grid_data_(std::move(gridData)) {}
 
-UnstructuredGrid::~UnstructuredGrid() = default;
+GridBase::~GridBase() = default;
 
-template <class T>
-requires std::is_arithmetic_v<T>
-void UnstructuredGrid::addPointData(const std::string &name, const std::vector<T> &pointData,
-                                    std::uint32_t numberOfComponents)
-{
-    grid_data_->addData<false, T>(name, pointData, numberOfComponents);
-}
+GridBase::GridBase(GridBase &&) noexcept = default;
 
-template <class T>
+GridBase &GridBase::operator=(GridBase &&) noexcept = default;
+
+UnstructuredGrid::UnstructuredGrid(std::unique_ptr<internal::GridData> &&gridData) : GridBase(std::move(gridData)) {}
+
+ImageData::ImageData(std::unique_ptr<internal::GridData> &&gridData) : GridBase(std::move(gridData)) {}
+
+RectilinearGrid::RectilinearGrid(std::unique_ptr<internal::GridData> &&gridData) : GridBase(std::move(gridData)) {}
+
+StructuredGrid::StructuredGrid(std::unique_ptr<internal::GridData> &&gridData) : GridBase(std::move(gridData)) {}
+
+PolyData::PolyData(std::unique_ptr<internal::GridData> &&gridData) : GridBase(std::move(gridData)) {}
+
+template <bool isCellData, class T>
 requires std::is_arithmetic_v<T>
-void UnstructuredGrid::addCellData(const std::string &name, const std::vector<T> &pointData,
-                                   std::uint32_t numberOfComponents)
+void GridBase::addData(const std::string &name, std::span<const T> data, std::uint32_t numberOfComponents,
+                               bool reference, const std::optional<compression::Info> &compression,
+                               const precision::Info &precision)
 {
-    grid_data_->addData<true, T>(name, pointData, numberOfComponents);
+    grid_data_->addData<isCellData, T>(name, data, numberOfComponents, reference, compression, precision);
 }
 
-template void UnstructuredGrid::addPointData<float>(const std::string &, const std::vector<float> &, std::uint32_t);
-template void UnstructuredGrid::addPointData<double>(const std::string &, const std::vector<double> &, std::uint32_t);
-template void UnstructuredGrid::addPointData<std::uint8_t>(const std::string &, const std::vector<std::uint8_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addPointData<std::int8_t>(const std::string &, const std::vector<std::int8_t> &,
-                                                          std::uint32_t);
-template void UnstructuredGrid::addPointData<std::uint16_t>(const std::string &, const std::vector<std::uint16_t> &,
-                                                            std::uint32_t);
-template void UnstructuredGrid::addPointData<std::int16_t>(const std::string &, const std::vector<std::int16_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addPointData<std::uint32_t>(const std::string &, const std::vector<std::uint32_t> &,
-                                                            std::uint32_t);
-template void UnstructuredGrid::addPointData<std::int32_t>(const std::string &, const std::vector<std::int32_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addPointData<std::uint64_t>(const std::string &, const std::vector<std::uint64_t> &,
-                                                            std::uint32_t);
-template void UnstructuredGrid::addPointData<std::int64_t>(const std::string &, const std::vector<std::int64_t> &,
-                                                           std::uint32_t);
-
-template void UnstructuredGrid::addCellData<float>(const std::string &, const std::vector<float> &, std::uint32_t);
-template void UnstructuredGrid::addCellData<double>(const std::string &, const std::vector<double> &, std::uint32_t);
-template void UnstructuredGrid::addCellData<std::uint8_t>(const std::string &, const std::vector<std::uint8_t> &,
-                                                          std::uint32_t);
-template void UnstructuredGrid::addCellData<std::int8_t>(const std::string &, const std::vector<std::int8_t> &,
-                                                         std::uint32_t);
-template void UnstructuredGrid::addCellData<std::uint16_t>(const std::string &, const std::vector<std::uint16_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addCellData<std::int16_t>(const std::string &, const std::vector<std::int16_t> &,
-                                                          std::uint32_t);
-template void UnstructuredGrid::addCellData<std::uint32_t>(const std::string &, const std::vector<std::uint32_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addCellData<std::int32_t>(const std::string &, const std::vector<std::int32_t> &,
-                                                          std::uint32_t);
-template void UnstructuredGrid::addCellData<std::uint64_t>(const std::string &, const std::vector<std::uint64_t> &,
-                                                           std::uint32_t);
-template void UnstructuredGrid::addCellData<std::int64_t>(const std::string &, const std::vector<std::int64_t> &,
-                                                          std::uint32_t);
+template void GridBase::addData<false, float>(const std::string &, std::span<const float>, std::uint32_t, bool,
+                                              const std::optional<compression::Info> &, const precision::Info &);
+template void GridBase::addData<false, double>(const std::string &, std::span<const double>, std::uint32_t, bool,
+                                               const std::optional<compression::Info> &, const precision::Info &);
+template void GridBase::addData<false, std::uint8_t>(const std::string &, std::span<const std::uint8_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<false, std::int8_t>(const std::string &, std::span<const std::int8_t>, std::uint32_t,
+                                                    bool, const std::optional<compression::Info> &,
+                                                    const precision::Info &);
+template void GridBase::addData<false, std::uint16_t>(const std::string &, std::span<const std::uint16_t>,
+                                                      std::uint32_t, bool, const std::optional<compression::Info> &,
+                                                      const precision::Info &);
+template void GridBase::addData<false, std::int16_t>(const std::string &, std::span<const std::int16_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<false, std::uint32_t>(const std::string &, std::span<const std::uint32_t>,
+                                                      std::uint32_t, bool, const std::optional<compression::Info> &,
+                                                      const precision::Info &);
+template void GridBase::addData<false, std::int32_t>(const std::string &, std::span<const std::int32_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<false, std::uint64_t>(const std::string &, std::span<const std::uint64_t>,
+                                                      std::uint32_t, bool, const std::optional<compression::Info> &,
+                                                      const precision::Info &);
+template void GridBase::addData<false, std::int64_t>(const std::string &, std::span<const std::int64_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
 
-void UnstructuredGrid::write(const std::filesystem::path &file_path) const { grid_data_->write(file_path); }
+template void GridBase::addData<true, float>(const std::string &, std::span<const float>, std::uint32_t, bool,
+                                             const std::optional<compression::Info> &, const precision::Info &);
+template void GridBase::addData<true, double>(const std::string &, std::span<const double>, std::uint32_t, bool,
+                                              const std::optional<compression::Info> &, const precision::Info &);
+template void GridBase::addData<true, std::uint8_t>(const std::string &, std::span<const std::uint8_t>, std::uint32_t,
+                                                    bool, const std::optional<compression::Info> &,
+                                                    const precision::Info &);
+template void GridBase::addData<true, std::int8_t>(const std::string &, std::span<const std::int8_t>, std::uint32_t,
+                                                   bool, const std::optional<compression::Info> &,
+                                                   const precision::Info &);
+template void GridBase::addData<true, std::uint16_t>(const std::string &, std::span<const std::uint16_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<true, std::int16_t>(const std::string &, std::span<const std::int16_t>, std::uint32_t,
+                                                    bool, const std::optional<compression::Info> &,
+                                                    const precision::Info &);
+template void GridBase::addData<true, std::uint32_t>(const std::string &, std::span<const std::uint32_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<true, std::int32_t>(const std::string &, std::span<const std::int32_t>, std::uint32_t,
+                                                    bool, const std::optional<compression::Info> &,
+                                                    const precision::Info &);
+template void GridBase::addData<true, std::uint64_t>(const std::string &, std::span<const std::uint64_t>, std::uint32_t,
+                                                     bool, const std::optional<compression::Info> &,
+                                                     const precision::Info &);
+template void GridBase::addData<true, std::int64_t>(const std::string &, std::span<const std::int64_t>, std::uint32_t,
+                                                    bool, const std::optional<compression::Info> &,
+                                                    const precision::Info &);
 
-UnstructuredGrid createGrid(const std::vector<std::array<float, 3> > &points, CellType cellType,
-                            const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression)
+namespace {
+/**
+ * Copies count values, starting at value first, of tuples whose component c of tuple i is at bases[c] plus i times
+ * stride bytes to destination.
+ *
+ * Whole tuples of separate component arrays, i.e. stride is sizeof(T), are interleaved with the vector kernels of
+ * internal::interleave where it has one. Otherwise, Bases is a std::array if the number of components is known at
+ * compile time, which unrolls the scalar loop over the components. Values are copied with memcpy as members of packed
+ * structs need not be aligned.
+ */
+template <typename T, typename Bases>
+void gatherComponents(const Bases bases, const std::size_t stride, std::uint64_t first, std::uint64_t count,
+                      std::uint8_t *destination)
 {
-    if (points.size() > std::numeric_limits<std::uint32_t>::max() ||
-        cells.size() > std::numeric_limits<std::uint32_t>::max())
+    const std::size_t components = std::size(bases);
+    auto load = [&](std::uint64_t tuple, std::size_t component)
+    {
+        T value;
+        std::memcpy(&value, bases[component] + tuple * stride, sizeof(T));
+        return value;
+    };
+    auto store = [destination](std::uint64_t i, T value)
+    { std::memcpy(destination + i * sizeof(T), &value, sizeof(T)); };
+
+    auto tuple = first / components;
+    auto component = static_cast<std::size_t>(first % components);
+    std::uint64_t done = 0;
+    if (component != 0)
     {
-        throw std::invalid_argument("Unsupported number of points or cells");
+        // The tuple cut by the start of the range
+        for (; component < components && done < count; ++component, ++done) store(done, load(tuple, component));
+        ++tuple;
     }
-    std::vector<float> pointsVector;
-    pointsVector.reserve(points.size() * 3);
-    for (const auto &point : points)
+    const auto tuples = (count - done) / components;
+    if (stride != sizeof(T) || !internal::interleave(std::span<const std::uint8_t *const>(bases), sizeof(T), tuple,
+                                                     tuples, destination + done * sizeof(T)))
     {
-        pointsVector.insert(pointsVector.end(), point.begin(), point.end());
+        for (std::uint64_t i = 0; i < tuples; ++i)
+            for (std::size_t c = 0; c < components; ++c) store(done + i * components + c, load(tuple + i, c));
     }
+    done += tuples * components;
+    tuple += tuples;
+    // The tuple cut by the end of the range
+    for (component = 0; done < count; ++component, ++done) store(done, load(tuple, component));
+}
 
-    const auto cellCount = static_cast<std::uint32_t>(cells.size());
+template <std::size_t Components>
+std::array<const std::uint8_t *, Components> fixedBases(const std::vector<const std::uint8_t *> &bases)
+{
+    std::array<const std::uint8_t *, Components> fixed;
+    std::ranges::copy(bases, fixed.begin());
+    return fixed;
+}
 
-    std::uint32_t connectivitySize = 0;
-    for (const auto &cell : cells) connectivitySize += static_cast<std::uint32_t>(cell.size());
+/**
+ * Returns a generator interleaving the components of tuples, see gatherComponents.
+ */
+template <typename T>
+internal::Generator gatherGenerator(std::vector<const std::uint8_t *> bases, std::size_t stride)
+{
+    return internal::valueGenerator<T>(
+        [bases = std::move(bases), stride](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+        {
+            // Vectors, tensors in 2D, and colors with alpha are the common tuples
+            switch (bases.size())
+            {
+            case 1: return gatherComponents<T>(fixedBases<1>(bases), stride, first, count, destination);
+            case 2: return gatherComponents<T>(fixedBases<2>(bases), stride, first, count, destination);
+            case 3: return gatherComponents<T>(fixedBases<3>(bases), stride, first, count, destination);
+            case 4: return gatherComponents<T>(fixedBases<4>(bases), stride, first, count, destination);
+            default: return gatherComponents<T>(std::span(bases), stride, first, count, destination);
+            }
+        });
+}
+}  // namespace
+
+template <bool isCellData, class T>
+requires std::is_arithmetic_v<T>
+void GridBase::addGathered(const std::string &name, std::span<const T *const> components, std::size_t size,
+                           std::size_t stride, const std::optional<compression::Info> &compression)
+{
+    if (components.empty()) throw std::invalid_argument("A view needs at least one component");
+    const auto numberOfComponents = static_cast<std::uint32_t>(components.size());
+
+    // Tuples of consecutive components without gaps are a plain array
+    bool contiguous = stride == components.size() * sizeof(T);
+    for (std::size_t c = 1; c < components.size(); ++c) contiguous = contiguous && components[c] == components[0] + c;
+    if (contiguous)
+    {
+        addData<isCellData, T>(name, std::span(components[0], size * components.size()), numberOfComponents, false,
+                               compression, {});
+        return;
+    }
+
+    std::vector<const std::uint8_t *> bases;
+    for (const auto *component : components) bases.push_back(reinterpret_cast<const std::uint8_t *>(component));
+    grid_data_->addGenerated<isCellData, T>(name, std::uint64_t{size} * numberOfComponents, numberOfComponents,
+                                            gatherGenerator<T>(std::move(bases), stride), compression);
+}
+
+template void GridBase::addGathered<false, float>(const std::string &, std::span<const float *const>, std::size_t,
+                                                  std::size_t, const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, double>(const std::string &, std::span<const double *const>, std::size_t,
+                                                   std::size_t, const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::uint8_t>(const std::string &, std::span<const std::uint8_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::int8_t>(const std::string &, std::span<const std::int8_t *const>,
+                                                        std::size_t, std::size_t,
+                                                        const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::uint16_t>(const std::string &, std::span<const std::uint16_t *const>,
+                                                          std::size_t, std::size_t,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::int16_t>(const std::string &, std::span<const std::int16_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::uint32_t>(const std::string &, std::span<const std::uint32_t *const>,
+                                                          std::size_t, std::size_t,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::int32_t>(const std::string &, std::span<const std::int32_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::uint64_t>(const std::string &, std::span<const std::uint64_t *const>,
+                                                          std::size_t, std::size_t,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGathered<false, std::int64_t>(const std::string &, std::span<const std::int64_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+
+template void GridBase::addGathered<true, float>(const std::string &, std::span<const float *const>, std::size_t,
+                                                 std::size_t, const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, double>(const std::string &, std::span<const double *const>, std::size_t,
+                                                  std::size_t, const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::uint8_t>(const std::string &, std::span<const std::uint8_t *const>,
+                                                        std::size_t, std::size_t,
+                                                        const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::int8_t>(const std::string &, std::span<const std::int8_t *const>,
+                                                       std::size_t, std::size_t,
+                                                       const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::uint16_t>(const std::string &, std::span<const std::uint16_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::int16_t>(const std::string &, std::span<const std::int16_t *const>,
+                                                        std::size_t, std::size_t,
+                                                        const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::uint32_t>(const std::string &, std::span<const std::uint32_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::int32_t>(const std::string &, std::span<const std::int32_t *const>,
+                                                        std::size_t, std::size_t,
+                                                        const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::uint64_t>(const std::string &, std::span<const std::uint64_t *const>,
+                                                         std::size_t, std::size_t,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGathered<true, std::int64_t>(const std::string &, std::span<const std::int64_t *const>,
+                                                        std::size_t, std::size_t,
+                                                        const std::optional<compression::Info> &);
+
+template <bool isCellData, class T>
+requires std::is_arithmetic_v<T>
+void GridBase::addGenerated(const std::string &name, std::optional<std::uint64_t> size,
+                            std::uint32_t numberOfComponents, const Fill &fill,
+                            const std::optional<compression::Info> &compression)
+{
+    if (!size) size = grid_data_->tupleCount(isCellData) * numberOfComponents;
+    grid_data_->addGenerated<isCellData, T>(name, *size, numberOfComponents, internal::valueGenerator<T>(fill),
+                                            compression);
+}
+
+template void GridBase::addGenerated<false, float>(const std::string &, std::optional<std::uint64_t>, std::uint32_t,
+                                                   const Fill &, const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, double>(const std::string &, std::optional<std::uint64_t>, std::uint32_t,
+                                                    const Fill &, const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::uint8_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::int8_t>(const std::string &, std::optional<std::uint64_t>,
+                                                         std::uint32_t, const Fill &,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::uint16_t>(const std::string &, std::optional<std::uint64_t>,
+                                                           std::uint32_t, const Fill &,
+                                                           const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::int16_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::uint32_t>(const std::string &, std::optional<std::uint64_t>,
+                                                           std::uint32_t, const Fill &,
+                                                           const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::int32_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::uint64_t>(const std::string &, std::optional<std::uint64_t>,
+                                                           std::uint32_t, const Fill &,
+                                                           const std::optional<compression::Info> &);
+template void GridBase::addGenerated<false, std::int64_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+
+template void GridBase::addGenerated<true, float>(const std::string &, std::optional<std::uint64_t>, std::uint32_t,
+                                                  const Fill &, const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, double>(const std::string &, std::optional<std::uint64_t>, std::uint32_t,
+                                                   const Fill &, const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::uint8_t>(const std::string &, std::optional<std::uint64_t>,
+                                                         std::uint32_t, const Fill &,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::int8_t>(const std::string &, std::optional<std::uint64_t>,
+                                                        std::uint32_t, const Fill &,
+                                                        const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::uint16_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::int16_t>(const std::string &, std::optional<std::uint64_t>,
+                                                         std::uint32_t, const Fill &,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::uint32_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::int32_t>(const std::string &, std::optional<std::uint64_t>,
+                                                         std::uint32_t, const Fill &,
+                                                         const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::uint64_t>(const std::string &, std::optional<std::uint64_t>,
+                                                          std::uint32_t, const Fill &,
+                                                          const std::optional<compression::Info> &);
+template void GridBase::addGenerated<true, std::int64_t>(const std::string &, std::optional<std::uint64_t>,
+                                                         std::uint32_t, const Fill &,
+                                                         const std::optional<compression::Info> &);
+
+void GridBase::write(const std::filesystem::path &file_path, statistics::Info *statistics) const
+{
+    grid_data_->write(file_path, 0, statistics);
+}
+
+void GridBase::write(Sink &sink, statistics::Info *statistics) const { grid_data_->write(sink, 0, statistics); }
+
+namespace {
+std::vector<std::string> pieceSources(const std::filesystem::path &file_path, std::uint32_t pieceCount)
+{
+    // Sources are relative to the parallel file, which keeps the output directory relocatable
+    std::vector<std::string> sources;
+    sources.reserve(pieceCount);
+    for (std::uint32_t i = 0; i < pieceCount; ++i) sources.emplace_back(piecePath(file_path, i).filename().string());
+    return sources;
+}
+}  // namespace
+
+void UnstructuredGrid::writePVTU(const std::filesystem::path &file_path, std::uint32_t pieceCount) const
+{
+    grid_data_->writeParallel(file_path, pieceSources(file_path, pieceCount));
+}
+
+namespace {
+template <typename T>
+std::span<const std::uint8_t> pointBytes(std::span<const std::array<T, 3> > points)
+{
+    static_assert(sizeof(std::array<T, 3>) == 3 * sizeof(T), "points must be tightly packed");
+    return {reinterpret_cast<const std::uint8_t *>(points.data()), points.size_bytes()};
+}
+
+std::vector<std::int32_t> createConnectivity(const std::vector<std::vector<std::int32_t> > &cells)
+{
+    std::size_t connectivitySize = 0;
+    for (const auto &cell : cells) connectivitySize += cell.size();
 
     std::vector<std::int32_t> connectivity;
     connectivity.resize(connectivitySize);
 
-    std::vector<std::int32_t> offsets;
-    offsets.resize(cellCount);
+    std::size_t connectivityOffset = 0;
+    for (const auto &cell : cells)
+    {
+        std::ranges::copy(cell, connectivity.begin() + static_cast<std::ptrdiff_t>(connectivityOffset));
+        connectivityOffset += cell.size();
+    }
+    return connectivity;
+}
 
-    std::vector<std::uint8_t> types;
-    types.resize(cellCount);
+template <typename Index>
+std::vector<Index> createOffsets(const std::vector<std::vector<std::int32_t> > &cells)
+{
+    std::vector<Index> offsets;
+    offsets.resize(cells.size());
 
-    std::int32_t connectivityOffset = 0;
+    Index connectivityOffset = 0;
     for (auto i = 0ull; i < cells.size(); ++i)
     {
-        std::ranges::copy(cells[i], connectivity.begin() + connectivityOffset);
-        connectivityOffset += static_cast<std::int32_t>(cells[i].size());
-
+        connectivityOffset += static_cast<Index>(cells[i].size());
         offsets[i] = connectivityOffset;
-        types[i] = static_cast<std::uint8_t>(cellType);
     }
+    return offsets;
+}
+
+/**
+ * Returns whether the offsets into a connectivity of the passed size have to be written as Int64.
+ */
+bool needsInt64Offsets(std::size_t connectivitySize)
+{
+    return connectivitySize > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+}
+
+std::vector<std::uint8_t> createTypes(CellType cellType, std::size_t cellCount)
+{
+    return std::vector<std::uint8_t>(cellCount, static_cast<std::uint8_t>(cellType));
+}
+
+/**
+ * Returns a generator of an array of T whose element i is value(i).
+ */
+template <typename T, typename Value>
+internal::Generator elementGenerator(Value value)
+{
+    return internal::valueGenerator<T>(
+        [value](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+        {
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                const T element = value(first + i);
+                std::memcpy(destination + i * sizeof(T), &element, sizeof(T));
+            }
+        });
+}
+
+/**
+ * Returns the number of points of every cell if all cells have the same number, 0 otherwise.
+ */
+std::size_t uniformCellSize(const std::vector<std::vector<std::int32_t> > &cells)
+{
+    if (cells.empty()) return 0;
+    const auto size = cells.front().size();
+    return std::ranges::all_of(cells, [size](const auto &cell) { return cell.size() == size; }) ? size : 0;
+}
+
+/**
+ * Creates the offsets block, generated without storing the offsets if all cells have the same number of points.
+ */
+template <typename Index>
+internal::DataBlock createOffsetsBlock(const std::vector<std::vector<std::int32_t> > &cells,
+                                       const compression::Info &compression)
+{
+    const auto cellSize = static_cast<Index>(uniformCellSize(cells));
+    if (cellSize == 0) return internal::createBlock("offsets", createOffsets<Index>(cells), 0, compression);
+    return internal::createBlock(internal::blockType<Index>(), "offsets", cells.size() * sizeof(Index), 0, compression,
+                                 elementGenerator<Index>([cellSize](std::uint64_t i)
+                                                         { return static_cast<Index>((i + 1) * cellSize); }));
+}
+
+/**
+ * Creates the types block of cells of one type, which is generated instead of stored.
+ */
+internal::DataBlock createTypesBlock(CellType cellType, std::size_t cellCount, const compression::Info &compression)
+{
+    return internal::createBlock(internal::DataBlock::UInt8, "types", cellCount, 0, compression,
+                                 [cellType](std::uint64_t, std::span<std::uint8_t> destination)
+                                 { std::ranges::fill(destination, static_cast<std::uint8_t>(cellType)); });
+}
+
+template <typename T>
+internal::Topology createTopology(std::span<const std::array<T, 3> > points, CellType cellType,
+                                  const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression,
+                                  bool reference)
+{
+    const auto cellCount = cells.size();
 
     // We set numberOfComponents to zero, as these RawData have special meaning
-    auto pointBlock = internal::createBlock("", pointsVector, 3, compression);
+    auto pointBlock =
+        internal::createBlock(internal::blockType<T>(), "", pointBytes(points), 3, compression, reference);
+    const auto connectivity = createConnectivity(cells);
     auto connectivityBlock = internal::createBlock("connectivity", connectivity, 0, compression);
-    auto offsetsBlock = internal::createBlock("offsets", offsets, 0, compression);
-    auto typesBlock = internal::createBlock("types", types, 0, compression);
+    auto offsetsBlock = needsInt64Offsets(connectivity.size()) ? createOffsetsBlock<std::int64_t>(cells, compression)
+                                                               : createOffsetsBlock<std::int32_t>(cells, compression);
+    auto typesBlock = createTypesBlock(cellType, cellCount, compression);
+    return {points.size(),           cellCount, std::move(pointBlock), std::move(connectivityBlock),
+            std::move(offsetsBlock), std::move(typesBlock)};
+}
+
+template <typename T>
+UnstructuredGrid createGrid(std::span<const std::array<T, 3> > points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression,
+                            bool reference)
+{
+    return UnstructuredGrid(std::make_unique<internal::GridData>(
+        std::make_shared<const internal::Topology>(createTopology(points, cellType, cells, compression, reference)),
+        compression));
+}
+
+/**
+ * Returns the vtk offsets, i.e. the end of each cell, of CSR offsets which may start with a leading zero.
+ */
+template <typename Index>
+std::span<const Index> cellEndOffsets(std::span<const Index> connectivity, std::span<const Index> offsets,
+                                      std::size_t cellCount)
+{
+    if (offsets.size() == cellCount + 1)
+    {
+        if (offsets.front() != 0) throw std::invalid_argument("CSR offsets must start with zero");
+        offsets = offsets.subspan(1);
+    }
+    if (offsets.size() != cellCount) throw std::invalid_argument("Number of offsets does not match number of cells");
+    if (cellCount > 0 && std::cmp_not_equal(offsets.back(), connectivity.size()))
+        throw std::invalid_argument("Last offset does not match size of connectivity");
+    return offsets;
+}
+
+template <typename T, typename Index>
+UnstructuredGrid createGrid(std::span<const std::array<T, 3> > points, std::span<const Index> connectivity,
+                            std::span<const Index> offsets, std::span<const CellType> cellTypes,
+                            compression::Info compression)
+{
+    const auto cellCount = cellTypes.size();
+    const auto endOffsets = cellEndOffsets(connectivity, offsets, cellCount);
+    const std::span<const std::uint8_t> typeBytes(reinterpret_cast<const std::uint8_t *>(cellTypes.data()),
+                                                  cellTypes.size_bytes());
+
+    // We set numberOfComponents to zero, as these RawData have special meaning
+    auto pointBlock = internal::createBlock(internal::blockType<T>(), "", pointBytes(points), 3, compression, true);
+    auto connectivityBlock = internal::createBlock("connectivity", connectivity, 0, compression, true);
+    auto offsetsBlock = internal::createBlock("offsets", endOffsets, 0, compression, true);
+    auto typesBlock = internal::createBlock(internal::DataBlock::UInt8, "types", typeBytes, 0, compression, true);
     return UnstructuredGrid(std::make_unique<internal::GridData>(
-        static_cast<std::uint32_t>(points.size()), std::move(pointBlock), cellCount, std::move(connectivityBlock),
-        std::move(offsetsBlock), std::move(typesBlock), compression));
+        points.size(), std::move(pointBlock), cellCount, std::move(connectivityBlock), std::move(offsetsBlock),
+        std::move(typesBlock), compression));
 }
 
-void write(const UnstructuredGrid &grid, const std::filesystem::path &file_path) { grid.write(file_path); }
+template <typename T>
+StreamingGrid createStreamingGrid(const std::filesystem::path &file_path, std::span<const std::array<T, 3> > points,
+                                  CellType cellType, const std::vector<std::vector<std::int32_t> > &cells,
+                                  compression::Info compression, streaming::Info streaming)
+{
+    using Section = internal::GridStream::Section;
+    const auto cellCount = cells.size();
+
+    auto gridStream =
+        std::make_unique<internal::GridStream>(file_path, points.size(), cellCount, compression, streaming);
+    // The points are compressed straight from the caller's memory, each temporary array is released once it is written
+    gridStream->addArray(Section::Points, "", std::span(reinterpret_cast<const T *>(points.data()), points.size() * 3),
+                         3);
+    std::size_t connectivitySize = 0;
+    {
+        const auto connectivity = createConnectivity(cells);
+        connectivitySize = connectivity.size();
+        gridStream->addArray(Section::CellConnectivity, "connectivity", std::span(connectivity), 0);
+    }
+    if (needsInt64Offsets(connectivitySize))
+        gridStream->addArray(Section::CellOffsets, "offsets",
+                             std::span<const std::int64_t>(createOffsets<std::int64_t>(cells)), 0);
+    else
+        gridStream->addArray(Section::CellOffsets, "offsets",
+                             std::span<const std::int32_t>(createOffsets<std::int32_t>(cells)), 0);
+    gridStream->addArray(Section::CellTypes, "types", std::span<const std::uint8_t>(createTypes(cellType, cellCount)),
+                         0);
+    return StreamingGrid(std::move(gridStream));
+}
+}  // namespace
+
+UnstructuredGrid createGrid(const std::vector<std::array<float, 3> > &points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression)
+{
+    return createGrid<float>(points, cellType, cells, compression, false);
+}
+
+UnstructuredGrid createGrid(std::span<const std::array<float, 3> > points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression)
+{
+    return createGrid<float>(points, cellType, cells, compression, true);
+}
+
+UnstructuredGrid createGrid(std::span<const std::array<double, 3> > points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells, compression::Info compression)
+{
+    return createGrid<double>(points, cellType, cells, compression, true);
+}
+
+template <class Index>
+requires std::is_integral_v<Index>
+UnstructuredGrid createGrid(std::span<const std::array<float, 3> > points, std::span<const Index> connectivity,
+                            std::span<const Index> offsets, std::span<const CellType> cellTypes,
+                            compression::Info compression)
+{
+    return createGrid<float, Index>(points, connectivity, offsets, cellTypes, compression);
+}
+
+template <class Index>
+requires std::is_integral_v<Index>
+UnstructuredGrid createGrid(std::span<const std::array<double, 3> > points, std::span<const Index> connectivity,
+                            std::span<const Index> offsets, std::span<const CellType> cellTypes,
+                            compression::Info compression)
+{
+    return createGrid<double, Index>(points, connectivity, offsets, cellTypes, compression);
+}
+
+template UnstructuredGrid createGrid<std::uint8_t>(std::span<const std::array<float, 3> >,
+                                                   std::span<const std::uint8_t>, std::span<const std::uint8_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int8_t>(std::span<const std::array<float, 3> >,
+                                                  std::span<const std::int8_t>, std::span<const std::int8_t>,
+                                                  std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint16_t>(std::span<const std::array<float, 3> >,
+                                                    std::span<const std::uint16_t>, std::span<const std::uint16_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int16_t>(std::span<const std::array<float, 3> >,
+                                                   std::span<const std::int16_t>, std::span<const std::int16_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint32_t>(std::span<const std::array<float, 3> >,
+                                                    std::span<const std::uint32_t>, std::span<const std::uint32_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int32_t>(std::span<const std::array<float, 3> >,
+                                                   std::span<const std::int32_t>, std::span<const std::int32_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint64_t>(std::span<const std::array<float, 3> >,
+                                                    std::span<const std::uint64_t>, std::span<const std::uint64_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int64_t>(std::span<const std::array<float, 3> >,
+                                                   std::span<const std::int64_t>, std::span<const std::int64_t>,
+                                                   std::span<const CellType>, compression::Info);
+
+template UnstructuredGrid createGrid<std::uint8_t>(std::span<const std::array<double, 3> >,
+                                                   std::span<const std::uint8_t>, std::span<const std::uint8_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int8_t>(std::span<const std::array<double, 3> >,
+                                                  std::span<const std::int8_t>, std::span<const std::int8_t>,
+                                                  std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint16_t>(std::span<const std::array<double, 3> >,
+                                                    std::span<const std::uint16_t>, std::span<const std::uint16_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int16_t>(std::span<const std::array<double, 3> >,
+                                                   std::span<const std::int16_t>, std::span<const std::int16_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint32_t>(std::span<const std::array<double, 3> >,
+                                                    std::span<const std::uint32_t>, std::span<const std::uint32_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int32_t>(std::span<const std::array<double, 3> >,
+                                                   std::span<const std::int32_t>, std::span<const std::int32_t>,
+                                                   std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::uint64_t>(std::span<const std::array<double, 3> >,
+                                                    std::span<const std::uint64_t>, std::span<const std::uint64_t>,
+                                                    std::span<const CellType>, compression::Info);
+template UnstructuredGrid createGrid<std::int64_t>(std::span<const std::array<double, 3> >,
+                                                   std::span<const std::int64_t>, std::span<const std::int64_t>,
+                                                   std::span<const CellType>, compression::Info);
+
+namespace {
+/**
+ * Creates a grid of a structured type, whose cells follow from the dimensions, from the blocks of its points.
+ */
+template <typename GridType>
+GridType createStructured(const internal::Structure &structure, internal::DataBlock &&points,
+                          std::vector<internal::DataBlock> &&coordinates, const compression::Info &compression)
+{
+    const auto &[nx, ny, nz] = structure.dimensions;
+    const auto cellCount = internal::structuredCellCount(structure.dimensions);
+    return GridType(std::make_unique<internal::GridData>(
+        std::make_shared<const internal::Topology>(internal::Topology{
+            nx * ny * nz, cellCount, std::move(points), {}, {}, {}, structure, std::move(coordinates)}),
+        compression));
+}
+
+template <typename T>
+RectilinearGrid createRectilinearGrid(std::span<const T> x, std::span<const T> y, std::span<const T> z,
+                                      const compression::Info &compression)
+{
+    const std::array axes{x, y, z};
+    constexpr const char *Names[] = {"x_coordinates", "y_coordinates", "z_coordinates"};
+    std::vector<internal::DataBlock> coordinates;
+    for (std::size_t i = 0; i < axes.size(); ++i)
+        coordinates.push_back(internal::createBlock(Names[i], axes[i], 0, compression, true));
+    return createStructured<RectilinearGrid>({internal::DatasetType::RectilinearGrid, {x.size(), y.size(), z.size()}},
+                                             {}, std::move(coordinates), compression);
+}
+
+template <typename T>
+StructuredGrid createStructuredGrid(std::array<std::uint64_t, 3> dimensions, std::span<const std::array<T, 3> > points,
+                                    const compression::Info &compression)
+{
+    if (points.size() != dimensions[0] * dimensions[1] * dimensions[2])
+        throw std::invalid_argument("Number of points does not match the dimensions");
+    // We set numberOfComponents to zero, as these RawData have special meaning
+    auto pointBlock = internal::createBlock(internal::blockType<T>(), "", pointBytes(points), 3, compression, true);
+    return createStructured<StructuredGrid>({internal::DatasetType::StructuredGrid, dimensions}, std::move(pointBlock),
+                                            {}, compression);
+}
+}  // namespace
+
+ImageData createImageData(std::array<std::uint64_t, 3> dimensions, std::array<double, 3> origin,
+                          std::array<double, 3> spacing, compression::Info compression)
+{
+    return createStructured<ImageData>({internal::DatasetType::ImageData, dimensions, origin, spacing}, {}, {},
+                                       compression);
+}
+
+RectilinearGrid createRectilinearGrid(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                                      compression::Info compression)
+{
+    return createRectilinearGrid<float>(x, y, z, compression);
+}
+
+RectilinearGrid createRectilinearGrid(std::span<const double> x, std::span<const double> y, std::span<const double> z,
+                                      compression::Info compression)
+{
+    return createRectilinearGrid<double>(x, y, z, compression);
+}
+
+StructuredGrid createStructuredGrid(std::array<std::uint64_t, 3> dimensions,
+                                    std::span<const std::array<float, 3> > points, compression::Info compression)
+{
+    return createStructuredGrid<float>(dimensions, points, compression);
+}
+
+StructuredGrid createStructuredGrid(std::array<std::uint64_t, 3> dimensions,
+                                    std::span<const std::array<double, 3> > points, compression::Info compression)
+{
+    return createStructuredGrid<double>(dimensions, points, compression);
+}
+
+namespace {
+/**
+ * Creates a PolyData from the blocks of its points and of the connectivity and offsets of its sections with cells.
+ */
+PolyData createPolyData(std::uint64_t pointCount, internal::DataBlock &&points,
+                        const std::array<std::uint64_t, 3> &counts, std::vector<internal::DataBlock> &&cells,
+                        const compression::Info &compression)
+{
+    internal::Structure structure{internal::DatasetType::PolyData};
+    structure.poly_counts = counts;
+    return PolyData(std::make_unique<internal::GridData>(
+        std::make_shared<const internal::Topology>(internal::Topology{pointCount, counts[0] + counts[1] + counts[2],
+                                                                      std::move(points), {}, {}, {}, structure, {},
+                                                                      std::move(cells)}),
+        compression));
+}
+
+/**
+ * Appends the connectivity and offsets of one vertex per point, which are generated instead of stored.
+ */
+template <typename Index>
+void appendVertexBlocks(std::uint64_t pointCount, const compression::Info &compression,
+                        std::vector<internal::DataBlock> &cells)
+{
+    cells.push_back(internal::createBlock(internal::blockType<Index>(), "connectivity", pointCount * sizeof(Index), 0,
+                                          compression, elementGenerator<Index>([](std::uint64_t i)
+                                                                               { return static_cast<Index>(i); })));
+    cells.push_back(internal::createBlock(internal::blockType<Index>(), "offsets", pointCount * sizeof(Index), 0,
+                                          compression, elementGenerator<Index>([](std::uint64_t i)
+                                                                               { return static_cast<Index>(i + 1); })));
+}
+
+template <typename T>
+PolyData createPointCloud(std::span<const std::array<T, 3> > points, const compression::Info &compression,
+                          bool vertices)
+{
+    // We set numberOfComponents to zero, as these RawData have special meaning
+    auto pointBlock = internal::createBlock(internal::blockType<T>(), "", pointBytes(points), 3, compression, true);
+    std::vector<internal::DataBlock> cells;
+    if (vertices && needsInt64Offsets(points.size()))
+        appendVertexBlocks<std::int64_t>(points.size(), compression, cells);
+    else if (vertices)
+        appendVertexBlocks<std::int32_t>(points.size(), compression, cells);
+    return createPolyData(points.size(), std::move(pointBlock), {vertices ? points.size() : 0, 0, 0},
+                          std::move(cells), compression);
+}
+
+template <typename T, typename Index>
+PolyData createPolyData(std::span<const std::array<T, 3> > points, PolyCells<Index> lines, PolyCells<Index> polys,
+                        const compression::Info &compression)
+{
+    auto pointBlock = internal::createBlock(internal::blockType<T>(), "", pointBytes(points), 3, compression, true);
+    std::array<std::uint64_t, 3> counts{};
+    std::vector<internal::DataBlock> cells;
+    const std::array sections{lines, polys};
+    for (std::size_t i = 0; i < sections.size(); ++i)
+    {
+        const auto &[connectivity, offsets] = sections[i];
+        // A leading zero is only part of CSR offsets, vtk offsets start with the end of the first cell
+        const auto cellCount = offsets.empty() || offsets.front() != 0 ? offsets.size() : offsets.size() - 1;
+        const auto endOffsets = cellEndOffsets(connectivity, offsets, cellCount);
+        if (cellCount == 0)
+        {
+            if (!connectivity.empty()) throw std::invalid_argument("Connectivity without offsets");
+            continue;
+        }
+        counts[i + 1] = cellCount;
+        cells.push_back(internal::createBlock("connectivity", connectivity, 0, compression, true));
+        cells.push_back(internal::createBlock("offsets", endOffsets, 0, compression, true));
+    }
+    return createPolyData(points.size(), std::move(pointBlock), counts, std::move(cells), compression);
+}
+}  // namespace
+
+PolyData createPolyData(std::span<const std::array<float, 3> > points, compression::Info compression, bool vertices)
+{
+    return createPointCloud<float>(points, compression, vertices);
+}
+
+PolyData createPolyData(std::span<const std::array<double, 3> > points, compression::Info compression, bool vertices)
+{
+    return createPointCloud<double>(points, compression, vertices);
+}
+
+template <class Index>
+requires std::is_integral_v<Index>
+PolyData createPolyData(std::span<const std::array<float, 3> > points, PolyCells<Index> lines, PolyCells<Index> polys,
+                        compression::Info compression)
+{
+    return createPolyData<float, Index>(points, lines, polys, compression);
+}
+
+template <class Index>
+requires std::is_integral_v<Index>
+PolyData createPolyData(std::span<const std::array<double, 3> > points, PolyCells<Index> lines, PolyCells<Index> polys,
+                        compression::Info compression)
+{
+    return createPolyData<double, Index>(points, lines, polys, compression);
+}
+
+template PolyData createPolyData<std::uint8_t>(std::span<const std::array<float, 3> >, PolyCells<std::uint8_t>,
+                                               PolyCells<std::uint8_t>, compression::Info);
+template PolyData createPolyData<std::int8_t>(std::span<const std::array<float, 3> >, PolyCells<std::int8_t>,
+                                              PolyCells<std::int8_t>, compression::Info);
+template PolyData createPolyData<std::uint16_t>(std::span<const std::array<float, 3> >, PolyCells<std::uint16_t>,
+                                                PolyCells<std::uint16_t>, compression::Info);
+template PolyData createPolyData<std::int16_t>(std::span<const std::array<float, 3> >, PolyCells<std::int16_t>,
+                                               PolyCells<std::int16_t>, compression::Info);
+template PolyData createPolyData<std::uint32_t>(std::span<const std::array<float, 3> >, PolyCells<std::uint32_t>,
+                                                PolyCells<std::uint32_t>, compression::Info);
+template PolyData createPolyData<std::int32_t>(std::span<const std::array<float, 3> >, PolyCells<std::int32_t>,
+                                               PolyCells<std::int32_t>, compression::Info);
+template PolyData createPolyData<std::uint64_t>(std::span<const std::array<float, 3> >, PolyCells<std::uint64_t>,
+                                                PolyCells<std::uint64_t>, compression::Info);
+template PolyData createPolyData<std::int64_t>(std::span<const std::array<float, 3> >, PolyCells<std::int64_t>,
+                                               PolyCells<std::int64_t>, compression::Info);
+
+template PolyData createPolyData<std::uint8_t>(std::span<const std::array<double, 3> >, PolyCells<std::uint8_t>,
+                                               PolyCells<std::uint8_t>, compression::Info);
+template PolyData createPolyData<std::int8_t>(std::span<const std::array<double, 3> >, PolyCells<std::int8_t>,
+                                              PolyCells<std::int8_t>, compression::Info);
+template PolyData createPolyData<std::uint16_t>(std::span<const std::array<double, 3> >, PolyCells<std::uint16_t>,
+                                                PolyCells<std::uint16_t>, compression::Info);
+template PolyData createPolyData<std::int16_t>(std::span<const std::array<double, 3> >, PolyCells<std::int16_t>,
+                                               PolyCells<std::int16_t>, compression::Info);
+template PolyData createPolyData<std::uint32_t>(std::span<const std::array<double, 3> >, PolyCells<std::uint32_t>,
+                                                PolyCells<std::uint32_t>, compression::Info);
+template PolyData createPolyData<std::int32_t>(std::span<const std::array<double, 3> >, PolyCells<std::int32_t>,
+                                               PolyCells<std::int32_t>, compression::Info);
+template PolyData createPolyData<std::uint64_t>(std::span<const std::array<double, 3> >, PolyCells<std::uint64_t>,
+                                                PolyCells<std::uint64_t>, compression::Info);
+template PolyData createPolyData<std::int64_t>(std::span<const std::array<double, 3> >, PolyCells<std::int64_t>,
+                                               PolyCells<std::int64_t>, compression::Info);
+
+StreamingGrid::StreamingGrid(std::unique_ptr<internal::GridStream> &&gridStream) : grid_stream_(std::move(gridStream))
+{}
+
+StreamingGrid::~StreamingGrid() = default;
+
+template <bool isCellData, class T>
+requires std::is_arithmetic_v<T>
+void StreamingGrid::addData(const std::string &name, std::span<const T> data, std::uint32_t numberOfComponents)
+{
+    grid_stream_->addData<isCellData, T>(name, data, numberOfComponents);
+}
+
+template void StreamingGrid::addData<false, float>(const std::string &, std::span<const float>, std::uint32_t);
+template void StreamingGrid::addData<false, double>(const std::string &, std::span<const double>, std::uint32_t);
+template void StreamingGrid::addData<false, std::uint8_t>(const std::string &, std::span<const std::uint8_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<false, std::int8_t>(const std::string &, std::span<const std::int8_t>,
+                                                         std::uint32_t);
+template void StreamingGrid::addData<false, std::uint16_t>(const std::string &, std::span<const std::uint16_t>,
+                                                           std::uint32_t);
+template void StreamingGrid::addData<false, std::int16_t>(const std::string &, std::span<const std::int16_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<false, std::uint32_t>(const std::string &, std::span<const std::uint32_t>,
+                                                           std::uint32_t);
+template void StreamingGrid::addData<false, std::int32_t>(const std::string &, std::span<const std::int32_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<false, std::uint64_t>(const std::string &, std::span<const std::uint64_t>,
+                                                           std::uint32_t);
+template void StreamingGrid::addData<false, std::int64_t>(const std::string &, std::span<const std::int64_t>,
+                                                          std::uint32_t);
+
+template void StreamingGrid::addData<true, float>(const std::string &, std::span<const float>, std::uint32_t);
+template void StreamingGrid::addData<true, double>(const std::string &, std::span<const double>, std::uint32_t);
+template void StreamingGrid::addData<true, std::uint8_t>(const std::string &, std::span<const std::uint8_t>,
+                                                         std::uint32_t);
+template void StreamingGrid::addData<true, std::int8_t>(const std::string &, std::span<const std::int8_t>,
+                                                        std::uint32_t);
+template void StreamingGrid::addData<true, std::uint16_t>(const std::string &, std::span<const std::uint16_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<true, std::int16_t>(const std::string &, std::span<const std::int16_t>,
+                                                         std::uint32_t);
+template void StreamingGrid::addData<true, std::uint32_t>(const std::string &, std::span<const std::uint32_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<true, std::int32_t>(const std::string &, std::span<const std::int32_t>,
+                                                         std::uint32_t);
+template void StreamingGrid::addData<true, std::uint64_t>(const std::string &, std::span<const std::uint64_t>,
+                                                          std::uint32_t);
+template void StreamingGrid::addData<true, std::int64_t>(const std::string &, std::span<const std::int64_t>,
+                                                         std::uint32_t);
+
+void StreamingGrid::close() { grid_stream_->close(); }
+
+StreamingGrid createStreamingGrid(const std::filesystem::path &file_path,
+                                  std::span<const std::array<float, 3> > points, CellType cellType,
+                                  const std::vector<std::vector<std::int32_t> > &cells,
+                                  compression::Info compression, streaming::Info streaming)
+{
+    return createStreamingGrid<float>(file_path, points, cellType, cells, compression, streaming);
+}
+
+StreamingGrid createStreamingGrid(const std::filesystem::path &file_path,
+                                  std::span<const std::array<double, 3> > points, CellType cellType,
+                                  const std::vector<std::vector<std::int32_t> > &cells,
+                                  compression::Info compression, streaming::Info streaming)
+{
+    return createStreamingGrid<double>(file_path, points, cellType, cells, compression, streaming);
+}
+
+AsyncWriter::AsyncWriter(async::Info info)
+    : info_(info), queue_(std::make_unique<internal::WriteQueue>(info.maxInFlight, info.threads))
+{}
+
+AsyncWriter::~AsyncWriter() = default;
+
+std::future<void> AsyncWriter::write(UnstructuredGrid &&grid, const std::filesystem::path &file_path)
+{
+    return queue_->submit(std::packaged_task<void()>(
+        [this, grid = std::move(grid), file_path] { grid.grid_data_->write(file_path, info_.bandwidth); }));
+}
+
+std::future<void> AsyncWriter::write(std::function<UnstructuredGrid()> createGrid,
+                                     const std::filesystem::path &file_path)
+{
+    return queue_->submit(std::packaged_task<void()>(
+        [this, createGrid = std::move(createGrid), file_path]
+        { createGrid().grid_data_->write(file_path, info_.bandwidth); }));
+}
+
+void AsyncWriter::wait() { queue_->wait(); }
+
+TimeSeries::TimeSeries(std::filesystem::path file_path, std::shared_ptr<const internal::Topology> topology,
+                       compression::Info compression)
+    : file_path_(std::move(file_path)), topology_(std::move(topology)), compression_(compression)
+{}
+
+UnstructuredGrid TimeSeries::createStep() const
+{
+    return UnstructuredGrid(std::make_unique<internal::GridData>(topology_, compression_));
+}
+
+namespace {
+std::filesystem::path stepPath(const std::filesystem::path &file_path, std::size_t step)
+{
+    return file_path.parent_path() / (file_path.stem().string() + "_" + std::to_string(step) + ".vtu");
+}
+}  // namespace
+
+void TimeSeries::write(const UnstructuredGrid &step, double time)
+{
+    step.write(stepPath(file_path_, times_.size()));
+    times_.push_back(time);
+
+    // The collection is rewritten as a whole, it is small compared to the steps
+    std::vector<internal::CollectionEntry> entries;
+    entries.reserve(times_.size());
+    for (std::size_t i = 0; i < times_.size(); ++i)
+        entries.push_back({times_[i], stepPath(file_path_, i).filename().string()});
+    internal::writeCollection(file_path_, entries);
+}
+
+namespace {
+/**
+ * Creates the topology shared by the steps of a time series, which is compressed right away to compress it only once.
+ */
+template <typename T>
+std::shared_ptr<const internal::Topology> createSharedTopology(std::span<const std::array<T, 3> > points,
+                                                               CellType cellType,
+                                                               const std::vector<std::vector<std::int32_t> > &cells,
+                                                               compression::Info compression)
+{
+    compression.deferred = false;
+    return std::make_shared<const internal::Topology>(createTopology(points, cellType, cells, compression, false));
+}
+}  // namespace
+
+TimeSeries createTimeSeries(const std::filesystem::path &file_path, std::span<const std::array<float, 3> > points,
+                            CellType cellType, const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression)
+{
+    return {file_path, createSharedTopology(points, cellType, cells, compression), compression};
+}
+
+TimeSeries createTimeSeries(const std::filesystem::path &file_path, std::span<const std::array<double, 3> > points,
+                            CellType cellType, const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression)
+{
+    return {file_path, createSharedTopology(points, cellType, cells, compression), compression};
+}
+
+void write(const GridBase &grid, const std::filesystem::path &file_path) { grid.write(file_path); }
+
+void write(const GridBase &grid, Sink &sink) { grid.write(sink); }
+
+std::filesystem::path piecePath(const std::filesystem::path &file_path, std::uint32_t piece)
+{
+    return file_path.parent_path() / (file_path.stem().string() + "_" + std::to_string(piece) + ".vtu");
+}
+
+void writePartitioned(std::span<const UnstructuredGrid> pieces, const std::filesystem::path &file_path,
+                      std::uint32_t threads)
+{
+    if (pieces.empty()) throw std::invalid_argument("A partitioned grid needs at least one piece");
+    if (pieces.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::invalid_argument("Too many pieces");
+    for (const auto &piece : pieces.subspan(1))
+        if (!pieces.front().grid_data_->hasSameArrays(*piece.grid_data_))
+            throw std::invalid_argument("All pieces must hold the same arrays");
+
+    internal::parallelFor(pieces.size(), threads, [&](std::size_t i)
+                          { pieces[i].write(piecePath(file_path, static_cast<std::uint32_t>(i))); });
+    pieces.front().writePVTU(file_path, static_cast<std::uint32_t>(pieces.size()));
+}
+
+template <class T>
+requires std::is_arithmetic_v<T>
+std::span<const T> Array::values() const
+{
+    if (static_cast<internal::DataBlock::Type>(type) != internal::blockType<T>())
+        throw std::invalid_argument("[Array::values] the type does not match the values of array '" + name + "'");
+    return {reinterpret_cast<const T *>(bytes.data()), bytes.size() / sizeof(T)};
+}
+
+template std::span<const float> Array::values<float>() const;
+template std::span<const double> Array::values<double>() const;
+template std::span<const std::uint8_t> Array::values<std::uint8_t>() const;
+template std::span<const std::int8_t> Array::values<std::int8_t>() const;
+template std::span<const std::uint16_t> Array::values<std::uint16_t>() const;
+template std::span<const std::int16_t> Array::values<std::int16_t>() const;
+template std::span<const std::uint32_t> Array::values<std::uint32_t>() const;
+template std::span<const std::int32_t> Array::values<std::int32_t>() const;
+template std::span<const std::uint64_t> Array::values<std::uint64_t>() const;
+template std::span<const std::int64_t> Array::values<std::int64_t>() const;
+
+const Array *Dataset::find(const std::string &name) const
+{
+    for (const auto *arrays : {&pointData, &cellData})
+        for (const auto &array : *arrays)
+            if (array.name == name) return &array;
+    return nullptr;
+}
+
+Dataset read(const std::filesystem::path &file_path, const reading::Info &reading)
+{
+    return internal::readDataset(file_path, reading);
+}
 }  // namespace tinyvtu
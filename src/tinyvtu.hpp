@@ -1,17 +1,69 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <iosfwd>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tinyvtu::internal {
 class GridData;
+struct Topology;
 }
 
 namespace tinyvtu::compression {
+/**
+ * @brief Enumerates the codecs blocks can be compressed with.
+ *
+ * All codecs use the same block layout, each block is an independent stream of the codec. LZ4 and LZMA are only
+ * available if tinyvtu is built with TINYVTU_WITH_LZ4 or TINYVTU_WITH_LZMA.
+ */
+enum class Codec : std::uint8_t
+{
+    ZLib,  ///< vtkZLibDataCompressor, readable everywhere
+    LZ4,   ///< vtkLZ4DataCompressor, decompresses several times faster than zlib
+    LZMA   ///< vtkLZMADataCompressor, best compression ratio but slow
+};
+
+/**
+ * @brief Enumerates the engines producing zlib streams for Codec::ZLib.
+ *
+ * All engines write the zlib format of vtkZLibDataCompressor and are readable by every VTK reader, they differ in
+ * speed and, slightly, in the compressed bytes. Engines besides zlib are only available if tinyvtu is built with
+ * TINYVTU_WITH_LIBDEFLATE.
+ */
+enum class Deflate : std::uint8_t
+{
+    Default,     ///< The engine chosen with TINYVTU_DEFAULT_DEFLATE when building tinyvtu, zlib unless changed
+    ZLib,        ///< Stock zlib
+    LibDeflate   ///< libdeflate, compresses several times faster than zlib at the same level
+};
+
+/**
+ * @brief Enumerates the encodings of the arrays in the written file.
+ *
+ * Base64 grows the data by a third, but the file is valid XML, which some readers like vtk.js and XML tools require.
+ * Compressed arrays are encoded after compression, as vtk does.
+ */
+enum class Encoding : std::uint8_t
+{
+    AppendedRaw,     ///< The arrays follow the XML in binary, the smallest and fastest output
+    AppendedBase64,  ///< The arrays follow the XML in base64
+    InlineBase64     ///< Each DataArray element holds its array in base64 (format="binary")
+};
+
 /**
  * @brief Represents compression information.
  *
@@ -30,6 +82,8 @@ struct Info
      * @brief Defines the size of a block for compression.
      *
      * This variable determines the size, in bytes, of each block used during the compression process.
+     * A value of 0 selects the size from the L2 cache of the machine, such that a block and the state of the
+     * compressor stay in the cache. The written data then depends on the machine.
      */
     std::uint32_t blockSize = 32768;
 
@@ -41,6 +95,68 @@ struct Info
      * Valid range: 0-9, where 0=fastest, 9=best compression
      */
     std::int32_t level = 2;
+
+    /**
+     * @brief Specifies the number of threads used to compress the blocks of an array.
+     *
+     * Each block is an independent zlib stream, hence blocks can be compressed concurrently. The written data does not
+     * depend on the number of threads.
+     * A value of 0 uses all hardware threads.
+     */
+    std::uint32_t threads = 1;
+
+    /**
+     * @brief Specifies the codec the blocks are compressed with.
+     *
+     * The level is passed to the codec: zlib and LZMA use it as their preset, LZ4 uses an acceleration of 10 - level.
+     */
+    Codec codec = Codec::ZLib;
+
+    /**
+     * @brief Specifies the engine compressing blocks if the codec is zlib.
+     *
+     * Selecting an engine which is not built in throws std::invalid_argument when compressing.
+     */
+    Deflate deflate = Deflate::Default;
+
+    /**
+     * @brief Specifies the compression ratio below which a block is stored instead of compressed.
+     *
+     * If positive, the first 4 KiB of each block are compressed as a deflate block of their own. If they do not reach
+     * the ratio, i.e. the uncompressed by the compressed size, the rest of the block is stored, which is still valid
+     * zlib. For example, 1.05 skips data which shrinks by less than 5%, like noisy floating point fields. Blocks are
+     * stored by stock zlib, which is used even if another engine is the default. Other codecs, or another engine
+     * selected explicitly, throw std::invalid_argument when compressing.
+     */
+    double minRatio = 0;
+
+    /**
+     * @brief Defers the compression of a grid's arrays until it is written.
+     *
+     * If set, createGrid, addPointData, and addCellData only record the arrays: views are referenced and must stay
+     * valid until the grid is written, vectors are copied. write() then compresses all arrays of the grid together,
+     * largest first, on threads threads. This uses all threads even if each array is too small to be split among them.
+     * The written data is the same as without deferring, but every write compresses the arrays again. Ignored by
+     * streaming grids and by the points and cells of a time series, which are compressed once.
+     */
+    bool deferred = false;
+
+    /**
+     * @brief Specifies how the arrays are encoded in the file.
+     *
+     * Base64 is encoded while writing, on threads threads. Streaming grids only write raw appended data. Arrays which
+     * override the compression settings of their grid are written with the encoding of the grid.
+     */
+    Encoding encoding = Encoding::AppendedRaw;
+
+    /**
+     * @brief Shares the appended data of arrays with the same content.
+     *
+     * If set, each array is hashed on threads threads before it is compressed. An array whose data and settings equal
+     * those of an array added to the grid before is not compressed, its DataArray element refers to the appended data
+     * of the other array. Hashing reads every array once more, hence it is off by default.
+     */
+    bool deduplicate = false;
 };
 
 /**
@@ -57,137 +173,1764 @@ static constexpr Info none = {false, 0, 0};
  * 32KB and a compression level of 2.
  */
 static constexpr Info zlib = {true, 32768, 2};
-}  // namespace tinyvtu::compression
 
-namespace tinyvtu {
 /**
- * @brief Enumerates different cell types used in grid structures.
+ * @brief LZ4 compression.
  *
- * Represents the various types of cells that can be used in a grid for data structures, enabling a wide range of
- * geometric representations. These must be consistent with the vtk definitions.
- * @see https://vtk.org/doc/nightly/html/vtkCellType_8h.html
+ * This constant provides an Info object that configures compression using LZ4 with a block size of 32KB and default
+ * acceleration. Requires tinyvtu to be built with TINYVTU_WITH_LZ4.
  */
-enum class CellType : std::uint8_t
+static constexpr Info lz4 = {true, 32768, 9, 1, Codec::LZ4};
+
+/**
+ * @brief LZMA compression.
+ *
+ * This constant provides an Info object that configures compression using LZMA with a block size of 32KB and a
+ * preset of 6. Requires tinyvtu to be built with TINYVTU_WITH_LZMA.
+ */
+static constexpr Info lzma = {true, 32768, 6, 1, Codec::LZMA};
+}  // namespace tinyvtu::compression
+
+namespace tinyvtu::precision {
+/**
+ * @brief Enumerates the types an array can be narrowed to.
+ */
+enum class Narrowing : std::uint8_t
 {
-    Vertex = 1,
-    PolyVertex = 2,
-    Line = 3,
-    PolyLine = 4,
-    Triangle = 5,
-    TriangleStrip = 6,
-    Polygon = 7,
-    Pixel = 8,
-    Quad = 9,
-    Tetra = 10,
-    Voxel = 11,
-    Hexahedron = 12,
-    Wedge = 13,
-    Pyramid = 14
+    None,     ///< The array keeps its type
+    Float32,  ///< double to float
+    Int32,    ///< Integers to std::int32_t
+    Int16     ///< Integers to std::int16_t
 };
 
 /**
- * @brief Represents an unstructured grid that can hold and manage various types of grid data.
+ * @brief Represents the precision an array is written with.
  *
- * The UnstructuredGrid class is used for handling unstructured grid data, allowing users to add point and cell data
- * of different types and write the grid to a file.
+ * Noise in the low mantissa bits of floating point data compresses poorly. Rounding the mantissa to the significant
+ * bits and narrowing the type shrink the compressed data considerably, while the file stays a standard VTU file.
+ * Both are applied while the array is added, the caller's data is not modified.
+ */
+struct Info
+{
+    /**
+     * @brief Specifies the number of significant bits floating point values are rounded to.
+     *
+     * Counts the implicit leading bit like std::numeric_limits<T>::digits, i.e. 24 keeps all bits of a float and 53
+     * all bits of a double. Values are rounded to nearest, infinities and NaNs are kept. 0 keeps all bits.
+     */
+    std::uint32_t significantBits = 0;
+
+    /**
+     * @brief Specifies the maximal relative error of rounding floating point values.
+     *
+     * The error bound is converted to the least number of significant bits meeting it. If significantBits is set as
+     * well, the more precise of both is used. 0 does not bound the error. The bound holds for the written values, so
+     * adding the array throws std::invalid_argument if the narrowed type has too few bits or if a value, e.g. a
+     * denormal or one which underflows to zero, would be written with a larger error.
+     */
+    double relativeError = 0;
+
+    /**
+     * @brief Specifies the type the array is written as.
+     *
+     * Float32 applies to double arrays, Int32 and Int16 to integer arrays. If a finite value is out of the range of
+     * the narrower type, adding the array throws std::invalid_argument.
+     */
+    Narrowing narrowing = Narrowing::None;
+};
+
+/**
+ * @brief Keeps the data as it is.
+ */
+static constexpr Info full = {};
+}  // namespace tinyvtu::precision
+
+namespace tinyvtu::internal {
+class GridStream;
+class WriteQueue;
+}
+
+namespace tinyvtu::streaming {
+/**
+ * @brief Represents the settings of a streaming grid.
  *
- * To create an UnstructuredGrid, use the @see tinyvtu::createGrid() function
+ * A streaming grid writes every array to its file as soon as it is added, instead of keeping all compressed arrays in
+ * memory until the grid is written.
  */
-class UnstructuredGrid final
+struct Info
 {
-public:
     /**
-     * @brief Constructs an UnstructuredGrid object.
+     * @brief Defines the maximal amount of compressed data held in memory.
      *
-     * Initializes the UnstructuredGrid with the provided grid data, transferring ownership of the data. Use
-     * `createGrid` instead of calling it directly
+     * This variable bounds, in bytes, the compressed data waiting to be written to the file. Arrays larger than the
+     * budget are compressed and written in several parts. A budget smaller than a single compressed block is exceeded
+     * by one block.
+     */
+    std::uint64_t memoryBudget = 64 * 1024 * 1024;
+
+    /**
+     * @brief Defines the space reserved for the XML header at the start of the file.
      *
-     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
-     *                 The ownership of gridData is moved to the constructed UnstructuredGrid object.
+     * The XML header is written when the grid is closed. If it is larger than the reserved space, all written data has
+     * to be moved, which is slow for large files. A header needs roughly 100 bytes per array.
      */
-    explicit UnstructuredGrid(std::unique_ptr<internal::GridData> &&gridData);
+    std::uint32_t headerReserve = 16384;
 
     /**
-     * @brief Destructor for the UnstructuredGrid class.
+     * @brief Writes the size fields of all arrays with 64 bits.
      *
-     * Cleans up any resources associated with the UnstructuredGrid object.
+     * The header type of a file applies to all of its arrays, but a streaming grid writes an array before the next one
+     * is known. Hence, the 64 bit header type is not chosen automatically and has to be requested if an uncompressed
+     * array of 4 GiB or more is added.
      */
-    ~UnstructuredGrid();
+    bool uint64Headers = false;
+};
+}  // namespace tinyvtu::streaming
 
+namespace tinyvtu::async {
+/**
+ * @brief Represents the settings of an asynchronous writer.
+ */
+struct Info
+{
     /**
-     * @brief Adds point data to the unstructured grid.
+     * @brief Defines the maximal number of writes in flight.
      *
-     * This method allows adding point-associated data to the unstructured grid. The data is specified
-     * by its name, the actual data points, and the number of components per point.
+     * A write is in flight from its submission until its file is complete. Submitting a write blocks while the maximum
+     * is reached, which bounds the memory held by grids waiting to be written. The default of 2 double-buffers the
+     * output: one grid is written while the next one is prepared.
+     */
+    std::uint32_t maxInFlight = 2;
+
+    /**
+     * @brief Specifies the number of threads preparing and writing grids.
      *
-     * @param name The name of the point data.
-     * @param pointData A vector containing the data points.
-     * @param numberOfComponents The number of components for each point.
+     * A value of 0 uses all hardware threads.
      */
-    template <class T>
-    requires std::is_arithmetic_v<T>
-    void addPointData(const std::string &name, const std::vector<T> &pointData, std::uint32_t numberOfComponents = 1);
+    std::uint32_t threads = 1;
 
     /**
-     * @brief Adds cell data to the unstructured grid.
+     * @brief Limits the average rate, in bytes per second, each file is written with.
      *
-     * This method allows adding data associated with the cells of the unstructured grid.
-     * The data should be passed as a vector and the type of the data should be an arithmetic type.
+     * Throttling the output leaves I/O bandwidth to the simulation, e.g. on a shared file system. A value of 0 does not
+     * limit the rate.
+     */
+    std::uint64_t bandwidth = 0;
+};
+}  // namespace tinyvtu::async
+
+namespace tinyvtu::reading {
+/**
+ * @brief Represents the settings of reading a file.
+ */
+struct Info
+{
+    /**
+     * @brief Specifies the names of the point and cell data arrays to read.
      *
-     * @tparam T The type of the data, must be an arithmetic type.
-     * @param name The name associated with the cell data.
-     * @param cellData A vector containing the cell data values.
-     * @param numberOfComponents The number of components each cell data point has.
+     * Arrays which are not selected are skipped without touching their bytes in the file. If empty, all arrays are
+     * read.
      */
-    template <class T>
-    requires std::is_arithmetic_v<T>
-    void addCellData(const std::string &name, const std::vector<T> &cellData, std::uint32_t numberOfComponents = 1);
+    std::vector<std::string> arrays;
+
+    /**
+     * @brief Specifies whether the points and cells, or the coordinates of a rectilinear grid, are read.
+     */
+    bool topology = true;
 
     /**
-     * @brief Writes the unstructured grid to a file.
+     * @brief Specifies the number of threads decompressing the blocks of the arrays.
      *
-     * This method writes the unstructured grid data to the specified file path in VTU (VTK Unstructured Grid)
-     * format.
+     * A value of 0 uses all hardware threads.
+     */
+    std::uint32_t threads = 0;
+};
+}  // namespace tinyvtu::reading
+
+namespace tinyvtu::statistics {
+/**
+ * @brief Represents where the time and memory of writing one array went.
+ *
+ * Times are given in seconds. Start times are relative to the start of the trace, which is the earliest compression
+ * or the start of the write, whichever comes first.
+ */
+struct Array
+{
+    /**
+     * @brief Names the array, the arrays of the topology are named points, connectivity, offsets, and types.
+     */
+    std::string name;
+
+    /**
+     * @brief Specifies the size of the array before compression, after a reduction of its precision.
+     */
+    std::uint64_t rawBytes = 0;
+
+    /**
+     * @brief Specifies the size of the array in the appended section, including its header.
+     */
+    std::uint64_t compressedBytes = 0;
+
+    /**
+     * @brief Specifies the number of compression blocks, 0 if the array is not compressed.
+     */
+    std::uint32_t blocks = 0;
+
+    /**
+     * @brief Specifies when the array was compressed, or copied if compression is inactive.
      *
-     * @param file_path The file path where the grid data will be written.
+     * Arrays are compressed when they are added to a grid, i.e. by createGrid, addPointData, and addCellData.
      */
-    void write(const std::filesystem::path &file_path) const;
+    double compressionStart = 0;
+    double compressionSeconds = 0;
 
-private:
-    std::unique_ptr<internal::GridData> grid_data_;
+    /**
+     * @brief Specifies when the array was handed to the file or sink.
+     */
+    double ioStart = 0;
+    double ioSeconds = 0;
 };
 
 /**
- * @brief Creates an unstructured grid from given points, cell type, and cells.
+ * @brief Represents the statistics of writing a grid.
  *
- * This function constructs an UnstructuredGrid object using the provided points, cell
- * type, and cells with specified compression information.
+ * Passing statistics to a write makes it hand every array to the file separately, so the time of each array can be
+ * measured. This costs one system call per array, the file itself does not change.
+ */
+struct Info
+{
+    /**
+     * @brief Lists the arrays in the order they are stored in the file.
+     */
+    std::vector<Array> arrays;
+
+    /**
+     * @brief Specifies the peak number of bytes the grid and the writer held in memory while writing.
+     *
+     * These are the compressed arrays, the rendered XML, and headers widened to 64 bits. Referenced arrays, see
+     * UnstructuredGrid::addPointData, are owned by the caller and not included.
+     */
+    std::uint64_t peakMemory = 0;
+
+    /**
+     * @brief Specifies when the write started and how long it took, including all I/O.
+     */
+    double writeStart = 0;
+    double writeSeconds = 0;
+
+    /**
+     * @brief Writes the compression and I/O spans as a Chrome trace, which Perfetto and chrome://tracing load.
+     *
+     * @param stream The stream receiving the JSON trace.
+     */
+    void writeTrace(std::ostream &stream) const;
+
+    /**
+     * @brief Writes the compression and I/O spans as a Chrome trace to a file.
+     *
+     * @param file_path The path of the JSON file.
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void writeTrace(const std::filesystem::path &file_path) const;
+};
+}  // namespace tinyvtu::statistics
+
+namespace tinyvtu {
+/**
+ * @brief Receives the bytes of a written grid.
  *
- * @pre points vector must not be empty and must be smaller than 2^32-1 elements
- * @pre cells vector must not be empty and must be smaller than 2^32-1 elements
- * @pre All indices in cells must be valid indices into the points vector
- * @pre Number of vertices in each cell must match the requirements for the specified cell type
+ * Instead of a file, a grid can be written to a sink, e.g. to hand it to an in-situ pipeline, hash it, or send it over
+ * a pipe. The bytes arrive in order as chunks which reference the XML buffer and the compressed arrays of the grid,
+ * they are not copied for the sink.
+ */
+class Sink
+{
+public:
+    virtual ~Sink() = default;
+
+    /**
+     * @brief Receives the next chunks of the output.
+     *
+     * The chunks are only valid during the call.
+     *
+     * @param chunks The chunks in the order they appear in the output.
+     * @throws std::runtime_error if the chunks cannot be written, the error is passed to the caller of write()
+     */
+    virtual void write(std::span<const std::span<const std::uint8_t> > chunks) = 0;
+};
+
+/**
+ * @brief Appends the output to a contiguous buffer like std::vector<std::uint8_t>.
  *
- * @param points A vector containing arrays of 3D points.
- * @param cellType Enum representing the type of cell to create.
- * @param cells A vector of vectors containing cell connectivity information.
- * @param compression Structure holding the compression information.
- * @return An UnstructuredGrid object constructed from the provided data.
- * @throws std::invalid_argument if preconditions are not met
+ * @tparam Buffer A container of std::uint8_t with reserve and insert, e.g. std::pmr::vector<std::uint8_t>.
  */
-UnstructuredGrid createGrid(const std::vector<std::array<float, 3> > &points, CellType cellType,
-                            const std::vector<std::vector<std::int32_t> > &cells,
-                            compression::Info compression = compression::zlib);
+template <class Buffer>
+class BufferSink final : public Sink
+{
+public:
+    /**
+     * @brief Constructs a BufferSink object appending to the buffer, which must outlive it.
+     */
+    explicit BufferSink(Buffer &buffer) : buffer_(buffer) {}
+
+    void write(std::span<const std::span<const std::uint8_t> > chunks) override
+    {
+        auto size = buffer_.size();
+        for (const auto &chunk : chunks) size += chunk.size();
+        // Grow geometrically, as a sink receives many small writes
+        if (size > buffer_.capacity()) buffer_.reserve(std::max(size, 2 * buffer_.capacity()));
+        for (const auto &chunk : chunks) buffer_.insert(buffer_.end(), chunk.begin(), chunk.end());
+    }
+
+private:
+    Buffer &buffer_;
+};
+
+/**
+ * @brief Appends the output to a std::vector<std::uint8_t>.
+ */
+using VectorSink = BufferSink<std::vector<std::uint8_t> >;
+
+/**
+ * @brief Appends the output to a std::pmr::vector<std::uint8_t>, e.g. backed by a monotonic buffer resource.
+ */
+using PmrVectorSink = BufferSink<std::pmr::vector<std::uint8_t> >;
 
 /**
- * @brief Writes an unstructured grid to a specified file path.
+ * @brief Writes the output to a file descriptor, e.g. a pipe or socket, with gathered writes.
  *
- * This is a convenience wrapper around UnstructuredGrid::write that allows writing a grid without calling the
- * member function directly.
+ * The file descriptor is not owned by the sink and stays open.
+ */
+class FileDescriptorSink final : public Sink
+{
+public:
+    /**
+     * @brief Constructs a FileDescriptorSink object writing to the file descriptor.
+     *
+     * @param fileDescriptor An open file descriptor.
+     */
+    explicit FileDescriptorSink(int fileDescriptor);
+
+    /**
+     * @throws std::runtime_error if writing to the file descriptor failed
+     */
+    void write(std::span<const std::span<const std::uint8_t> > chunks) override;
+
+private:
+    int file_descriptor_;
+};
+
+/**
+ * @brief Passes every chunk of the output to a callback.
  *
- * @param grid The unstructured grid containing the data to be written.
- * @param file_path The file path where the grid data will be written.
- * @see UnstructuredGrid::write
+ * The callback receives the chunks in order without copying them, they are only valid during the call.
+ */
+class CallbackSink final : public Sink
+{
+public:
+    /**
+     * @brief Constructs a CallbackSink object.
+     *
+     * @param callback The function receiving the chunks, exceptions it throws are passed to the caller of write().
+     */
+    explicit CallbackSink(std::function<void(std::span<const std::uint8_t>)> callback) : callback_(std::move(callback))
+    {}
+
+    void write(std::span<const std::span<const std::uint8_t> > chunks) override
+    {
+        for (const auto &chunk : chunks) callback_(chunk);
+    }
+
+private:
+    std::function<void(std::span<const std::uint8_t>)> callback_;
+};
+
+/**
+ * @brief Enumerates different cell types used in grid structures.
+ *
+ * Represents the various types of cells that can be used in a grid for data structures, enabling a wide range of
+ * geometric representations. These must be consistent with the vtk definitions.
+ * @see https://vtk.org/doc/nightly/html/vtkCellType_8h.html
+ */
+enum class CellType : std::uint8_t
+{
+    Vertex = 1,
+    PolyVertex = 2,
+    Line = 3,
+    PolyLine = 4,
+    Triangle = 5,
+    TriangleStrip = 6,
+    Polygon = 7,
+    Pixel = 8,
+    Quad = 9,
+    Tetra = 10,
+    Voxel = 11,
+    Hexahedron = 12,
+    Wedge = 13,
+    Pyramid = 14
+};
+
+/**
+ * @brief A view of tuples spaced by a fixed number of bytes, e.g. a member of an array of structs.
+ *
+ * The components of a tuple are contiguous, tuple i starts at data plus i times stride bytes. For a member
+ * `double velocity[3]` of `struct Node`, data points to nodes[0].velocity, stride is sizeof(Node), and
+ * numberOfComponents is 3.
+ *
+ * @tparam T The type of the components, must be an arithmetic type.
+ */
+template <class T>
+requires std::is_arithmetic_v<T>
+struct StridedView
+{
+    const T *data = nullptr;
+    std::size_t size = 0;             ///< The number of tuples
+    std::size_t stride = sizeof(T);   ///< The distance of consecutive tuples in bytes
+    std::uint32_t numberOfComponents = 1;
+};
+
+/**
+ * @brief A view of the components of tuples stored in separate arrays, e.g. vx, vy, and vz.
+ *
+ * Tuple i consists of components[c][i] for every c, the arrays are interleaved when the data is written.
+ *
+ * @tparam T The type of the components, must be an arithmetic type.
+ */
+template <class T>
+requires std::is_arithmetic_v<T>
+struct ComponentsView
+{
+    std::vector<const T *> components;
+    std::size_t size = 0;  ///< The number of tuples, i.e. the size of each array
+};
+
+/**
+ * @brief A callable returning value i of an array for an index i, e.g. a field derived from other fields.
+ */
+template <class Function>
+concept ValueFunction =
+    std::is_invocable_v<const Function &, std::uint64_t> &&
+    std::is_arithmetic_v<std::remove_cvref_t<std::invoke_result_t<const Function &, std::uint64_t> > >;
+
+/**
+ * @brief A lazily evaluated random access range of values, e.g. a std::views::transform of other fields.
+ *
+ * Contiguous ranges like std::vector are passed as arrays instead.
+ */
+template <class Range>
+concept ValueRange = std::ranges::random_access_range<const Range> && std::ranges::sized_range<const Range> &&
+                     !std::ranges::contiguous_range<const Range> &&
+                     std::is_arithmetic_v<std::ranges::range_value_t<const Range> >;
+
+/**
+ * @brief The point and cell data of a grid, the base of all grid types.
+ *
+ * A grid holds its points and cells, which are given when it is created, and the arrays added with addPointData and
+ * addCellData. The grid types only differ in how the points and cells are described, see UnstructuredGrid, ImageData,
+ * RectilinearGrid, and StructuredGrid.
+ */
+class GridBase
+{
+public:
+    /**
+     * @brief Adds point data to the grid.
+     *
+     * This method allows adding point-associated data to the grid. The data is specified
+     * by its name, the actual data points, and the number of components per point.
+     *
+     * @param name The name of the point data.
+     * @param pointData A vector containing the data points.
+     * @param numberOfComponents The number of components for each point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const std::vector<T> &pointData, std::uint32_t numberOfComponents = 1,
+                      std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addData<false, T>(name, pointData, numberOfComponents, false, compression, precision);
+    }
+
+    /**
+     * @brief Adds point data to the grid without copying it.
+     *
+     * The data is passed to the compressor straight from the caller's memory. If the grid is not compressed, the data
+     * is referenced instead of copied and must stay valid until the grid is written.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A view of the data points.
+     * @param numberOfComponents The number of components for each point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, std::span<const T> pointData, std::uint32_t numberOfComponents = 1,
+                      std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addData<false, T>(name, pointData, numberOfComponents, true, compression, precision);
+    }
+
+    /**
+     * @brief Adds point data to the grid without copying it.
+     *
+     * @see addPointData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A pointer to the data points.
+     * @param size The number of values, i.e. the number of points times the number of components.
+     * @param numberOfComponents The number of components for each point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const T *pointData, std::size_t size,
+                      std::uint32_t numberOfComponents = 1,
+                      std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addPointData(name, std::span<const T>(pointData, size), numberOfComponents, compression, precision);
+    }
+
+    /**
+     * @brief Adds point data gathered from tuples spaced by a stride, e.g. a member of an array of structs.
+     *
+     * The tuples are interleaved one compression block at a time, the array is never copied as a whole unless the
+     * grid is uncompressed or defers compression. The data is no longer referenced once this method returns.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A view of one tuple per point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const StridedView<T> &pointData,
+                      std::optional<compression::Info> compression = {})
+    {
+        addGathered<false, T>(name, stridedComponents(pointData), pointData.size, pointData.stride, compression);
+    }
+
+    /**
+     * @brief Adds point data interleaved from one array per component, e.g. vx, vy, and vz.
+     *
+     * @see addPointData(const std::string &, const StridedView<T> &, std::optional<compression::Info>)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A view of the component arrays, each holding one value per point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const ComponentsView<T> &pointData,
+                      std::optional<compression::Info> compression = {})
+    {
+        addGathered<false, T>(name, pointData.components, pointData.size, sizeof(T), compression);
+    }
+
+    /**
+     * @brief Adds point data computed from the index of each value, e.g. a field derived from other fields.
+     *
+     * value(i) returns value i of the array, i.e. component i % numberOfComponents of point i / numberOfComponents. It
+     * is evaluated one compression block at a time within this call, interleaved with compressing the blocks, hence the
+     * array is never held as a whole unless the grid is uncompressed or defers compression. With several compression
+     * threads, value is called concurrently and must be safe to call from several threads.
+     *
+     * @tparam Function A callable returning an arithmetic value for an index, its type is the type of the data.
+     * @param name The name of the point data.
+     * @param value The callable computing the values.
+     * @param numberOfComponents The number of components for each point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <ValueFunction Function>
+    void addPointData(const std::string &name, const Function &value, std::uint32_t numberOfComponents = 1,
+                      std::optional<compression::Info> compression = {})
+    {
+        using T = std::remove_cvref_t<std::invoke_result_t<const Function &, std::uint64_t> >;
+        addGenerated<false, T>(name, std::nullopt, numberOfComponents, functionFill<T>(value), compression);
+    }
+
+    /**
+     * @brief Adds point data evaluated lazily from a range, e.g. a std::views::transform of other fields.
+     *
+     * @see addPointData(const std::string &, const Function &, std::uint32_t, std::optional<compression::Info>)
+     *
+     * @tparam Range A random access range of arithmetic values, its value type is the type of the data.
+     * @param name The name of the point data.
+     * @param values The range of the values, i.e. the number of points times the number of components.
+     * @param numberOfComponents The number of components for each point.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <ValueRange Range>
+    void addPointData(const std::string &name, const Range &values, std::uint32_t numberOfComponents = 1,
+                      std::optional<compression::Info> compression = {})
+    {
+        using T = std::ranges::range_value_t<const Range>;
+        addGenerated<false, T>(name, std::ranges::size(values), numberOfComponents, rangeFill<T>(values), compression);
+    }
+
+    /**
+     * @brief Adds cell data to the grid.
+     *
+     * This method allows adding data associated with the cells of the grid.
+     * The data should be passed as a vector and the type of the data should be an arithmetic type.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A vector containing the cell data values.
+     * @param numberOfComponents The number of components each cell data point has.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const std::vector<T> &cellData, std::uint32_t numberOfComponents = 1,
+                     std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addData<true, T>(name, cellData, numberOfComponents, false, compression, precision);
+    }
+
+    /**
+     * @brief Adds cell data to the grid without copying it.
+     *
+     * The data is passed to the compressor straight from the caller's memory. If the grid is not compressed, the data
+     * is referenced instead of copied and must stay valid until the grid is written.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A view of the cell data values.
+     * @param numberOfComponents The number of components each cell data point has.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, std::span<const T> cellData, std::uint32_t numberOfComponents = 1,
+                     std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addData<true, T>(name, cellData, numberOfComponents, true, compression, precision);
+    }
+
+    /**
+     * @brief Adds cell data to the grid without copying it.
+     *
+     * @see addCellData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A pointer to the cell data values.
+     * @param size The number of values, i.e. the number of cells times the number of components.
+     * @param numberOfComponents The number of components each cell data point has.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     * @param precision The precision the data is written with, e.g. fewer significant bits or a narrower type.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const T *cellData, std::size_t size, std::uint32_t numberOfComponents = 1,
+                     std::optional<compression::Info> compression = {}, precision::Info precision = {})
+    {
+        addCellData(name, std::span<const T>(cellData, size), numberOfComponents, compression, precision);
+    }
+
+    /**
+     * @brief Adds cell data gathered from tuples spaced by a stride, e.g. a member of an array of structs.
+     *
+     * @see addPointData(const std::string &, const StridedView<T> &, std::optional<compression::Info>)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A view of one tuple per cell.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const StridedView<T> &cellData,
+                     std::optional<compression::Info> compression = {})
+    {
+        addGathered<true, T>(name, stridedComponents(cellData), cellData.size, cellData.stride, compression);
+    }
+
+    /**
+     * @brief Adds cell data interleaved from one array per component.
+     *
+     * @see addPointData(const std::string &, const StridedView<T> &, std::optional<compression::Info>)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A view of the component arrays, each holding one value per cell.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const ComponentsView<T> &cellData,
+                     std::optional<compression::Info> compression = {})
+    {
+        addGathered<true, T>(name, cellData.components, cellData.size, sizeof(T), compression);
+    }
+
+    /**
+     * @brief Adds cell data computed from the index of each value, e.g. the rank owning each cell.
+     *
+     * @see addPointData(const std::string &, const Function &, std::uint32_t, std::optional<compression::Info>)
+     *
+     * @tparam Function A callable returning an arithmetic value for an index, its type is the type of the data.
+     * @param name The name associated with the cell data.
+     * @param value The callable computing the values.
+     * @param numberOfComponents The number of components each cell data point has.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <ValueFunction Function>
+    void addCellData(const std::string &name, const Function &value, std::uint32_t numberOfComponents = 1,
+                     std::optional<compression::Info> compression = {})
+    {
+        using T = std::remove_cvref_t<std::invoke_result_t<const Function &, std::uint64_t> >;
+        addGenerated<true, T>(name, std::nullopt, numberOfComponents, functionFill<T>(value), compression);
+    }
+
+    /**
+     * @brief Adds cell data evaluated lazily from a range, e.g. a std::views::transform of other fields.
+     *
+     * @see addPointData(const std::string &, const Function &, std::uint32_t, std::optional<compression::Info>)
+     *
+     * @tparam Range A random access range of arithmetic values, its value type is the type of the data.
+     * @param name The name associated with the cell data.
+     * @param values The range of the values, i.e. the number of cells times the number of components.
+     * @param numberOfComponents The number of components each cell data point has.
+     * @param compression Overrides the compression settings of the grid for this array, e.g. a lower level. Only
+     *                    the activity and codec have to match the grid, as the file declares one compressor.
+     */
+    template <ValueRange Range>
+    void addCellData(const std::string &name, const Range &values, std::uint32_t numberOfComponents = 1,
+                     std::optional<compression::Info> compression = {})
+    {
+        using T = std::ranges::range_value_t<const Range>;
+        addGenerated<true, T>(name, std::ranges::size(values), numberOfComponents, rangeFill<T>(values), compression);
+    }
+
+    /**
+     * @brief Writes the grid to a file.
+     *
+     * This method writes the grid data to the specified file path in the VTK XML format of its type, e.g. VTU (VTK
+     * Unstructured Grid) for an UnstructuredGrid or VTI (VTK Image Data) for an ImageData.
+     *
+     * @param file_path The file path where the grid data will be written.
+     * @param statistics If not null, receives the sizes and times of all arrays, see statistics::Info.
+     */
+    void write(const std::filesystem::path &file_path, statistics::Info *statistics = nullptr) const;
+
+    /**
+     * @brief Writes the grid to a sink.
+     *
+     * The sink receives the same bytes a file written with write(const std::filesystem::path &) would contain.
+     *
+     * @param sink The sink receiving the output.
+     * @param statistics If not null, receives the sizes and times of all arrays, see statistics::Info.
+     */
+    void write(Sink &sink, statistics::Info *statistics = nullptr) const;
+
+protected:
+    /**
+     * @brief Constructs a GridBase object.
+     *
+     * Initializes the grid with the provided grid data, transferring ownership of the data.
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     */
+    explicit GridBase(std::unique_ptr<internal::GridData> &&gridData);
+
+    ~GridBase();
+
+    GridBase(GridBase &&) noexcept;
+
+    GridBase &operator=(GridBase &&) noexcept;
+
+    std::unique_ptr<internal::GridData> grid_data_;
+
+private:
+    template <bool isCellData, class T>
+    requires std::is_arithmetic_v<T>
+    void addData(const std::string &name, std::span<const T> data, std::uint32_t numberOfComponents, bool reference,
+                 const std::optional<compression::Info> &compression, const precision::Info &precision);
+
+    /**
+     * Adds an array whose component c of tuple i is at components[c] plus i times stride bytes.
+     */
+    template <bool isCellData, class T>
+    requires std::is_arithmetic_v<T>
+    void addGathered(const std::string &name, std::span<const T *const> components, std::size_t size,
+                     std::size_t stride, const std::optional<compression::Info> &compression);
+
+    /**
+     * Writes count values of type T, starting at value first, to an unaligned destination.
+     */
+    using Fill = std::function<void(std::uint64_t first, std::uint64_t count, std::uint8_t *destination)>;
+
+    /**
+     * Adds an array filled one compression block at a time while this method runs. If size is set, it is the number of
+     * values, which has to match the grid.
+     */
+    template <bool isCellData, class T>
+    requires std::is_arithmetic_v<T>
+    void addGenerated(const std::string &name, std::optional<std::uint64_t> size, std::uint32_t numberOfComponents,
+                      const Fill &fill, const std::optional<compression::Info> &compression);
+
+    template <class T, class Function>
+    static Fill functionFill(const Function &value)
+    {
+        // The fill is only called while the array is added, hence the callable is referenced
+        return [&value](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+        {
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                const T element = value(first + i);
+                std::memcpy(destination + i * sizeof(T), &element, sizeof(T));
+            }
+        };
+    }
+
+    template <class T, class Range>
+    static Fill rangeFill(const Range &values)
+    {
+        return [&values](std::uint64_t first, std::uint64_t count, std::uint8_t *destination)
+        {
+            auto it = std::ranges::begin(values) + static_cast<std::ranges::range_difference_t<const Range> >(first);
+            for (std::uint64_t i = 0; i < count; ++i, ++it)
+            {
+                const T element = *it;
+                std::memcpy(destination + i * sizeof(T), &element, sizeof(T));
+            }
+        };
+    }
+
+    template <class T>
+    static std::vector<const T *> stridedComponents(const StridedView<T> &view)
+    {
+        std::vector<const T *> components;
+        for (std::uint32_t c = 0; c < view.numberOfComponents; ++c) components.push_back(view.data + c);
+        return components;
+    }
+};
+
+/**
+ * @brief Represents an unstructured grid that can hold and manage various types of grid data.
+ *
+ * The UnstructuredGrid class is used for handling unstructured grid data, allowing users to add point and cell data
+ * of different types and write the grid to a file.
+ *
+ * To create an UnstructuredGrid, use the @see tinyvtu::createGrid() function
+ */
+class UnstructuredGrid final : public GridBase
+{
+public:
+    /**
+     * @brief Constructs an UnstructuredGrid object.
+     *
+     * Initializes the UnstructuredGrid with the provided grid data, transferring ownership of the data. Use
+     * `createGrid` instead of calling it directly
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     *                 The ownership of gridData is moved to the constructed UnstructuredGrid object.
+     */
+    explicit UnstructuredGrid(std::unique_ptr<internal::GridData> &&gridData);
+
+    /**
+     * @brief Writes a parallel file (.pvtu) referencing pieces of a partitioned grid.
+     *
+     * The parallel file declares the arrays of this grid, all pieces must hold the same arrays. The pieces are expected
+     * at piecePath(file_path, i) for i in [0, pieceCount) and are written independently, e.g. one per process. Use
+     * writePartitioned if all pieces are available in one process.
+     *
+     * @param file_path The file path where the parallel file will be written.
+     * @param pieceCount The number of pieces.
+     */
+    void writePVTU(const std::filesystem::path &file_path, std::uint32_t pieceCount) const;
+
+private:
+    friend void writePartitioned(std::span<const UnstructuredGrid> pieces, const std::filesystem::path &file_path,
+                                 std::uint32_t threads);
+
+    friend class AsyncWriter;
+};
+
+/**
+ * @brief Represents an image, a grid of equally spaced points along the axes, written as VTI (VTK Image Data).
+ *
+ * Neither the points nor the cells are written, they follow from the dimensions, origin, and spacing. Point and cell
+ * data is ordered with x varying fastest, then y, then z.
+ *
+ * To create an ImageData, use the @see tinyvtu::createImageData() function
+ */
+class ImageData final : public GridBase
+{
+public:
+    /**
+     * @brief Constructs an ImageData object, use `createImageData` instead of calling it directly.
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     */
+    explicit ImageData(std::unique_ptr<internal::GridData> &&gridData);
+};
+
+/**
+ * @brief Represents a rectilinear grid, whose points lie on the product of coordinates along the axes, written as VTR
+ * (VTK Rectilinear Grid).
+ *
+ * Only the coordinates along each axis are written, the points and cells follow from them. Point and cell data is
+ * ordered with x varying fastest, then y, then z.
+ *
+ * To create a RectilinearGrid, use the @see tinyvtu::createRectilinearGrid() function
+ */
+class RectilinearGrid final : public GridBase
+{
+public:
+    /**
+     * @brief Constructs a RectilinearGrid object, use `createRectilinearGrid` instead of calling it directly.
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     */
+    explicit RectilinearGrid(std::unique_ptr<internal::GridData> &&gridData);
+};
+
+/**
+ * @brief Represents a curvilinear grid, whose points are given explicitly but whose cells follow from the dimensions,
+ * written as VTS (VTK Structured Grid).
+ *
+ * The points, and the point and cell data, are ordered with x varying fastest, then y, then z. No connectivity,
+ * offsets, or types are written.
+ *
+ * To create a StructuredGrid, use the @see tinyvtu::createStructuredGrid() function
+ */
+class StructuredGrid final : public GridBase
+{
+public:
+    /**
+     * @brief Constructs a StructuredGrid object, use `createStructuredGrid` instead of calling it directly.
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     */
+    explicit StructuredGrid(std::unique_ptr<internal::GridData> &&gridData);
+};
+
+/**
+ * @brief Represents points with optional vertices, lines, and polygons, written as VTP (VTK PolyData).
+ *
+ * Point clouds, e.g. particles, are written without any cells, or with vertices which are generated while they are
+ * compressed. The cells are numbered vertices first, then lines, then polygons, which is the order of the cell data.
+ *
+ * To create a PolyData, use the @see tinyvtu::createPolyData() function
+ */
+class PolyData final : public GridBase
+{
+public:
+    /**
+     * @brief Constructs a PolyData object, use `createPolyData` instead of calling it directly.
+     *
+     * @param gridData A unique pointer to the internal GridData object containing the grid's data.
+     */
+    explicit PolyData(std::unique_ptr<internal::GridData> &&gridData);
+};
+
+/**
+ * @brief Represents an unstructured grid that is written to its file while it is created.
+ *
+ * Contrary to UnstructuredGrid, every array is compressed and written as soon as it is added and is not kept in memory.
+ * Compression of an array overlaps with writing the previous one. The file is complete once close() is called.
+ *
+ * To create a StreamingGrid, use the @see tinyvtu::createStreamingGrid() function
+ */
+class StreamingGrid final
+{
+public:
+    /**
+     * @brief Constructs a StreamingGrid object.
+     *
+     * Use `createStreamingGrid` instead of calling it directly
+     *
+     * @param gridStream A unique pointer to the internal GridStream object writing the grid's data.
+     */
+    explicit StreamingGrid(std::unique_ptr<internal::GridStream> &&gridStream);
+
+    /**
+     * @brief Destructor for the StreamingGrid class.
+     *
+     * Closes the grid if close() has not been called. Errors are ignored, call close() to observe them.
+     */
+    ~StreamingGrid();
+
+    /**
+     * @brief Adds point data to the grid and writes it to the file.
+     *
+     * The data is passed to the compressor, or to the file if the grid is not compressed, straight from the caller's
+     * memory. It is no longer referenced once this method returns.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A view of the data points.
+     * @param numberOfComponents The number of components for each point.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, std::span<const T> pointData, std::uint32_t numberOfComponents = 1)
+    {
+        addData<false, T>(name, pointData, numberOfComponents);
+    }
+
+    /**
+     * @brief Adds point data to the grid and writes it to the file.
+     *
+     * @see addPointData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A vector containing the data points.
+     * @param numberOfComponents The number of components for each point.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const std::vector<T> &pointData, std::uint32_t numberOfComponents = 1)
+    {
+        addData<false, T>(name, pointData, numberOfComponents);
+    }
+
+    /**
+     * @brief Adds point data to the grid and writes it to the file.
+     *
+     * @see addPointData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name of the point data.
+     * @param pointData A pointer to the data points.
+     * @param size The number of values, i.e. the number of points times the number of components.
+     * @param numberOfComponents The number of components for each point.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addPointData(const std::string &name, const T *pointData, std::size_t size,
+                      std::uint32_t numberOfComponents = 1)
+    {
+        addData<false, T>(name, std::span<const T>(pointData, size), numberOfComponents);
+    }
+
+    /**
+     * @brief Adds cell data to the grid and writes it to the file.
+     *
+     * The data is passed to the compressor, or to the file if the grid is not compressed, straight from the caller's
+     * memory. It is no longer referenced once this method returns.
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A view of the cell data values.
+     * @param numberOfComponents The number of components each cell data point has.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, std::span<const T> cellData, std::uint32_t numberOfComponents = 1)
+    {
+        addData<true, T>(name, cellData, numberOfComponents);
+    }
+
+    /**
+     * @brief Adds cell data to the grid and writes it to the file.
+     *
+     * @see addCellData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A vector containing the cell data values.
+     * @param numberOfComponents The number of components each cell data point has.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const std::vector<T> &cellData, std::uint32_t numberOfComponents = 1)
+    {
+        addData<true, T>(name, cellData, numberOfComponents);
+    }
+
+    /**
+     * @brief Adds cell data to the grid and writes it to the file.
+     *
+     * @see addCellData(const std::string &, std::span<const T>, std::uint32_t)
+     *
+     * @tparam T The type of the data, must be an arithmetic type.
+     * @param name The name associated with the cell data.
+     * @param cellData A pointer to the cell data values.
+     * @param size The number of values, i.e. the number of cells times the number of components.
+     * @param numberOfComponents The number of components each cell data point has.
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    void addCellData(const std::string &name, const T *cellData, std::size_t size, std::uint32_t numberOfComponents = 1)
+    {
+        addData<true, T>(name, std::span<const T>(cellData, size), numberOfComponents);
+    }
+
+    /**
+     * @brief Finishes the file.
+     *
+     * Waits until all data is written and writes the XML header. No data can be added afterward.
+     *
+     * @throws std::runtime_error if writing to the file failed
+     */
+    void close();
+
+private:
+    template <bool isCellData, class T>
+    requires std::is_arithmetic_v<T>
+    void addData(const std::string &name, std::span<const T> data, std::uint32_t numberOfComponents);
+
+    std::unique_ptr<internal::GridStream> grid_stream_;
+};
+
+/**
+ * @brief Writes unstructured grids on background threads.
+ *
+ * Writing a grid returns immediately with a future, so the output of a timestep overlaps with computing the next one.
+ * The number of writes in flight is bounded, see async::Info::maxInFlight.
+ *
+ * Arrays added to an UnstructuredGrid are compressed by addPointData and addCellData. To move the compression to the
+ * background as well, pass a function creating the grid instead of the grid.
+ */
+class AsyncWriter final
+{
+public:
+    /**
+     * @brief Constructs an AsyncWriter object and starts its threads.
+     *
+     * @param info Structure holding the number of writes in flight, threads, and bandwidth limit.
+     */
+    explicit AsyncWriter(async::Info info = {});
+
+    /**
+     * @brief Destructor for the AsyncWriter class.
+     *
+     * Waits until all submitted writes have finished.
+     */
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter &) = delete;
+
+    AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+    /**
+     * @brief Writes a grid to a file in the background.
+     *
+     * The writer takes ownership of the grid. Data added to it as span or pointer without compression is referenced
+     * and must stay valid until the returned future is ready.
+     *
+     * @param grid The grid to write.
+     * @param file_path The file path where the grid will be written.
+     * @return A future which becomes ready once the file is written and rethrows errors of the write.
+     */
+    std::future<void> write(UnstructuredGrid &&grid, const std::filesystem::path &file_path);
+
+    /**
+     * @brief Creates a grid and writes it to a file in the background.
+     *
+     * Creating the grid, including the compression of its arrays, runs on a background thread. The function has to
+     * capture all data it needs by value, i.e. it snapshots the data.
+     *
+     * @param createGrid A function creating the grid to write.
+     * @param file_path The file path where the grid will be written.
+     * @return A future which becomes ready once the file is written and rethrows errors of createGrid and the write.
+     */
+    std::future<void> write(std::function<UnstructuredGrid()> createGrid, const std::filesystem::path &file_path);
+
+    /**
+     * @brief Blocks until all submitted writes have finished.
+     */
+    void wait();
+
+private:
+    const async::Info info_;
+    std::unique_ptr<internal::WriteQueue> queue_;
+};
+
+/**
+ * @brief Represents a series of unstructured grids with the same points and cells, e.g. the timesteps of a simulation.
+ *
+ * The points and cells are compressed once when the series is created, every step reuses the compressed bytes. Hence,
+ * writing a step only compresses its point and cell data. The steps are listed with their time values in a collection
+ * file (.pvd), which is rewritten after every step and thus stays valid if the simulation stops early.
+ *
+ * To create a TimeSeries, use the @see tinyvtu::createTimeSeries() function
+ */
+class TimeSeries final
+{
+public:
+    /**
+     * @brief Constructs a TimeSeries object.
+     *
+     * Use `createTimeSeries` instead of calling it directly
+     *
+     * @param file_path The file path of the collection file.
+     * @param topology The compressed points and cells shared by all steps.
+     * @param compression The compression settings the topology was created with, also used for the steps.
+     */
+    TimeSeries(std::filesystem::path file_path, std::shared_ptr<const internal::Topology> topology,
+               compression::Info compression);
+
+    /**
+     * @brief Creates the grid of a step.
+     *
+     * The grid shares the compressed points and cells of the series, only the point and cell data added to it is
+     * compressed. A step can be written with write(const UnstructuredGrid &, double).
+     *
+     * @return An UnstructuredGrid object without point and cell data.
+     */
+    [[nodiscard]] UnstructuredGrid createStep() const;
+
+    /**
+     * @brief Writes a step and adds it to the collection file.
+     *
+     * The step is written next to the collection file and named after it, e.g. the third step of "out/flow.pvd" is
+     * written to "out/flow_2.vtu".
+     *
+     * @param step The grid of the step, usually created with createStep().
+     * @param time The time value of the step.
+     * @throws std::runtime_error if a file cannot be written
+     */
+    void write(const UnstructuredGrid &step, double time);
+
+    /**
+     * @brief Returns the number of steps written so far.
+     */
+    [[nodiscard]] std::size_t size() const { return times_.size(); }
+
+private:
+    std::filesystem::path file_path_;
+    std::shared_ptr<const internal::Topology> topology_;
+    compression::Info compression_;
+    std::vector<double> times_;
+};
+
+/**
+ * @brief Enumerates the types of the values of an array, named like the type attribute of a DataArray.
+ */
+enum class DataType : std::uint8_t
+{
+    Float32,
+    Float64,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64
+};
+
+/**
+ * @brief Represents an array read from a file.
+ */
+struct Array
+{
+    std::string name;
+    DataType type = DataType::Float32;
+    std::uint32_t numberOfComponents = 0;
+    /**
+     * The values, decompressed and in the byte order of the machine.
+     */
+    std::vector<std::uint8_t> bytes;
+
+    /**
+     * @brief Returns a view of the values.
+     *
+     * @tparam T The type of the values, must match type.
+     * @return A view of bytes as values of type T.
+     * @throws std::invalid_argument if T does not match type
+     */
+    template <class T>
+    requires std::is_arithmetic_v<T>
+    [[nodiscard]] std::span<const T> values() const;
+};
+
+/**
+ * @brief Represents the cells of a section of a PolyData read from a file, e.g. its lines.
+ */
+struct CellArrays
+{
+    Array connectivity;
+    Array offsets;
+};
+
+/**
+ * @brief Represents the contents of a grid file.
+ *
+ * Arrays which were not selected for reading are missing, see reading::Info. Arrays the grid type does not write,
+ * e.g. the cells of a structured grid, are empty.
+ */
+struct Dataset
+{
+    std::uint64_t numberOfPoints = 0;
+    std::uint64_t numberOfCells = 0;
+    /**
+     * The number of points along each axis of an image, rectilinear, or structured grid, all zero for unstructured
+     * grids.
+     */
+    std::array<std::uint64_t, 3> dimensions{};
+
+    Array points;
+    Array connectivity;
+    Array offsets;
+    Array types;
+    /**
+     * The coordinates along the x, y, and z axis of a rectilinear grid.
+     */
+    std::array<Array, 3> coordinates;
+    /**
+     * The cells of a PolyData, numberOfCells counts all of them.
+     */
+    CellArrays verts;
+    CellArrays lines;
+    CellArrays polys;
+
+    std::vector<Array> pointData;
+    std::vector<Array> cellData;
+
+    /**
+     * @brief Returns the point or cell data array of the given name.
+     *
+     * @param name The name of the array.
+     * @return A pointer to the array, or nullptr if there is no array of that name.
+     */
+    [[nodiscard]] const Array *find(const std::string &name) const;
+};
+
+/**
+ * @brief Creates an unstructured grid from given points, cell type, and cells.
+ *
+ * This function constructs an UnstructuredGrid object using the provided points, cell
+ * type, and cells with specified compression information.
+ *
+ * The offsets are written as Int64 if the connectivity has more than 2^31-1 entries. If an array or the whole appended
+ * data exceeds 4 GiB, the file is written with 64 bit size fields (header_type UInt64).
+ *
+ * @pre points vector must not be empty
+ * @pre cells vector must not be empty
+ * @pre All indices in cells must be valid indices into the points vector
+ * @pre Number of vertices in each cell must match the requirements for the specified cell type
+ *
+ * @param points A vector containing arrays of 3D points.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @return An UnstructuredGrid object constructed from the provided data.
+ */
+UnstructuredGrid createGrid(const std::vector<std::array<float, 3> > &points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates an unstructured grid from a view of points, cell type, and cells.
+ *
+ * The points are passed to the compressor straight from the caller's memory. If compression is inactive, the points
+ * are referenced instead of copied and must stay valid until the grid is written.
+ *
+ * @see createGrid(const std::vector<std::array<float, 3> > &, CellType,
+ *      const std::vector<std::vector<std::int32_t> > &, compression::Info)
+ *
+ * @param points A view of 3D points in single precision.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @return An UnstructuredGrid object constructed from the provided data.
+ */
+UnstructuredGrid createGrid(std::span<const std::array<float, 3> > points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates an unstructured grid from a view of points, cell type, and cells.
+ *
+ * The points are written in double precision. They are passed to the compressor straight from the caller's memory. If
+ * compression is inactive, the points are referenced instead of copied and must stay valid until the grid is written.
+ *
+ * @see createGrid(const std::vector<std::array<float, 3> > &, CellType,
+ *      const std::vector<std::vector<std::int32_t> > &, compression::Info)
+ *
+ * @param points A view of 3D points in double precision.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @return An UnstructuredGrid object constructed from the provided data.
+ */
+UnstructuredGrid createGrid(std::span<const std::array<double, 3> > points, CellType cellType,
+                            const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates an unstructured grid of mixed cell types from flat CSR arrays.
+ *
+ * The connectivity holds the point indices of all cells one after another. The offsets either hold the end of each
+ * cell in the connectivity (vtk convention, one entry per cell) or additionally start with a leading zero (CSR
+ * convention, one entry more than cells). The number of cells is given by the size of cellTypes.
+ *
+ * All arrays are passed to the compressor straight from the caller's memory, no array is flattened or copied. If
+ * compression is inactive, the arrays are referenced instead of copied and must stay valid until the grid is written.
+ *
+ * @pre All indices in connectivity must be valid indices into points
+ * @pre offsets must be non-decreasing and the number of vertices of each cell must match its type
+ *
+ * @tparam Index The integer type of the connectivity and offsets, written as is.
+ * @param points A view of 3D points in single precision.
+ * @param connectivity A view of the point indices of all cells.
+ * @param offsets A view of the offsets of the cells into connectivity.
+ * @param cellTypes A view of the type of each cell.
+ * @param compression Structure holding the compression information.
+ * @return An UnstructuredGrid object constructed from the provided data.
+ * @throws std::invalid_argument if the sizes of the arrays do not match
+ */
+template <class Index>
+requires std::is_integral_v<Index>
+UnstructuredGrid createGrid(std::span<const std::array<float, 3> > points, std::span<const Index> connectivity,
+                            std::span<const Index> offsets, std::span<const CellType> cellTypes,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates an unstructured grid of mixed cell types from points in double precision and flat CSR arrays.
+ *
+ * @see createGrid(std::span<const std::array<float, 3> >, std::span<const Index>, std::span<const Index>,
+ *      std::span<const CellType>, compression::Info)
+ *
+ * @tparam Index The integer type of the connectivity and offsets, written as is.
+ * @param points A view of 3D points in double precision.
+ * @param connectivity A view of the point indices of all cells.
+ * @param offsets A view of the offsets of the cells into connectivity.
+ * @param cellTypes A view of the type of each cell.
+ * @param compression Structure holding the compression information.
+ * @return An UnstructuredGrid object constructed from the provided data.
+ * @throws std::invalid_argument if the sizes of the arrays do not match
+ */
+template <class Index>
+requires std::is_integral_v<Index>
+UnstructuredGrid createGrid(std::span<const std::array<double, 3> > points, std::span<const Index> connectivity,
+                            std::span<const Index> offsets, std::span<const CellType> cellTypes,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates an image from the number of points along each axis, its origin, and the spacing of its points.
+ *
+ * No array is created, the points and cells of an image are implicit.
+ *
+ * @param dimensions The number of points along the x, y, and z axis, at least one each.
+ * @param origin The position of the first point.
+ * @param spacing The distance between neighboring points along each axis.
+ * @param compression Structure holding the compression information, used for the point and cell data.
+ * @return An ImageData object with the passed dimensions.
+ * @throws std::invalid_argument if a dimension is zero
+ */
+ImageData createImageData(std::array<std::uint64_t, 3> dimensions, std::array<double, 3> origin = {0., 0., 0.},
+                          std::array<double, 3> spacing = {1., 1., 1.},
+                          compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a rectilinear grid from the coordinates of its points along each axis.
+ *
+ * The number of points along each axis is the number of its coordinates. The coordinates are passed to the compressor
+ * straight from the caller's memory. If compression is inactive, they are referenced instead of copied and must stay
+ * valid until the grid is written.
+ *
+ * @param x The coordinates along the x axis in single precision, at least one.
+ * @param y The coordinates along the y axis in single precision, at least one.
+ * @param z The coordinates along the z axis in single precision, at least one.
+ * @param compression Structure holding the compression information.
+ * @return A RectilinearGrid object constructed from the provided coordinates.
+ * @throws std::invalid_argument if the coordinates along an axis are empty
+ */
+RectilinearGrid createRectilinearGrid(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+                                      compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a rectilinear grid from the coordinates of its points along each axis in double precision.
+ *
+ * @see createRectilinearGrid(std::span<const float>, std::span<const float>, std::span<const float>,
+ *      compression::Info)
+ *
+ * @param x The coordinates along the x axis in double precision, at least one.
+ * @param y The coordinates along the y axis in double precision, at least one.
+ * @param z The coordinates along the z axis in double precision, at least one.
+ * @param compression Structure holding the compression information.
+ * @return A RectilinearGrid object constructed from the provided coordinates.
+ * @throws std::invalid_argument if the coordinates along an axis are empty
+ */
+RectilinearGrid createRectilinearGrid(std::span<const double> x, std::span<const double> y, std::span<const double> z,
+                                      compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a structured grid from the number of points along each axis and the points.
+ *
+ * The points are ordered with x varying fastest, their cells follow from the dimensions. The points are passed to the
+ * compressor straight from the caller's memory. If compression is inactive, they are referenced instead of copied
+ * and must stay valid until the grid is written.
+ *
+ * @param dimensions The number of points along the x, y, and z axis, at least one each.
+ * @param points A view of 3D points in single precision, as many as the product of the dimensions.
+ * @param compression Structure holding the compression information.
+ * @return A StructuredGrid object constructed from the provided points.
+ * @throws std::invalid_argument if a dimension is zero or the number of points does not match the dimensions
+ */
+StructuredGrid createStructuredGrid(std::array<std::uint64_t, 3> dimensions,
+                                    std::span<const std::array<float, 3> > points,
+                                    compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a structured grid from the number of points along each axis and points in double precision.
+ *
+ * @see createStructuredGrid(std::array<std::uint64_t, 3>, std::span<const std::array<float, 3> >, compression::Info)
+ *
+ * @param dimensions The number of points along the x, y, and z axis, at least one each.
+ * @param points A view of 3D points in double precision, as many as the product of the dimensions.
+ * @param compression Structure holding the compression information.
+ * @return A StructuredGrid object constructed from the provided points.
+ * @throws std::invalid_argument if a dimension is zero or the number of points does not match the dimensions
+ */
+StructuredGrid createStructuredGrid(std::array<std::uint64_t, 3> dimensions,
+                                    std::span<const std::array<double, 3> > points,
+                                    compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a point cloud, a PolyData without lines or polygons.
+ *
+ * The points are passed to the compressor straight from the caller's memory. If compression is inactive, they are
+ * referenced instead of copied and must stay valid until the grid is written.
+ *
+ * @param points A view of 3D points in single precision.
+ * @param compression Structure holding the compression information.
+ * @param vertices If true, every point is a vertex cell, which some readers need to render the points. The vertices
+ *                 are generated while they are compressed and are never stored. Otherwise there are no cells.
+ * @return A PolyData object constructed from the provided points.
+ */
+PolyData createPolyData(std::span<const std::array<float, 3> > points,
+                        compression::Info compression = compression::zlib, bool vertices = false);
+
+/**
+ * @brief Creates a point cloud from points in double precision.
+ *
+ * @see createPolyData(std::span<const std::array<float, 3> >, compression::Info, bool)
+ *
+ * @param points A view of 3D points in double precision.
+ * @param compression Structure holding the compression information.
+ * @param vertices If true, every point is a vertex cell, otherwise there are no cells.
+ * @return A PolyData object constructed from the provided points.
+ */
+PolyData createPolyData(std::span<const std::array<double, 3> > points,
+                        compression::Info compression = compression::zlib, bool vertices = false);
+
+/**
+ * @brief The cells of a section of a PolyData, e.g. its lines, as flat CSR arrays.
+ *
+ * The offsets either hold the end of each cell in the connectivity (vtk convention) or additionally start with a
+ * leading zero (CSR convention). Empty arrays mean the section has no cells.
+ *
+ * @tparam Index The integer type of the connectivity and offsets, written as is.
+ */
+template <class Index>
+requires std::is_integral_v<Index>
+struct PolyCells
+{
+    std::span<const Index> connectivity;
+    std::span<const Index> offsets;
+};
+
+/**
+ * @brief Creates a PolyData of lines and polygons from points and flat CSR arrays.
+ *
+ * All arrays are passed to the compressor straight from the caller's memory. If compression is inactive, they are
+ * referenced instead of copied and must stay valid until the grid is written. The cells are numbered lines first.
+ *
+ * @pre All indices in connectivity must be valid indices into points
+ *
+ * @tparam Index The integer type of the connectivity and offsets, written as is.
+ * @param points A view of 3D points in single precision.
+ * @param lines The polylines, each of at least two points.
+ * @param polys The polygons, each of at least three points.
+ * @param compression Structure holding the compression information.
+ * @return A PolyData object constructed from the provided data.
+ * @throws std::invalid_argument if the offsets do not match the connectivity
+ */
+template <class Index>
+requires std::is_integral_v<Index>
+PolyData createPolyData(std::span<const std::array<float, 3> > points, PolyCells<Index> lines, PolyCells<Index> polys,
+                        compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a PolyData of lines and polygons from points in double precision and flat CSR arrays.
+ *
+ * @see createPolyData(std::span<const std::array<float, 3> >, PolyCells<Index>, PolyCells<Index>, compression::Info)
+ *
+ * @tparam Index The integer type of the connectivity and offsets, written as is.
+ * @param points A view of 3D points in double precision.
+ * @param lines The polylines, each of at least two points.
+ * @param polys The polygons, each of at least three points.
+ * @param compression Structure holding the compression information.
+ * @return A PolyData object constructed from the provided data.
+ * @throws std::invalid_argument if the offsets do not match the connectivity
+ */
+template <class Index>
+requires std::is_integral_v<Index>
+PolyData createPolyData(std::span<const std::array<double, 3> > points, PolyCells<Index> lines, PolyCells<Index> polys,
+                        compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a streaming grid from given points, cell type, and cells.
+ *
+ * The file is created immediately and the points and cells are written to it. Point and cell data is written as it
+ * is added, the file is complete once StreamingGrid::close() is called.
+ *
+ * @pre The same preconditions as for createGrid apply.
+ *
+ * @param file_path The file path where the grid will be written.
+ * @param points A view of 3D points, passed to the compressor straight from the caller's memory.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @param streaming Structure holding the memory budget and header reserve.
+ * @return A StreamingGrid object writing to file_path.
+ * @throws std::invalid_argument if an uncompressed array needs 64 bit size fields, see streaming::Info::uint64Headers
+ * @throws std::runtime_error if the file cannot be written
+ */
+StreamingGrid createStreamingGrid(const std::filesystem::path &file_path,
+                                  std::span<const std::array<float, 3> > points, CellType cellType,
+                                  const std::vector<std::vector<std::int32_t> > &cells,
+                                  compression::Info compression = compression::zlib,
+                                  streaming::Info streaming = {});
+
+/**
+ * @brief Creates a streaming grid from a view of points in double precision, cell type, and cells.
+ *
+ * @see createStreamingGrid(const std::filesystem::path &, std::span<const std::array<float, 3> >, CellType,
+ *      const std::vector<std::vector<std::int32_t> > &, compression::Info, streaming::Info)
+ *
+ * @param file_path The file path where the grid will be written.
+ * @param points A view of 3D points in double precision.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @param streaming Structure holding the memory budget and header reserve.
+ * @return A StreamingGrid object writing to file_path.
+ * @throws std::invalid_argument if an uncompressed array needs 64 bit size fields, see streaming::Info::uint64Headers
+ * @throws std::runtime_error if the file cannot be written
+ */
+StreamingGrid createStreamingGrid(const std::filesystem::path &file_path,
+                                  std::span<const std::array<double, 3> > points, CellType cellType,
+                                  const std::vector<std::vector<std::int32_t> > &cells,
+                                  compression::Info compression = compression::zlib,
+                                  streaming::Info streaming = {});
+
+/**
+ * @brief Creates a time series from given points, cell type, and cells.
+ *
+ * The points and cells are compressed immediately and copied if compression is inactive, they do not have to stay
+ * valid. No file is written until the first step is written.
+ *
+ * @pre The same preconditions as for createGrid apply.
+ *
+ * @param file_path The file path of the collection file (.pvd).
+ * @param points A view of 3D points in single precision.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @return A TimeSeries object writing to file_path.
+ */
+TimeSeries createTimeSeries(const std::filesystem::path &file_path, std::span<const std::array<float, 3> > points,
+                            CellType cellType, const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Creates a time series from a view of points in double precision, cell type, and cells.
+ *
+ * @see createTimeSeries(const std::filesystem::path &, std::span<const std::array<float, 3> >, CellType,
+ *      const std::vector<std::vector<std::int32_t> > &, compression::Info)
+ *
+ * @param file_path The file path of the collection file (.pvd).
+ * @param points A view of 3D points in double precision.
+ * @param cellType Enum representing the type of cell to create.
+ * @param cells A vector of vectors containing cell connectivity information.
+ * @param compression Structure holding the compression information.
+ * @return A TimeSeries object writing to file_path.
+ */
+TimeSeries createTimeSeries(const std::filesystem::path &file_path, std::span<const std::array<double, 3> > points,
+                            CellType cellType, const std::vector<std::vector<std::int32_t> > &cells,
+                            compression::Info compression = compression::zlib);
+
+/**
+ * @brief Writes a grid to a specified file path.
+ *
+ * This is a convenience wrapper around GridBase::write that allows writing a grid without calling the member function
+ * directly.
+ *
+ * @param grid The grid containing the data to be written.
+ * @param file_path The file path where the grid data will be written.
+ * @see GridBase::write
+ */
+void write(const GridBase &grid, const std::filesystem::path &file_path);
+
+/**
+ * @brief Writes a grid to a sink.
+ *
+ * @param grid The grid containing the data to be written.
+ * @param sink The sink receiving the output.
+ * @see GridBase::write(Sink &)
+ */
+void write(const GridBase &grid, Sink &sink);
+
+/**
+ * @brief Returns the path of a piece of a partitioned grid.
+ *
+ * The pieces are placed next to the parallel file and named after it, e.g. piece 3 of "out/flow.pvtu" is
+ * "out/flow_3.vtu".
+ *
+ * @param file_path The file path of the parallel file.
+ * @param piece The index of the piece.
+ * @return The file path of the piece.
+ */
+std::filesystem::path piecePath(const std::filesystem::path &file_path, std::uint32_t piece);
+
+/**
+ * @brief Writes the pieces of a partitioned grid concurrently together with a parallel file (.pvtu).
+ *
+ * Piece i is written to piecePath(file_path, i). Each piece is written by its own thread, the arrays of the pieces
+ * were already compressed when they were added. The parallel file references all pieces, which allows ParaView to load
+ * them in parallel.
+ *
+ * @param pieces The pieces of the grid, all pieces must hold the same arrays.
+ * @param file_path The file path where the parallel file will be written.
+ * @param threads The maximal number of threads, 0 selects the number of hardware threads.
+ * @throws std::invalid_argument if there are no pieces or the pieces hold different arrays
+ * @see UnstructuredGrid::writePVTU
+ */
+void writePartitioned(std::span<const UnstructuredGrid> pieces, const std::filesystem::path &file_path,
+                      std::uint32_t threads = 0);
+
+/**
+ * @brief Reads a grid file with appended or inline data, such as the files written by tinyvtu.
+ *
+ * The file is memory-mapped, only the XML header and the bytes of the selected arrays are read from the disk. The
+ * blocks of compressed arrays are decompressed in parallel. Arrays in base64 are decoded in parallel first, see
+ * compression::Encoding. Files compressed with LZ4 or LZMA need tinyvtu to be built with the codec.
+ *
+ * @param file_path The file path of the grid.
+ * @param reading Structure holding the selected arrays and the number of threads.
+ * @return The points, cells, and selected arrays of the grid.
+ * @throws std::runtime_error if the file cannot be read, is malformed, or uses an unsupported format or encoding
  */
-void write(const UnstructuredGrid &grid, const std::filesystem::path &file_path);
+Dataset read(const std::filesystem::path &file_path, const reading::Info &reading = {});
 }  // namespace tinyvtu
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "tinyvtu.hpp"
+
+namespace tinyvtu::test {
+/**
+ * Returns the contents of a file, empty if it cannot be read.
+ */
+inline std::string getContents(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/**
+ * Returns the XML of a file up to the appended data.
+ */
+inline std::string readHeader(const std::filesystem::path& path)
+{
+    const auto contents = getContents(path);
+    return contents.substr(0, contents.find("<AppendedData"));
+}
+
+/**
+ * Returns a copy of the values of an array read from a file.
+ */
+template <typename T>
+std::vector<T> toVector(const Array& array)
+{
+    const auto values = array.values<T>();
+    return {values.begin(), values.end()};
+}
+
+/**
+ * A chain of tetrahedra with point and cell fields, shared by the tests writing and reading whole grids.
+ *
+ * Points lie on a helix, consecutive cells share three points, and the fields vary smoothly with the index.
+ */
+template <typename Real = double>
+struct Grid
+{
+    std::vector<std::array<Real, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    std::vector<double> pointField;
+    std::vector<float> vectors;
+    std::vector<std::int32_t> cellField;
+
+    explicit Grid(std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto x = static_cast<Real>(i);
+            points.push_back({x, std::sin(x), std::cos(x)});
+            pointField.push_back(std::sin(0.01 * static_cast<double>(i)));
+            for (int component = 0; component < 3; ++component) vectors.push_back(static_cast<float>(i + component));
+        }
+        for (std::int32_t i = 0; i + 3 < static_cast<std::int32_t>(size); i += 2)
+        {
+            cells.push_back({i, i + 1, i + 2, i + 3});
+            cellField.push_back(i % 17);
+        }
+    }
+};
+}  // namespace tinyvtu::test
@@ -0,0 +1,216 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TestHelpers.hpp"
+#include "internal/Base64.hpp"
+#include "internal/XMLWriter.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu;
+using test::getContents;
+
+namespace {
+std::string encode(std::span<const std::uint8_t> bytes)
+{
+    std::string text(internal::base64Size(bytes.size()), '\0');
+    internal::encodeBase64(bytes, reinterpret_cast<std::uint8_t*>(text.data()));
+    return text;
+}
+
+std::span<const std::uint8_t> asBytes(std::string_view text)
+{
+    return {reinterpret_cast<const std::uint8_t*>(text.data()), text.size()};
+}
+
+/**
+ * Encodes bit by bit, the reference for the table driven encoder.
+ */
+std::string referenceEncode(std::span<const std::uint8_t> bytes)
+{
+    constexpr std::string_view Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    for (std::size_t i = 0; i < bytes.size(); i += 3)
+    {
+        std::uint32_t bits = 0;
+        for (std::size_t j = 0; j < 3; ++j) bits = bits << 8 | (i + j < bytes.size() ? bytes[i + j] : 0);
+        for (std::size_t j = 0; j < 4; ++j)
+            text += j * 6 < (bytes.size() - i) * 8 ? Alphabet[(bits >> (18 - 6 * j)) & 63] : '=';
+    }
+    return text;
+}
+
+void requireSameArrays(const Dataset& dataset, const Dataset& expected)
+{
+    REQUIRE(dataset.numberOfPoints == expected.numberOfPoints);
+    REQUIRE(dataset.numberOfCells == expected.numberOfCells);
+    REQUIRE(dataset.points.bytes == expected.points.bytes);
+    REQUIRE(dataset.connectivity.bytes == expected.connectivity.bytes);
+    REQUIRE(dataset.offsets.bytes == expected.offsets.bytes);
+    REQUIRE(dataset.types.bytes == expected.types.bytes);
+    REQUIRE(dataset.pointData.size() == expected.pointData.size());
+    for (std::size_t i = 0; i < expected.pointData.size(); ++i)
+    {
+        REQUIRE(dataset.pointData[i].name == expected.pointData[i].name);
+        REQUIRE(dataset.pointData[i].bytes == expected.pointData[i].bytes);
+    }
+    REQUIRE(dataset.cellData.size() == expected.cellData.size());
+    for (std::size_t i = 0; i < expected.cellData.size(); ++i)
+        REQUIRE(dataset.cellData[i].bytes == expected.cellData[i].bytes);
+}
+}  // namespace
+
+TEST_CASE("Base64 codec", "[base64]")
+{
+    SECTION("Known vectors")
+    {
+        constexpr std::array<std::pair<std::string_view, std::string_view>, 7> Vectors{
+            {{"", ""},
+             {"f", "Zg=="},
+             {"fo", "Zm8="},
+             {"foo", "Zm9v"},
+             {"foob", "Zm9vYg=="},
+             {"fooba", "Zm9vYmE="},
+             {"foobar", "Zm9vYmFy"}}};
+        for (const auto& [bytes, text] : Vectors)
+        {
+            REQUIRE(encode(asBytes(bytes)) == text);
+            internal::Data decoded;
+            REQUIRE(internal::decodeBase64(text, decoded));
+            REQUIRE(std::string(decoded.begin(), decoded.end()) == bytes);
+        }
+    }
+
+    SECTION("Round trip of all sizes and byte values")
+    {
+        std::vector<std::uint8_t> bytes(300);
+        for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<std::uint8_t>(i * 7 + i / 256);
+        for (std::size_t size = 0; size <= bytes.size(); ++size)
+        {
+            const auto part = std::span(bytes).first(size);
+            const auto text = encode(part);
+            REQUIRE(text == referenceEncode(part));
+            internal::Data decoded;
+            REQUIRE(internal::decodeBase64(text, decoded));
+            REQUIRE(std::ranges::equal(decoded, part));
+        }
+    }
+
+    SECTION("Vector kernels at all offsets")
+    {
+        // Lengths around the 12, 24, and 48 bytes per iteration of the kernels, and the bytes loaded beyond them
+        std::vector<std::uint8_t> bytes(1000);
+        for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<std::uint8_t>((i * 151) ^ (i >> 3));
+        for (std::size_t offset = 0; offset < 8; ++offset)
+        {
+            for (std::size_t size = 0; offset + size <= 200; ++size)
+            {
+                const auto part = std::span(bytes).subspan(offset, size);
+                REQUIRE(encode(part) == referenceEncode(part));
+            }
+            const auto rest = std::span(bytes).subspan(offset);
+            REQUIRE(encode(rest) == referenceEncode(rest));
+        }
+    }
+
+    SECTION("Invalid text")
+    {
+        internal::Data decoded;
+        REQUIRE_FALSE(internal::decodeBase64("Zm9", decoded));
+        REQUIRE_FALSE(internal::decodeBase64("Zm9v!A==", decoded));
+        REQUIRE_FALSE(internal::decodeBase64("Zg==Zm9v", decoded));
+    }
+
+    SECTION("Parts are encoded as one stream")
+    {
+        // Larger than a chunk of the writer, which is split among the threads and flushed
+        std::vector<std::uint8_t> bytes(4 * 1024 * 1024 + 5);
+        for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<std::uint8_t>(i ^ (i >> 9));
+        const std::span<const std::uint8_t> all(bytes);
+        const std::array parts{all.first(1), all.subspan(1, 4), all.subspan(5, 0), all.subspan(5)};
+        std::ostringstream stream;
+        {
+            internal::XMLWriter writer(stream);
+            writer.writeBase64(parts, 4);
+        }
+        REQUIRE(stream.str() == referenceEncode(bytes));
+    }
+}
+
+TEST_CASE("Write grids in base64", "[base64]")
+{
+    const test::Grid<> tetras(5000);
+
+    const std::filesystem::path rawPath = "test_base64_raw.vtu";
+    const std::filesystem::path path = "test_base64.vtu";
+    auto write = [&](compression::Info compression, const std::filesystem::path& file_path)
+    {
+        auto grid = createGrid(std::span(tetras.points), CellType::Tetra, tetras.cells, compression);
+        grid.addPointData("pointField", tetras.pointField);
+        // Duplicates refer to the data of the first array
+        grid.addPointData("copy", tetras.pointField);
+        grid.addCellData("cellField", tetras.cellField);
+        grid.write(file_path);
+    };
+
+    for (auto compression : {compression::zlib, compression::none})
+    {
+        compression.blockSize = 4096;
+        compression.deduplicate = true;
+        write(compression, rawPath);
+        const auto expected = read(rawPath);
+
+        SECTION(std::string("Appended ") + (compression.active ? "compressed" : "uncompressed"))
+        {
+            compression.encoding = compression::Encoding::AppendedBase64;
+            write(compression, path);
+            const auto contents = getContents(path);
+            REQUIRE(contents.find(R"(<AppendedData encoding="base64">)") != std::string::npos);
+            REQUIRE(contents.find("format=\"binary\"") == std::string::npos);
+            requireSameArrays(read(path), expected);
+            requireSameArrays(read(path, {.arrays = {}, .threads = 1}), expected);
+        }
+
+        SECTION(std::string("Inline ") + (compression.active ? "compressed" : "uncompressed"))
+        {
+            compression.encoding = compression::Encoding::InlineBase64;
+            compression.threads = 2;
+            write(compression, path);
+            const auto contents = getContents(path);
+            REQUIRE(contents.find("<AppendedData") == std::string::npos);
+            REQUIRE(contents.find("format=\"binary\"") != std::string::npos);
+            requireSameArrays(read(path), expected);
+        }
+    }
+
+    SECTION("Inline image data")
+    {
+        auto compression = compression::zlib;
+        compression.encoding = compression::Encoding::InlineBase64;
+        auto image = createImageData({20, 10, 5}, {0., 0., 0.}, {1., 1., 1.}, compression);
+        std::vector<float> field(1000);
+        for (std::size_t i = 0; i < field.size(); ++i) field[i] = static_cast<float>(i) * 0.5f;
+        image.addPointData("field", field);
+        image.write(path);
+
+        const auto dataset = read(path);
+        const auto values = dataset.find("field")->values<float>();
+        REQUIRE(std::ranges::equal(values, field));
+    }
+
+    SECTION("Streaming grids are written raw")
+    {
+        auto compression = compression::zlib;
+        compression.encoding = compression::Encoding::AppendedBase64;
+        REQUIRE_THROWS_AS(
+            createStreamingGrid(path, std::span(tetras.points), CellType::Tetra, tetras.cells, compression),
+            std::invalid_argument);
+    }
+
+    std::filesystem::remove(rawPath);
+    std::filesystem::remove(path);
+}
@@ -1,8 +1,20 @@
 #include <catch2/catch_test_macros.hpp>
 #include <cmath>
+#include <cstring>
+#include <random>
 
+#include "internal/Compressor.hpp"
 #include "internal/DataBlock.hpp"
 #include "tinyvtu.hpp"
+#include "zlib.h"
+
+#ifdef TINYVTU_WITH_LZ4
+#include "lz4.h"
+#endif
+
+#ifdef TINYVTU_WITH_LZMA
+#include "lzma.h"
+#endif
 
 using namespace tinyvtu::internal;
 
@@ -104,3 +116,362 @@ TEST_CASE("DataBlock creation with various numeric types", "[DataBlock]")
                           std::invalid_argument);
     }
 }
+
+TEST_CASE("Parallel compression matches serial compression", "[DataBlock]")
+{
+    // Smooth data with some noise, spanning several full blocks and a partial one
+    std::vector<float> data(100000);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = std::sin(static_cast<float>(i) * 0.001f) + static_cast<float>(i % 7) * 1e-4f;
+
+    const auto* source = reinterpret_cast<const std::uint8_t*>(data.data());
+    const auto size = data.size() * sizeof(float);
+
+    tinyvtu::compression::Info serial = tinyvtu::compression::zlib;
+    serial.blockSize = 4096;
+    const auto expected = compressData(source, size, serial);
+
+    for (const std::uint32_t threads : {0u, 2u, 3u, 8u, 1000u})
+    {
+        auto parallel = serial;
+        parallel.threads = threads;
+        REQUIRE(compressData(source, size, parallel) == expected);
+    }
+
+    SECTION("Header is unchanged")
+    {
+        std::uint32_t header[3];
+        std::memcpy(header, expected.data(), sizeof(header));
+        REQUIRE(header[0] == (size + serial.blockSize - 1) / serial.blockSize);
+        REQUIRE(header[1] == serial.blockSize);
+        REQUIRE(header[2] == size % serial.blockSize);
+    }
+
+    SECTION("Empty data")
+    {
+        auto parallel = serial;
+        parallel.threads = 4;
+        REQUIRE(compressData(source, 0, parallel) == compressData(source, 0, serial));
+    }
+}
+
+TEST_CASE("Adaptive compression", "[DataBlock]")
+{
+    // Random bytes followed by zeros, one block of each
+    const std::uint32_t blockSize = 16384;
+    Data data(2 * blockSize);
+    std::mt19937 generator(7);
+    for (std::uint32_t i = 0; i < blockSize; ++i) data[i] = static_cast<std::uint8_t>(generator());
+
+    auto compression = tinyvtu::compression::zlib;
+    compression.blockSize = blockSize;
+    compression.minRatio = 1.05;
+    const auto compressed = compressData(data.data(), data.size(), compression);
+
+    std::uint32_t header[5];
+    std::memcpy(header, compressed.data(), sizeof(header));
+    REQUIRE(header[0] == 2);
+
+    SECTION("Incompressible blocks are stored")
+    {
+        auto stored = compression;
+        stored.level = 0;
+        stored.minRatio = 0;
+        // Only the sample is compressed, it is at most a few bytes larger than stored
+        const auto storedSize = compressData(data.data(), blockSize, stored).size() - 4 * sizeof(std::uint32_t);
+        REQUIRE(header[3] >= blockSize);
+        REQUIRE(header[3] <= storedSize + 16);
+        REQUIRE(header[4] < blockSize / 100);
+    }
+
+    SECTION("Blocks smaller than the sample are compressed")
+    {
+        auto plain = compression;
+        plain.minRatio = 0;
+        REQUIRE(compressData(data.data(), 1000, compression) == compressData(data.data(), 1000, plain));
+    }
+
+    SECTION("Only the zlib engine stores blocks")
+    {
+        auto lz4 = compression;
+        lz4.codec = tinyvtu::compression::Codec::LZ4;
+        REQUIRE_THROWS_AS(compressData(data.data(), data.size(), lz4), std::invalid_argument);
+        auto libdeflate = compression;
+        libdeflate.deflate = tinyvtu::compression::Deflate::LibDeflate;
+        REQUIRE_THROWS_AS(compressData(data.data(), data.size(), libdeflate), std::invalid_argument);
+    }
+
+    SECTION("Blocks decompress to the data")
+    {
+        Data decompressed(data.size());
+        std::size_t offset = sizeof(header);
+        for (std::uint32_t i = 0; i < 2; ++i)
+        {
+            uLongf decompressedSize = blockSize;
+            REQUIRE(uncompress(&decompressed[i * blockSize], &decompressedSize, &compressed[offset], header[3 + i]) ==
+                    Z_OK);
+            REQUIRE(decompressedSize == blockSize);
+            offset += header[3 + i];
+        }
+        REQUIRE(decompressed == data);
+    }
+
+    SECTION("Automatic block size")
+    {
+        compression.blockSize = 0;
+        const auto automatic = compressData(data.data(), data.size(), compression);
+        std::uint32_t automaticBlockSize;
+        std::memcpy(&automaticBlockSize, &automatic[sizeof(std::uint32_t)], sizeof(automaticBlockSize));
+        REQUIRE(automaticBlockSize >= 16384);
+        REQUIRE(automaticBlockSize <= 65536);
+        REQUIRE((automaticBlockSize & (automaticBlockSize - 1)) == 0);
+    }
+}
+
+TEST_CASE("Content keys and comparison of DataBlocks", "[DataBlock]")
+{
+    std::vector<std::int32_t> ids(40000);
+    for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<std::int32_t>(i / 1000);
+    const std::span<const std::uint8_t> bytes(reinterpret_cast<const std::uint8_t *>(ids.data()),
+                                              ids.size() * sizeof(std::int32_t));
+    auto compression = tinyvtu::compression::zlib;
+    compression.blockSize = 16384;
+
+    SECTION("Keys depend on data, type, and written settings only")
+    {
+        const auto key = contentKey(DataBlock::Int32, bytes, compression);
+        REQUIRE(key != 0);
+        auto threaded = compression;
+        threaded.threads = 4;
+        REQUIRE(contentKey(DataBlock::Int32, bytes, threaded) == key);
+        auto level = compression;
+        level.level = 6;
+        REQUIRE(contentKey(DataBlock::Int32, bytes, level) != key);
+        REQUIRE(contentKey(DataBlock::UInt32, bytes, compression) != key);
+        REQUIRE(contentKey(DataBlock::Int32, bytes.first(bytes.size() - 4), compression) != key);
+    }
+
+    for (const auto &settings : {compression, tinyvtu::compression::none})
+    {
+        const auto block = createBlock("ids", std::span<const std::int32_t>(ids), 1, settings);
+        REQUIRE(holdsData(block, bytes, settings));
+        REQUIRE_FALSE(holdsData(block, bytes.first(bytes.size() - 4), settings));
+
+        auto changed = ids;
+        changed[ids.size() - 1] += 1;
+        REQUIRE_FALSE(holdsData(block,
+                                std::span(reinterpret_cast<const std::uint8_t *>(changed.data()), bytes.size()),
+                                settings));
+    }
+}
+
+TEST_CASE("Generated and repeated DataBlocks", "[DataBlock]")
+{
+    std::vector<std::int64_t> offsets(50000);
+    for (std::size_t i = 0; i < offsets.size(); ++i) offsets[i] = static_cast<std::int64_t>(4 * (i + 1));
+    const std::span<const std::uint8_t> bytes(reinterpret_cast<const std::uint8_t *>(offsets.data()),
+                                              offsets.size() * sizeof(std::int64_t));
+    const Generator generate = [&](std::uint64_t offset, std::span<std::uint8_t> destination)
+    { std::memcpy(destination.data(), &bytes[offset], destination.size()); };
+
+    SECTION("Generated blocks equal blocks of data in memory")
+    {
+        for (const std::uint32_t blockSize : {1000u, 32768u})
+        {
+            for (const std::uint32_t threads : {1u, 3u})
+            {
+                auto compression = tinyvtu::compression::zlib;
+                compression.blockSize = blockSize;
+                compression.threads = threads;
+                const auto generated = createBlock(DataBlock::Int64, "offsets", bytes.size(), 0, compression, generate);
+                REQUIRE(generated.block ==
+                        createBlock("offsets", std::span<const std::int64_t>(offsets), 0, compression).block);
+            }
+        }
+        const auto uncompressed =
+            createBlock(DataBlock::Int64, "offsets", bytes.size(), 0, tinyvtu::compression::none, generate);
+        REQUIRE(holdsData(uncompressed, bytes, tinyvtu::compression::none));
+    }
+
+    SECTION("Equal blocks are compressed once")
+    {
+        const Data zeros(10 * 32768 + 100, 0);
+        const auto compressed = compressData(zeros.data(), zeros.size(), tinyvtu::compression::zlib);
+        std::uint32_t header[3 + 11];
+        std::memcpy(header, compressed.data(), sizeof(header));
+        REQUIRE(header[0] == 11);
+        const auto first = compressed.begin() + sizeof(header);
+        for (std::uint32_t i = 1; i < 10; ++i)
+        {
+            REQUIRE(header[3 + i] == header[3]);
+            REQUIRE(std::equal(first, first + header[3], first + i * header[3]));
+        }
+        REQUIRE(holdsData({DataBlock::UInt8, "zeros", 1, compressed}, zeros, tinyvtu::compression::zlib));
+    }
+}
+
+TEST_CASE("DataBlock headers with 64 bit size fields", "[DataBlock]")
+{
+    std::vector<float> data(10000);
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = std::sin(static_cast<float>(i) * 0.01f);
+    const auto* source = reinterpret_cast<const std::uint8_t*>(data.data());
+    const auto size = data.size() * sizeof(float);
+
+    SECTION("Widened header matches a header created with 64 bit")
+    {
+        auto compression = tinyvtu::compression::zlib;
+        compression.blockSize = 4096;
+        for (const auto& info : {compression, tinyvtu::compression::none})
+        {
+            const DataBlock narrow = createBlock("Float32Data", data, 1, info);
+            REQUIRE(narrow.header_type == HeaderType::UInt32);
+
+            auto widened = widenHeader(narrow, info);
+            widened.insert(widened.end(), narrow.block.begin() + static_cast<std::ptrdiff_t>(headerSize(narrow, info)),
+                           narrow.block.end());
+            REQUIRE(widened == compressData(source, size, info, HeaderType::UInt64));
+        }
+    }
+
+    SECTION("Uncompressed size field")
+    {
+        const auto block = compressData(source, size, tinyvtu::compression::none, HeaderType::UInt64);
+        std::uint64_t header;
+        std::memcpy(&header, block.data(), sizeof(header));
+        REQUIRE(header == size);
+        REQUIRE(block.size() == sizeof(std::uint64_t) + size);
+    }
+
+    SECTION("Required header type")
+    {
+        const std::uint64_t large = 5ull * 1024 * 1024 * 1024;
+        REQUIRE(requiredHeaderType(size, tinyvtu::compression::none) == HeaderType::UInt32);
+        REQUIRE(requiredHeaderType(large, tinyvtu::compression::none) == HeaderType::UInt64);
+        REQUIRE(requiredHeaderType(large, tinyvtu::compression::zlib) == HeaderType::UInt32);
+    }
+}
+
+TEST_CASE("DataBlock compression with other codecs", "[DataBlock]")
+{
+    std::vector<std::int32_t> data(20000);
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<std::int32_t>(i % 100);
+    const auto* source = reinterpret_cast<const std::uint8_t*>(data.data());
+    const auto size = data.size() * sizeof(std::int32_t);
+
+    // Returns the compressed blocks one after another, each block is an independent stream of the codec
+    [[maybe_unused]] auto splitBlocks = [](const Data& compressed)
+    {
+        std::uint32_t numberOfBlocks;
+        std::memcpy(&numberOfBlocks, compressed.data(), sizeof(numberOfBlocks));
+        std::vector<Data> blocks;
+        std::size_t offset = sizeof(std::uint32_t) * (3 + numberOfBlocks);
+        for (std::uint32_t i = 0; i < numberOfBlocks; ++i)
+        {
+            std::uint32_t blockSize;
+            std::memcpy(&blockSize, &compressed[sizeof(std::uint32_t) * (3 + i)], sizeof(blockSize));
+            blocks.emplace_back(compressed.begin() + static_cast<std::ptrdiff_t>(offset),
+                                compressed.begin() + static_cast<std::ptrdiff_t>(offset + blockSize));
+            offset += blockSize;
+        }
+        REQUIRE(offset == compressed.size());
+        return blocks;
+    };
+
+#ifdef TINYVTU_WITH_LZ4
+    SECTION("LZ4 blocks decompress to the data")
+    {
+        auto compression = tinyvtu::compression::lz4;
+        compression.blockSize = 4096;
+        const auto blocks = splitBlocks(compressData(source, size, compression));
+        REQUIRE(blocks.size() == (size + compression.blockSize - 1) / compression.blockSize);
+
+        Data decompressed(size);
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            const auto capacity = std::min<std::size_t>(compression.blockSize, size - i * compression.blockSize);
+            const auto result = LZ4_decompress_safe(reinterpret_cast<const char*>(blocks[i].data()),
+                                                    reinterpret_cast<char*>(&decompressed[i * compression.blockSize]),
+                                                    static_cast<int>(blocks[i].size()), static_cast<int>(capacity));
+            REQUIRE(result == static_cast<int>(capacity));
+        }
+        REQUIRE(std::memcmp(decompressed.data(), source, size) == 0);
+
+        // LZ4 takes the sizes as int, larger ones are rejected before the block is decompressed
+        REQUIRE_THROWS_AS(decompressBlock(tinyvtu::compression::Codec::LZ4, blocks[0].data(), blocks[0].size(),
+                                          decompressed.data(), std::uint64_t{1} << 31),
+                          std::runtime_error);
+    }
+#else
+    SECTION("LZ4 is not available")
+    {
+        REQUIRE_THROWS_AS(compressData(source, size, tinyvtu::compression::lz4), std::invalid_argument);
+    }
+#endif
+
+#ifdef TINYVTU_WITH_LZMA
+    SECTION("LZMA blocks decompress to the data")
+    {
+        auto compression = tinyvtu::compression::lzma;
+        compression.blockSize = 4096;
+        compression.threads = 4;
+        const auto blocks = splitBlocks(compressData(source, size, compression));
+
+        Data decompressed(size);
+        std::size_t outPosition = 0;
+        for (const auto& block : blocks)
+        {
+            std::uint64_t memoryLimit = UINT64_MAX;
+            std::size_t inPosition = 0;
+            REQUIRE(lzma_stream_buffer_decode(&memoryLimit, 0, nullptr, block.data(), &inPosition, block.size(),
+                                              decompressed.data(), &outPosition, decompressed.size()) == LZMA_OK);
+        }
+        REQUIRE(outPosition == size);
+        REQUIRE(std::memcmp(decompressed.data(), source, size) == 0);
+    }
+#else
+    SECTION("LZMA is not available")
+    {
+        REQUIRE_THROWS_AS(compressData(source, size, tinyvtu::compression::lzma), std::invalid_argument);
+    }
+#endif
+
+    SECTION("Every deflate engine writes zlib blocks")
+    {
+        using tinyvtu::compression::Deflate;
+        const std::vector<std::pair<Deflate, bool>> engines{{Deflate::Default, true},
+                                                            {Deflate::ZLib, true},
+#ifdef TINYVTU_WITH_LIBDEFLATE
+                                                            {Deflate::LibDeflate, true}};
+#else
+                                                            {Deflate::LibDeflate, false}};
+#endif
+
+        for (const auto& [deflate, available] : engines)
+        {
+            for (const std::int32_t level : {0, 1, 6, 9})
+            {
+                auto compression = tinyvtu::compression::zlib;
+                compression.blockSize = 4096;
+                compression.level = level;
+                compression.deflate = deflate;
+                if (!available)
+                {
+                    REQUIRE_THROWS_AS(compressData(source, size, compression), std::invalid_argument);
+                    continue;
+                }
+
+                const auto blocks = splitBlocks(compressData(source, size, compression));
+                Data decompressed(size);
+                for (std::size_t i = 0; i < blocks.size(); ++i)
+                {
+                    uLongf capacity = std::min<std::size_t>(compression.blockSize, size - i * compression.blockSize);
+                    const auto expected = capacity;
+                    REQUIRE(uncompress(&decompressed[i * compression.blockSize], &capacity, blocks[i].data(),
+                                       static_cast<uLong>(blocks[i].size())) == Z_OK);
+                    REQUIRE(capacity == expected);
+                }
+                REQUIRE(std::memcmp(decompressed.data(), source, size) == 0);
+            }
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include <catch2/catch_test_macros.hpp>
+#include <cstring>
 #include <fstream>
 
 #include "internal/DataBlock.hpp"
@@ -156,3 +157,37 @@ TEST_CASE("GridData write", "[GridData]")
         std::filesystem::remove(file_path);
     }
 }
+
+TEST_CASE("GridData write with 64 bit headers", "[GridData]")
+{
+    const std::vector<double> points_data = {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 1.0, 0.0};
+    const std::vector<std::uint32_t> connectivity = {0, 1, 2, 3};
+    const auto* source = reinterpret_cast<const std::uint8_t*>(points_data.data());
+
+    // A block too large for 32 bit headers is faked by creating the points with a 64 bit header
+    DataBlock points{DataBlock::Float64, "Points", 3,
+                     compressData(source, points_data.size() * sizeof(double), tinyvtu::compression::none,
+                                  HeaderType::UInt64),
+                     {}, HeaderType::UInt64};
+    GridData grid_data(4, std::move(points), 1,
+                       createBlock("Connectivity", connectivity, 1, tinyvtu::compression::none),
+                       createBlock("Offsets", std::vector<std::uint32_t>{4}, 1, tinyvtu::compression::none),
+                       createBlock("Types", std::vector<std::uint8_t>{9}, 1, tinyvtu::compression::none),
+                       tinyvtu::compression::none);
+
+    const std::filesystem::path file_path = "test_grid_data_uint64.vtu";
+    grid_data.write(file_path);
+    std::ifstream file(file_path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(file_path);
+
+    REQUIRE(content.find("header_type=\"UInt64\"") != std::string::npos);
+    // The points take 8 + 12 * 8 bytes, the connectivity follows with a widened header
+    REQUIRE(content.find("Name=\"Connectivity\" NumberOfComponents=\"1\" type=\"UInt32\" format=\"appended\" "
+                         "offset=\"104\"") != std::string::npos);
+    const auto appended = content.find('_', content.find("<AppendedData")) + 1;
+    std::uint64_t connectivity_size;
+    std::memcpy(&connectivity_size, &content[appended + 104], sizeof(connectivity_size));
+    REQUIRE(connectivity_size == connectivity.size() * sizeof(std::uint32_t));
+}
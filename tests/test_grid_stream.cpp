@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+
+#include "TestHelpers.hpp"
+#include "internal/GridStream.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu;
+using test::getContents;
+
+namespace {
+/**
+ * Removes the blanks in front of the appended data marker, a streaming grid pads them up to the reserved size.
+ */
+std::string removeReservePadding(std::string content)
+{
+    const std::string tag = "<AppendedData encoding=\"raw\">\n";
+    const auto begin = content.find(tag) + tag.size();
+    const auto marker = content.find('_', begin);
+    content.erase(begin, marker - begin);
+    return content;
+}
+
+// Single precision points, the regular grids of the other tests use double
+using Grid = test::Grid<float>;
+
+std::string writeRegular(const Grid& grid, compression::Info compression)
+{
+    const std::filesystem::path path = "test_grid_stream_regular.vtu";
+    auto unstructuredGrid = createGrid(grid.points, CellType::Tetra, grid.cells, compression);
+    unstructuredGrid.addPointData("pointField", grid.pointField);
+    unstructuredGrid.addCellData("cellField", grid.cellField);
+    unstructuredGrid.write(path);
+    auto content = getContents(path);
+    std::filesystem::remove(path);
+    return content;
+}
+
+std::string writeStreaming(const Grid& grid, compression::Info compression, streaming::Info streaming)
+{
+    const std::filesystem::path path = "test_grid_stream_streaming.vtu";
+    {
+        auto streamingGrid =
+            createStreamingGrid(path, grid.points, CellType::Tetra, grid.cells, compression, streaming);
+        streamingGrid.addPointData("pointField", grid.pointField);
+        streamingGrid.addCellData("cellField", grid.cellField);
+        streamingGrid.close();
+    }
+    auto content = getContents(path);
+    std::filesystem::remove(path);
+    return content;
+}
+}  // namespace
+
+TEST_CASE("Streaming grid writes the same data as a regular grid", "[GridStream]")
+{
+    const Grid grid(20000);
+    auto compression = compression::zlib;
+    compression.blockSize = 4096;
+
+    SECTION("Compressed")
+    {
+        const auto expected = removeReservePadding(writeRegular(grid, compression));
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression, {})) == expected);
+    }
+
+    SECTION("Compressed with several threads")
+    {
+        const auto expected = removeReservePadding(writeRegular(grid, compression));
+        compression.threads = 4;
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression, {})) == expected);
+    }
+
+    SECTION("Uncompressed")
+    {
+        const auto expected = removeReservePadding(writeRegular(grid, compression::none));
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression::none, {})) == expected);
+    }
+
+    SECTION("Memory budget smaller than an array")
+    {
+        const auto expected = removeReservePadding(writeRegular(grid, compression));
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression, {.memoryBudget = 20000})) == expected);
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression, {.memoryBudget = 1})) == expected);
+    }
+
+    SECTION("64 bit headers")
+    {
+        for (const auto info : {compression, compression::none})
+        {
+            const auto content = writeStreaming(grid, info, {.uint64Headers = true});
+            REQUIRE(content.find("header_type=\"UInt64\"") != std::string::npos);
+            REQUIRE(writeRegular(grid, info).find("header_type") == std::string::npos);
+        }
+    }
+
+    SECTION("Header larger than the reserved space")
+    {
+        const auto expected = writeRegular(grid, compression);
+        REQUIRE(writeStreaming(grid, compression, {.memoryBudget = 20000, .headerReserve = 0}) == expected);
+        REQUIRE(removeReservePadding(writeStreaming(grid, compression, {.headerReserve = 100})) ==
+                removeReservePadding(expected));
+    }
+}
+
+TEST_CASE("Streaming grid handling", "[GridStream]")
+{
+    const Grid grid(16);
+    const std::filesystem::path path = "test_grid_stream.vtu";
+
+    SECTION("Data size mismatch")
+    {
+        auto streamingGrid = createStreamingGrid(path, grid.points, CellType::Tetra, grid.cells);
+        REQUIRE_THROWS_AS(streamingGrid.addPointData("wrong", std::vector<float>(3)), std::invalid_argument);
+        REQUIRE_THROWS_AS(streamingGrid.addCellData("wrong", std::vector<float>(3)), std::invalid_argument);
+    }
+
+    SECTION("Destructor closes the file")
+    {
+        {
+            auto streamingGrid = createStreamingGrid(path, grid.points, CellType::Tetra, grid.cells);
+            streamingGrid.addPointData("pointField", grid.pointField);
+        }
+        REQUIRE(getContents(path).ends_with("</VTKFile>\n"));
+    }
+
+    SECTION("Adding data after close throws")
+    {
+        auto streamingGrid = createStreamingGrid(path, grid.points, CellType::Tetra, grid.cells);
+        streamingGrid.close();
+        REQUIRE_NOTHROW(streamingGrid.close());
+        REQUIRE_THROWS_AS(streamingGrid.addPointData("pointField", grid.pointField), std::logic_error);
+    }
+
+    SECTION("Invalid path")
+    {
+        REQUIRE_THROWS(
+            createStreamingGrid("/nonexistent/directory/test.vtu", grid.points, CellType::Tetra, grid.cells));
+    }
+
+    std::filesystem::remove(path);
+}
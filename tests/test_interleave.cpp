@@ -0,0 +1,82 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "internal/Interleave.hpp"
+
+using namespace tinyvtu;
+
+namespace {
+/**
+ * Interleaves component by component, the reference for the vector kernels.
+ */
+std::vector<std::uint8_t> referenceInterleave(std::span<const std::uint8_t* const> components, std::size_t element_size,
+                                              std::uint64_t first, std::uint64_t count)
+{
+    std::vector<std::uint8_t> bytes;
+    for (auto tuple = first; tuple < first + count; ++tuple)
+        for (const auto* component : components)
+            bytes.insert(bytes.end(), component + tuple * element_size, component + (tuple + 1) * element_size);
+    return bytes;
+}
+
+template <typename T>
+void requireInterleaved(std::size_t number_of_components)
+{
+    constexpr std::size_t size = 67;
+    std::vector<std::vector<T>> arrays(number_of_components, std::vector<T>(size));
+    for (std::size_t c = 0; c < arrays.size(); ++c)
+        for (std::size_t i = 0; i < size; ++i) arrays[c][i] = static_cast<T>(1000 * c + i) / static_cast<T>(2);
+    std::vector<const std::uint8_t*> components;
+    for (const auto& array : arrays) components.push_back(reinterpret_cast<const std::uint8_t*>(array.data()));
+
+    // Tails shorter than a vector, and unaligned sources and destinations
+    for (const std::uint64_t first : {0, 1, 3, 5})
+    {
+        for (const std::uint64_t count : {0, 1, 2, 3, 4, 5, 7, 8, 9, 31, 62})
+        {
+            std::vector<std::uint8_t> bytes(count * number_of_components * sizeof(T) + 1, 0xAB);
+            REQUIRE(internal::interleave(components, sizeof(T), first, count, bytes.data() + 1));
+            REQUIRE(bytes[0] == 0xAB);
+            REQUIRE(std::vector(bytes.begin() + 1, bytes.end()) ==
+                    referenceInterleave(components, sizeof(T), first, count));
+        }
+    }
+}
+}  // namespace
+
+TEST_CASE("Interleave component arrays", "[interleave]")
+{
+    std::array<std::uint8_t, 64> unused{};
+    const std::array<const std::uint8_t*, 5> five{unused.data(), unused.data(), unused.data(), unused.data(),
+                                                  unused.data()};
+    std::array<std::uint8_t, 64> destination{};
+
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+    for (const std::size_t components : {2, 3, 4})
+    {
+        SECTION("float with " + std::to_string(components) + " components") { requireInterleaved<float>(components); }
+        SECTION("double with " + std::to_string(components) + " components") { requireInterleaved<double>(components); }
+        SECTION("int32 with " + std::to_string(components) + " components")
+        {
+            requireInterleaved<std::int32_t>(components);
+        }
+        SECTION("int64 with " + std::to_string(components) + " components")
+        {
+            requireInterleaved<std::int64_t>(components);
+        }
+    }
+#endif
+
+    SECTION("Tuples without a kernel are left to the caller")
+    {
+        REQUIRE_FALSE(internal::interleave(std::span(five).first(1), 4, 0, 8, destination.data()));
+        REQUIRE_FALSE(internal::interleave(five, 4, 0, 2, destination.data()));
+        REQUIRE_FALSE(internal::interleave(std::span(five).first(3), 2, 0, 8, destination.data()));
+        REQUIRE(destination == std::array<std::uint8_t, 64>{});
+    }
+}
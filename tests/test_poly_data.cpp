@@ -0,0 +1,130 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TestHelpers.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu;
+using test::readHeader;
+using test::toVector;
+
+namespace {
+std::vector<std::array<float, 3>> createParticles(std::size_t count)
+{
+    std::vector<std::array<float, 3>> particles;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto t = static_cast<float>(i);
+        particles.push_back({std::sin(t), std::cos(t), 0.001f * t});
+    }
+    return particles;
+}
+}  // namespace
+
+TEST_CASE("Point clouds", "[poly]")
+{
+    const auto particles = createParticles(50000);
+    std::vector<float> speed(particles.size());
+    for (std::size_t i = 0; i < speed.size(); ++i) speed[i] = static_cast<float>(i % 101);
+    const std::filesystem::path path = "test_poly_data.vtp";
+
+    SECTION("Without cells")
+    {
+        for (const auto& compression : {compression::zlib, compression::none})
+        {
+            auto cloud = createPolyData(std::span(particles), compression);
+            cloud.addPointData("speed", speed);
+            REQUIRE_THROWS_AS(cloud.addCellData("id", std::vector<std::int32_t>(1)), std::invalid_argument);
+            cloud.write(path);
+
+            const auto header = readHeader(path);
+            REQUIRE(header.find("type=\"PolyData\"") != std::string::npos);
+            REQUIRE(header.find("NumberOfPoints=\"50000\" NumberOfVerts=\"0\"") != std::string::npos);
+            REQUIRE(header.find("<Verts>") == std::string::npos);
+
+            const auto dataset = read(path);
+            REQUIRE(dataset.numberOfPoints == particles.size());
+            REQUIRE(dataset.numberOfCells == 0);
+            REQUIRE(dataset.points.values<float>().size() == 3 * particles.size());
+            REQUIRE(toVector<float>(*dataset.find("speed")) == speed);
+        }
+    }
+
+    SECTION("With generated vertices")
+    {
+        for (const auto& compression : {compression::zlib, compression::none})
+        {
+            auto cloud = createPolyData(std::span(particles), compression, true);
+            cloud.addCellData("id", std::vector<std::int32_t>(particles.size(), 7));
+            cloud.write(path);
+
+            const auto dataset = read(path);
+            REQUIRE(dataset.numberOfCells == particles.size());
+            std::vector<std::int32_t> expected(particles.size());
+            std::iota(expected.begin(), expected.end(), 0);
+            REQUIRE(toVector<std::int32_t>(dataset.verts.connectivity) == expected);
+            std::iota(expected.begin(), expected.end(), 1);
+            REQUIRE(toVector<std::int32_t>(dataset.verts.offsets) == expected);
+            REQUIRE(dataset.find("id")->bytes.size() == particles.size() * sizeof(std::int32_t));
+        }
+    }
+
+    SECTION("A point cloud is smaller than an unstructured grid of vertices")
+    {
+        std::vector<std::vector<std::int32_t>> vertices;
+        for (std::int32_t i = 0; i < static_cast<std::int32_t>(particles.size()); ++i) vertices.push_back({i});
+        createGrid(std::span(particles), CellType::Vertex, vertices, compression::none).write("test_poly_data.vtu");
+        createPolyData(std::span(particles), compression::none).write(path);
+        // The grid of vertices adds a connectivity entry, an offset, and a type of 9 bytes per point
+        REQUIRE(std::filesystem::file_size(path) + particles.size() * 9 <=
+                std::filesystem::file_size("test_poly_data.vtu"));
+    }
+}
+
+TEST_CASE("Lines and polygons", "[poly]")
+{
+    const auto points = createParticles(6);
+    const std::filesystem::path path = "test_poly_data.vtp";
+    // Two lines in CSR convention and two triangles in vtk convention
+    const std::vector<std::int64_t> lineConnectivity{0, 1, 2, 3, 4};
+    const std::vector<std::int64_t> lineOffsets{0, 3, 5};
+    const std::vector<std::int64_t> polyConnectivity{0, 1, 5, 2, 3, 5};
+    const std::vector<std::int64_t> polyOffsets{3, 6};
+
+    auto grid = createPolyData(std::span(points), PolyCells<std::int64_t>{lineConnectivity, lineOffsets},
+                               PolyCells<std::int64_t>{polyConnectivity, polyOffsets});
+    grid.addCellData("section", std::vector<std::uint8_t>{1, 1, 2, 2});
+    grid.write(path);
+
+    const auto header = readHeader(path);
+    REQUIRE(header.find("NumberOfVerts=\"0\" NumberOfLines=\"2\" NumberOfStrips=\"0\" NumberOfPolys=\"2\"") !=
+            std::string::npos);
+    REQUIRE(header.find("<Verts>") == std::string::npos);
+
+    const auto dataset = read(path);
+    REQUIRE(dataset.numberOfCells == 4);
+    REQUIRE(dataset.verts.connectivity.bytes.empty());
+    REQUIRE(toVector<std::int64_t>(dataset.lines.connectivity) == lineConnectivity);
+    REQUIRE(toVector<std::int64_t>(dataset.lines.offsets) == std::vector<std::int64_t>{3, 5});
+    REQUIRE(toVector<std::int64_t>(dataset.polys.connectivity) == polyConnectivity);
+    REQUIRE(toVector<std::int64_t>(dataset.polys.offsets) == polyOffsets);
+    REQUIRE(toVector<std::uint8_t>(*dataset.find("section")) == std::vector<std::uint8_t>{1, 1, 2, 2});
+
+    SECTION("Offsets must match the connectivity")
+    {
+        const std::vector<std::int64_t> shortOffsets{3};
+        REQUIRE_THROWS_AS(createPolyData(std::span(points), PolyCells<std::int64_t>{lineConnectivity, shortOffsets},
+                                         PolyCells<std::int64_t>{}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(createPolyData(std::span(points), PolyCells<std::int64_t>{lineConnectivity, {}},
+                                         PolyCells<std::int64_t>{}),
+                          std::invalid_argument);
+    }
+}
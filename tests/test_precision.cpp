@@ -0,0 +1,208 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "internal/Precision.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu::internal;
+
+namespace {
+/**
+ * Returns the values of an uncompressed data block, which follow the [#bytes] field.
+ */
+template <typename T>
+std::vector<T> blockValues(const DataBlock& data_block)
+{
+    std::vector<T> values((data_block.block.size() - sizeof(std::uint32_t)) / sizeof(T));
+    std::memcpy(values.data(), &data_block.block[sizeof(std::uint32_t)], values.size() * sizeof(T));
+    return values;
+}
+}  // namespace
+
+TEST_CASE("Kept mantissa bits", "[Precision]")
+{
+    REQUIRE(keptMantissaBits({}, 23, 23) == 23);
+    REQUIRE(keptMantissaBits({.significantBits = 12}, 23, 23) == 11);
+    REQUIRE(keptMantissaBits({.significantBits = 60}, 52, 52) == 52);
+    REQUIRE(keptMantissaBits({.significantBits = 30}, 52, 23) == 23);
+    // 2^-(k+1) <= 1e-3 holds from k = 9 on
+    REQUIRE(keptMantissaBits({.relativeError = 1e-3}, 52, 52) == 9);
+    REQUIRE(keptMantissaBits({.relativeError = 1e-3}, 52, 23) == 9);
+    REQUIRE(keptMantissaBits({.significantBits = 4, .relativeError = 1e-3}, 52, 52) == 9);
+    // Keeping all bits meets any bound, unless the type is narrowed
+    REQUIRE(keptMantissaBits({.relativeError = 1e-30}, 23, 23) == 23);
+    REQUIRE_THROWS_AS(keptMantissaBits({.relativeError = 1e-10}, 52, 23), std::invalid_argument);
+    REQUIRE_THROWS_AS(keptMantissaBits({.relativeError = -1.}, 23, 23), std::invalid_argument);
+}
+
+TEST_CASE("Mantissa rounding", "[Precision]")
+{
+    std::mt19937_64 generator(3);
+    std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+    std::vector<double> data(100000);
+    for (auto& value : data) value = distribution(generator);
+
+    SECTION("Relative error bound")
+    {
+        const tinyvtu::precision::Info precision{.relativeError = 1e-4};
+        const auto values = blockValues<double>(
+            createBlock("Rounded", std::span<const double>(data), 1, tinyvtu::compression::none, precision));
+        REQUIRE(values.size() == data.size());
+        for (std::size_t i = 0; i < data.size(); ++i)
+        {
+            REQUIRE(std::abs(values[i] - data[i]) <= 1e-4 * std::abs(data[i]));
+            std::uint64_t bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            REQUIRE((bits & ((std::uint64_t{1} << (52 - keptMantissaBits(precision, 52, 52))) - 1)) == 0);
+        }
+    }
+
+    SECTION("Rounded data compresses better")
+    {
+        const auto full = createBlock("Full", std::span<const double>(data), 1, tinyvtu::compression::zlib);
+        const auto rounded = createBlock("Rounded", std::span<const double>(data), 1, tinyvtu::compression::zlib,
+                                         {.significantBits = 16});
+        REQUIRE(rounded.block.size() * 2 < full.block.size());
+    }
+
+    SECTION("Special values")
+    {
+        constexpr auto infinity = std::numeric_limits<float>::infinity();
+        const std::array<float, 5> special{infinity, -infinity, std::numeric_limits<float>::quiet_NaN(),
+                                           std::numeric_limits<float>::max(), 0.f};
+        const auto values = blockValues<float>(
+            createBlock("Special", std::span<const float>(special), 1, tinyvtu::compression::none,
+                        {.significantBits = 8}));
+        REQUIRE(values[0] == infinity);
+        REQUIRE(values[1] == -infinity);
+        REQUIRE(std::isnan(values[2]));
+        // Rounding up would overflow, the mantissa is truncated instead
+        REQUIRE(std::isfinite(values[3]));
+        REQUIRE(values[3] <= std::numeric_limits<float>::max());
+        REQUIRE(values[4] == 0.f);
+    }
+
+    SECTION("Denormals")
+    {
+        // Denormals have fewer mantissa bits, rounding them further would exceed the bound
+        const std::array<float, 2> denormal{1.f, 1e-42f};
+        REQUIRE_THROWS_AS(createBlock("Rounded", std::span<const float>(denormal), 1, tinyvtu::compression::none,
+                                      {.relativeError = 1e-2}),
+                          std::invalid_argument);
+        REQUIRE_NOTHROW(createBlock("Rounded", std::span<const float>(denormal), 1, tinyvtu::compression::none,
+                                    {.significantBits = 8}));
+    }
+}
+
+TEST_CASE("Type narrowing", "[Precision]")
+{
+    using tinyvtu::precision::Narrowing;
+
+    SECTION("Double to float")
+    {
+        const std::vector<double> data{1.0, -2.5, 1e30, std::numeric_limits<double>::infinity()};
+        const auto data_block = createBlock("Narrowed", std::span<const double>(data), 1, tinyvtu::compression::none,
+                                            {.narrowing = Narrowing::Float32});
+        REQUIRE(data_block.type == DataBlock::Float32);
+        const auto values = blockValues<float>(data_block);
+        REQUIRE(values.size() == data.size());
+        for (std::size_t i = 0; i < data.size(); ++i) REQUIRE(values[i] == static_cast<float>(data[i]));
+    }
+
+    SECTION("Double to float with a relative error bound")
+    {
+        std::mt19937_64 generator(5);
+        std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+        std::vector<double> data(10000);
+        for (auto& value : data) value = distribution(generator);
+
+        for (const double bound : {1e-3, 1e-7})
+        {
+            const auto data_block = createBlock("Narrowed", std::span<const double>(data), 1,
+                                                tinyvtu::compression::none,
+                                                {.relativeError = bound, .narrowing = Narrowing::Float32});
+            const auto values = blockValues<float>(data_block);
+            for (std::size_t i = 0; i < data.size(); ++i)
+                REQUIRE(std::abs(values[i] - data[i]) <= bound * std::abs(data[i]));
+        }
+
+        // Values are converted block by block, blocks which cut values give the same array
+        tinyvtu::compression::Info compression = tinyvtu::compression::zlib;
+        compression.blockSize = 1001;
+        compression.threads = 4;
+        const tinyvtu::precision::Info rounded{.significantBits = 12, .narrowing = Narrowing::Float32};
+        const auto expected = blockValues<float>(
+            createBlock("Narrowed", std::span<const double>(data), 1, tinyvtu::compression::none, rounded));
+        REQUIRE(createBlock("Narrowed", std::span<const double>(data), 1, compression, rounded).block ==
+                createBlock("Expected", expected, 1, compression).block);
+
+        // A float has 24 significant bits, a bound of 1e-10 needs 33
+        REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const double>(data), 1, tinyvtu::compression::none,
+                                      {.relativeError = 1e-10, .narrowing = Narrowing::Float32}),
+                          std::invalid_argument);
+        // Values below the normal range of float lose bits or underflow to zero
+        for (const double small : {1e-44, 1e-50})
+        {
+            const std::vector<double> underflow{1.0, small};
+            REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const double>(underflow), 1,
+                                          tinyvtu::compression::none,
+                                          {.relativeError = 1e-3, .narrowing = Narrowing::Float32}),
+                              std::invalid_argument);
+        }
+    }
+
+    SECTION("Integers")
+    {
+        const std::vector<std::int64_t> data{0, -32768, 32767, 1000};
+        const auto data_block = createBlock("Narrowed", std::span<const std::int64_t>(data), 1,
+                                            tinyvtu::compression::zlib, {.narrowing = Narrowing::Int16});
+        REQUIRE(data_block.type == DataBlock::Int16);
+        REQUIRE(data_block.block == createBlock("Expected", std::vector<std::int16_t>{0, -32768, 32767, 1000}, 1,
+                                                tinyvtu::compression::zlib)
+                                        .block);
+    }
+
+    SECTION("Values out of range")
+    {
+        const std::vector<double> large{1.0, 1e300};
+        REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const double>(large), 1, tinyvtu::compression::zlib,
+                                      {.narrowing = Narrowing::Float32}),
+                          std::invalid_argument);
+        const std::vector<std::uint32_t> unsignedData{1, 1u << 31};
+        REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const std::uint32_t>(unsignedData), 1,
+                                      tinyvtu::compression::zlib, {.narrowing = Narrowing::Int32}),
+                          std::invalid_argument);
+    }
+
+    SECTION("Settings which do not apply to the type")
+    {
+        const std::vector<double> floating{1.0};
+        const std::vector<std::int32_t> integers{1};
+        REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const double>(floating), 1, tinyvtu::compression::zlib,
+                                      {.narrowing = Narrowing::Int32}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(createBlock("Narrowed", std::span<const std::int32_t>(integers), 1,
+                                      tinyvtu::compression::zlib, {.narrowing = Narrowing::Float32}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(createBlock("Rounded", std::span<const std::int32_t>(integers), 1,
+                                      tinyvtu::compression::zlib, {.significantBits = 8}),
+                          std::invalid_argument);
+    }
+
+    SECTION("Arrays of a grid")
+    {
+        const std::vector<std::array<float, 3>> points = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}};
+        auto grid = tinyvtu::createGrid(points, tinyvtu::CellType::Triangle, {{0, 1, 2}});
+        grid.addPointData("Temperature", std::vector<double>{1.0, 2.0, 3.0}, 1, {}, {.narrowing = Narrowing::Float32});
+        std::vector<std::uint8_t> buffer;
+        tinyvtu::VectorSink sink(buffer);
+        grid.write(sink);
+        const std::string content(buffer.begin(), buffer.end());
+        REQUIRE(content.find("Name=\"Temperature\" NumberOfComponents=\"1\" type=\"Float32\"") != std::string::npos);
+    }
+}
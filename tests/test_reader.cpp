@@ -0,0 +1,202 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "TestHelpers.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu;
+using test::toVector;
+
+namespace {
+using Grid = test::Grid<>;
+
+void requireContents(const Dataset& dataset, const Grid& grid)
+{
+    REQUIRE(dataset.numberOfPoints == grid.points.size());
+    REQUIRE(dataset.numberOfCells == grid.cells.size());
+    REQUIRE(dataset.points.numberOfComponents == 3);
+    const auto points = dataset.points.values<double>();
+    REQUIRE(points.size() == 3 * grid.points.size());
+    for (std::size_t i = 0; i < grid.points.size(); ++i)
+        for (std::size_t component = 0; component < 3; ++component)
+            REQUIRE(points[3 * i + component] == grid.points[i][component]);
+
+    REQUIRE(dataset.types.values<std::uint8_t>().size() == grid.cells.size());
+    REQUIRE(dataset.offsets.values<std::int32_t>().back() == static_cast<std::int32_t>(4 * grid.cells.size()));
+
+    REQUIRE(dataset.pointData.size() == 2);
+    REQUIRE(toVector<double>(*dataset.find("pointField")) == grid.pointField);
+    REQUIRE(dataset.find("vectors")->numberOfComponents == 3);
+    REQUIRE(toVector<float>(*dataset.find("vectors")) == grid.vectors);
+    REQUIRE(dataset.cellData.size() == 1);
+    REQUIRE(toVector<std::int32_t>(*dataset.find("cellField")) == grid.cellField);
+}
+}  // namespace
+
+TEST_CASE("Read written grids", "[read]")
+{
+    const Grid grid(10000);
+    const std::filesystem::path path = "test_reader.vtu";
+
+    auto write = [&](compression::Info compression)
+    {
+        auto unstructuredGrid = createGrid(std::span(grid.points), CellType::Tetra, grid.cells, compression);
+        unstructuredGrid.addPointData("pointField", grid.pointField);
+        unstructuredGrid.addPointData("vectors", grid.vectors, 3);
+        unstructuredGrid.addCellData("cellField", grid.cellField);
+        unstructuredGrid.write(path);
+    };
+
+    SECTION("Compressed")
+    {
+        auto compression = compression::zlib;
+        compression.blockSize = 4096;
+        write(compression);
+        requireContents(read(path), grid);
+        requireContents(read(path, {.arrays = {}, .threads = 1}), grid);
+    }
+
+    SECTION("Uncompressed")
+    {
+        write(compression::none);
+        requireContents(read(path), grid);
+    }
+
+#ifdef TINYVTU_WITH_LZ4
+    SECTION("LZ4")
+    {
+        write(compression::lz4);
+        requireContents(read(path), grid);
+    }
+#endif
+
+#ifdef TINYVTU_WITH_LZMA
+    SECTION("LZMA")
+    {
+        write(compression::lzma);
+        requireContents(read(path), grid);
+    }
+#endif
+
+    SECTION("Streaming grid with 64 bit headers")
+    {
+        {
+            auto streamingGrid = createStreamingGrid(path, std::span(grid.points), CellType::Tetra, grid.cells,
+                                                     compression::zlib, {.uint64Headers = true});
+            streamingGrid.addPointData("pointField", grid.pointField);
+            streamingGrid.addPointData("vectors", grid.vectors, 3);
+            streamingGrid.addCellData("cellField", grid.cellField);
+            streamingGrid.close();
+        }
+        requireContents(read(path), grid);
+    }
+
+    SECTION("Selected arrays")
+    {
+        write(compression::zlib);
+        const auto dataset = read(path, {.arrays = {"vectors", "cellField"}, .topology = false});
+        REQUIRE(dataset.points.bytes.empty());
+        REQUIRE(dataset.connectivity.bytes.empty());
+        REQUIRE(dataset.pointData.size() == 1);
+        REQUIRE(dataset.find("pointField") == nullptr);
+        REQUIRE(toVector<float>(*dataset.find("vectors")) == grid.vectors);
+        REQUIRE(toVector<std::int32_t>(*dataset.find("cellField")) == grid.cellField);
+        REQUIRE_THROWS_AS(dataset.find("vectors")->values<double>(), std::invalid_argument);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Read invalid files", "[read]")
+{
+    const std::filesystem::path path = "test_reader_invalid.vtu";
+    auto writeText = [&](const std::string& text) { std::ofstream(path, std::ios::binary) << text; };
+
+    SECTION("Missing file")
+    {
+        REQUIRE_THROWS_AS(read("does_not_exist.vtu"), std::runtime_error);
+    }
+
+    SECTION("Empty or not an XML file")
+    {
+        writeText("");
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+        writeText("solid cube\nendsolid cube\n");
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+    }
+
+    SECTION("Missing or repeated pieces")
+    {
+        const std::string grid = R"(<VTKFile type="UnstructuredGrid"><UnstructuredGrid>)";
+        const std::string piece = R"(<Piece NumberOfPoints="0" NumberOfCells="0"></Piece>)";
+        const std::string end = R"(</UnstructuredGrid></VTKFile>)";
+        writeText(grid + piece + end);
+        REQUIRE_NOTHROW(read(path));
+        writeText(grid + end);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+        writeText(grid + piece + piece + end);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+        // A piece outside of a VTKFile
+        writeText(piece);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+    }
+
+    SECTION("Inline data")
+    {
+        writeText(R"(<VTKFile type="UnstructuredGrid"><UnstructuredGrid><Piece NumberOfPoints="1" NumberOfCells="0">)"
+                  R"(<Points><DataArray type="Float32" NumberOfComponents="3" format="ascii">0 0 0</DataArray>)"
+                  R"(</Points></Piece></UnstructuredGrid></VTKFile>)");
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+    }
+
+    SECTION("Truncated file")
+    {
+        const std::vector<std::array<float, 3>> points = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}};
+        createGrid(points, CellType::Triangle, {{0, 1, 2}}).write(path);
+        std::string contents;
+        std::getline(std::ifstream(path, std::ios::binary), contents, '\0');
+        std::filesystem::resize_file(path, contents.find("_", contents.find("<AppendedData")) + 20);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+    }
+
+    SECTION("Malformed compression headers")
+    {
+        // [#blocks][#u-size][#p-size] of the points, the first array of the appended data, with 64 bit fields
+        auto writeHeader = [&](std::uint64_t blocks, std::uint64_t blockSize, std::uint64_t partialSize)
+        {
+            const std::vector<std::array<float, 3>> points = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}};
+            {
+                auto grid = createStreamingGrid(path, points, CellType::Triangle, {{0, 1, 2}}, compression::zlib,
+                                                {.uint64Headers = true});
+                grid.close();
+            }
+            std::string contents;
+            std::getline(std::ifstream(path, std::ios::binary), contents, '\0');
+            const auto marker = contents.find("_", contents.find("<AppendedData"));
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(marker + 1));
+            for (const auto field : {blocks, blockSize, partialSize})
+                file.write(reinterpret_cast<const char*>(&field), sizeof(field));
+        };
+
+        // The uncompressed size wraps around to 0, the second block would be written far out of the array
+        writeHeader(2, std::uint64_t{1} << 63, 0);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+
+        writeHeader(1, (std::uint64_t{1} << 32) + 1, 0);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+
+        writeHeader(std::uint64_t{1} << 62, 4096, 0);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+
+        writeHeader(1, 4096, 8192);
+        REQUIRE_THROWS_AS(read(path), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,165 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TestHelpers.hpp"
+#include "tinyvtu.hpp"
+
+using namespace tinyvtu;
+using test::readHeader;
+using test::toVector;
+
+namespace {
+/**
+ * A field on the points of a 5x4x3 grid and one on its 4x3x2 cells, with x varying fastest.
+ */
+struct Fields
+{
+    static constexpr std::array<std::uint64_t, 3> dimensions{5, 4, 3};
+    std::vector<double> pointField;
+    std::vector<std::int32_t> cellField;
+
+    Fields()
+    {
+        for (std::uint64_t i = 0; i < 5 * 4 * 3; ++i) pointField.push_back(std::sin(0.1 * static_cast<double>(i)));
+        for (std::int32_t i = 0; i < 4 * 3 * 2; ++i) cellField.push_back(i % 5);
+    }
+
+    void add(GridBase& grid) const
+    {
+        grid.addPointData("pointField", pointField);
+        grid.addCellData("cellField", cellField);
+    }
+
+    void require(const Dataset& dataset) const
+    {
+        REQUIRE(dataset.dimensions == dimensions);
+        REQUIRE(dataset.numberOfPoints == 60);
+        REQUIRE(dataset.numberOfCells == 24);
+        REQUIRE(dataset.connectivity.bytes.empty());
+        REQUIRE(dataset.offsets.bytes.empty());
+        REQUIRE(dataset.types.bytes.empty());
+        REQUIRE(toVector<double>(*dataset.find("pointField")) == pointField);
+        REQUIRE(toVector<std::int32_t>(*dataset.find("cellField")) == cellField);
+    }
+};
+}  // namespace
+
+TEST_CASE("Image data", "[structured]")
+{
+    const Fields fields;
+    const std::filesystem::path path = "test_structured.vti";
+
+    for (const auto& compression : {compression::zlib, compression::none})
+    {
+        auto image = createImageData(fields.dimensions, {1., 2., 0.5}, {0.25, 0.25, 1.}, compression);
+        fields.add(image);
+        image.write(path);
+
+        const auto header = readHeader(path);
+        REQUIRE(header.find("type=\"ImageData\"") != std::string::npos);
+        REQUIRE(header.find("<ImageData WholeExtent=\"0 4 0 3 0 2\" Origin=\"1 2 0.5\" Spacing=\"0.25 0.25 1\">") !=
+                std::string::npos);
+        REQUIRE(header.find("<Piece Extent=\"0 4 0 3 0 2\">") != std::string::npos);
+        REQUIRE(header.find("Points") == std::string::npos);
+        REQUIRE(header.find("Cells") == std::string::npos);
+
+        const auto dataset = read(path);
+        fields.require(dataset);
+        REQUIRE(dataset.points.bytes.empty());
+    }
+
+    SECTION("Flat axes do not multiply the cells")
+    {
+        auto image = createImageData({4, 3, 1});
+        REQUIRE_NOTHROW(image.addCellData("cellField", std::vector<float>(6)));
+        REQUIRE_THROWS_AS(image.addCellData("cellField", std::vector<float>(24)), std::invalid_argument);
+    }
+
+    SECTION("Dimensions must not be zero")
+    {
+        REQUIRE_THROWS_AS(createImageData({4, 0, 1}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Rectilinear grids", "[structured]")
+{
+    const Fields fields;
+    const std::filesystem::path path = "test_structured.vtr";
+    const std::vector<double> x{0., 1., 3., 7., 15.};
+    const std::vector<double> y{-1., 0., 1., 2.};
+    const std::vector<double> z{0., 0.5, 2.};
+
+    for (const auto& compression : {compression::zlib, compression::none})
+    {
+        auto grid = createRectilinearGrid(std::span(x), std::span(y), std::span(z), compression);
+        fields.add(grid);
+        grid.write(path);
+
+        const auto header = readHeader(path);
+        REQUIRE(header.find("type=\"RectilinearGrid\"") != std::string::npos);
+        REQUIRE(header.find("<RectilinearGrid WholeExtent=\"0 4 0 3 0 2\">") != std::string::npos);
+        REQUIRE(header.find("<Coordinates>") != std::string::npos);
+
+        const auto dataset = read(path);
+        fields.require(dataset);
+        REQUIRE(toVector<double>(dataset.coordinates[0]) == x);
+        REQUIRE(toVector<double>(dataset.coordinates[1]) == y);
+        REQUIRE(toVector<double>(dataset.coordinates[2]) == z);
+    }
+
+    SECTION("Single precision coordinates")
+    {
+        const std::vector<float> axis{0.f, 1.f};
+        createRectilinearGrid(std::span(axis), std::span(axis), std::span(axis)).write(path);
+        const auto dataset = read(path);
+        REQUIRE(dataset.numberOfCells == 1);
+        REQUIRE(toVector<float>(dataset.coordinates[2]) == axis);
+    }
+}
+
+TEST_CASE("Structured grids", "[structured]")
+{
+    const Fields fields;
+    const std::filesystem::path path = "test_structured.vts";
+
+    std::vector<std::array<float, 3>> points;
+    for (std::uint64_t k = 0; k < 3; ++k)
+        for (std::uint64_t j = 0; j < 4; ++j)
+            for (std::uint64_t i = 0; i < 5; ++i)
+            {
+                // A sheared block, which a rectilinear grid cannot describe
+                const auto x = static_cast<float>(i) + 0.5f * static_cast<float>(j);
+                points.push_back({x, static_cast<float>(j), static_cast<float>(k) + 0.1f * x});
+            }
+
+    for (const auto& compression : {compression::zlib, compression::none})
+    {
+        auto grid = createStructuredGrid(fields.dimensions, std::span(points), compression);
+        fields.add(grid);
+        grid.write(path);
+
+        const auto header = readHeader(path);
+        REQUIRE(header.find("type=\"StructuredGrid\"") != std::string::npos);
+        REQUIRE(header.find("<StructuredGrid WholeExtent=\"0 4 0 3 0 2\">") != std::string::npos);
+        REQUIRE(header.find("Cells") == std::string::npos);
+
+        const auto dataset = read(path);
+        fields.require(dataset);
+        const auto values = dataset.points.values<float>();
+        REQUIRE(values.size() == 3 * points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+            for (std::size_t component = 0; component < 3; ++component)
+                REQUIRE(values[3 * i + component] == points[i][component]);
+    }
+
+    SECTION("The number of points must match the dimensions")
+    {
+        REQUIRE_THROWS_AS(createStructuredGrid({5, 4, 2}, std::span(points)), std::invalid_argument);
+    }
+}
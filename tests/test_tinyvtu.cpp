@@ -1,12 +1,23 @@
+#include <algorithm>
 #include <array>
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "TestHelpers.hpp"
 #include "tinyvtu.hpp"
 
 using namespace tinyvtu;
+using test::getContents;
 
 TEST_CASE("UnstructuredGrid Constructor and Write", "[UnstructuredGrid]")
 {
@@ -60,6 +71,692 @@ TEST_CASE("createGrid Function", "[createGrid]")
     }
 }
 
+namespace {
+std::string writeContents(const UnstructuredGrid &grid)
+{
+    const std::filesystem::path filePath = "test_span_grid.vtu";
+    grid.write(filePath);
+    auto content = getContents(filePath);
+    std::filesystem::remove(filePath);
+    return content;
+}
+}  // namespace
+
+TEST_CASE("createGrid and addData from spans", "[createGrid]")
+{
+    const std::vector<std::array<float, 3>> points = {
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}, {0, 2, 3}};
+    const std::vector<double> pointScalars = {1.0, 2.0, 3.0, 4.0};
+    const std::vector<std::int32_t> cellScalars = {7, 8};
+
+    auto writeExpected = [&](compression::Info compression)
+    {
+        auto grid = createGrid(points, CellType::Triangle, cells, compression);
+        grid.addPointData("PointScalars", pointScalars);
+        grid.addCellData("CellScalars", cellScalars);
+        return writeContents(grid);
+    };
+
+    SECTION("Spans")
+    {
+        for (const auto compression : {compression::zlib, compression::none})
+        {
+            auto grid = createGrid(std::span(points), CellType::Triangle, cells, compression);
+            grid.addPointData("PointScalars", std::span(pointScalars));
+            grid.addCellData("CellScalars", std::span(cellScalars));
+            REQUIRE(writeContents(grid) == writeExpected(compression));
+        }
+    }
+
+    SECTION("Pointers")
+    {
+        for (const auto compression : {compression::zlib, compression::none})
+        {
+            auto grid = createGrid(std::span(points.data(), points.size()), CellType::Triangle, cells, compression);
+            grid.addPointData("PointScalars", pointScalars.data(), pointScalars.size());
+            grid.addCellData("CellScalars", cellScalars.data(), cellScalars.size());
+            REQUIRE(writeContents(grid) == writeExpected(compression));
+        }
+    }
+
+    SECTION("Double precision points")
+    {
+        const std::vector<std::array<double, 3>> doublePoints = {
+            {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {0.0, 1.0, 0.0}};
+        auto grid = createGrid(std::span(doublePoints), CellType::Triangle, cells, compression::none);
+        const auto content = writeContents(grid);
+        REQUIRE(content.find("NumberOfComponents=\"3\" type=\"Float64\"") != std::string::npos);
+    }
+
+    SECTION("Size mismatch")
+    {
+        auto grid = createGrid(std::span(points), CellType::Triangle, cells);
+        REQUIRE_THROWS_AS(grid.addPointData("PointScalars", pointScalars.data(), 3), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Per-array compression", "[createGrid]")
+{
+    const std::vector<std::array<float, 3>> points = {
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}, {0, 2, 3}};
+    std::vector<double> pointScalars(4);
+    for (std::size_t i = 0; i < pointScalars.size(); ++i) pointScalars[i] = static_cast<double>(i) * 0.25;
+
+    auto grid = createGrid(points, CellType::Triangle, cells);
+    grid.addPointData("Default", pointScalars);
+
+    SECTION("Settings of the grid")
+    {
+        auto expected = createGrid(points, CellType::Triangle, cells);
+        expected.addPointData("Default", pointScalars);
+        grid.addPointData("Scalars", pointScalars, 1, compression::zlib);
+        expected.addPointData("Scalars", pointScalars);
+        REQUIRE(writeContents(grid) == writeContents(expected));
+    }
+
+    SECTION("Other level and block size")
+    {
+        grid.addPointData("Stored", std::span<const double>(pointScalars), 1, compression::Info{true, 4096, 0});
+        grid.addCellData("Ids", std::vector<std::int32_t>{1, 2}, 1, compression::Info{true, 0, 9});
+        const auto content = writeContents(grid);
+        REQUIRE(content.find("Name=\"Stored\"") != std::string::npos);
+        REQUIRE(content.find("Name=\"Ids\"") != std::string::npos);
+    }
+
+    SECTION("Settings the file cannot declare")
+    {
+        REQUIRE_THROWS_AS(grid.addPointData("Scalars", pointScalars, 1, compression::none), std::invalid_argument);
+        REQUIRE_THROWS_AS(grid.addPointData("Scalars", pointScalars, 1, compression::lz4), std::invalid_argument);
+
+        auto uncompressed = createGrid(points, CellType::Triangle, cells, compression::none);
+        REQUIRE_THROWS_AS(uncompressed.addPointData("Scalars", pointScalars, 1, compression::zlib),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("Deferred compression", "[createGrid]")
+{
+    std::vector<std::array<double, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    std::vector<double> large;
+    std::vector<std::int32_t> ids;
+    for (std::int32_t i = 0; i < 30000; ++i)
+    {
+        points.push_back({static_cast<double>(i), static_cast<double>(i % 7), 0.0});
+        large.push_back(static_cast<double>(i % 113) * 0.5);
+        if (i + 3 < 30000 && i % 2 == 0)
+        {
+            cells.push_back({i, i + 1, i + 2, i + 3});
+            ids.push_back(i % 5);
+        }
+    }
+    std::vector<float> small(points.size());
+    for (std::size_t i = 0; i < small.size(); ++i) small[i] = static_cast<float>(i % 17);
+
+    auto fill = [&](compression::Info compression)
+    {
+        auto grid = createGrid(std::span<const std::array<double, 3>>(points), CellType::Tetra, cells, compression);
+        grid.addPointData("large", std::span<const double>(large));
+        auto lowLevel = compression;
+        lowLevel.level = 1;
+        grid.addPointData("small", small, 1, lowLevel);
+        grid.addPointData("rounded", std::span<const double>(large), 1, {}, {.significantBits = 12});
+        grid.addCellData("ids", ids);
+        return grid;
+    };
+
+    auto compression = compression::zlib;
+    const auto expected = writeContents(fill(compression));
+
+    compression.deferred = true;
+    for (const std::uint32_t threads : {1u, 4u})
+    {
+        compression.threads = threads;
+        auto grid = fill(compression);
+        // Vectors are copied when added, hence changing them afterward does not change the file
+        std::ranges::fill(small, 0.0f);
+        REQUIRE(writeContents(grid) == expected);
+        REQUIRE(writeContents(grid) == expected);
+        for (std::size_t i = 0; i < small.size(); ++i) small[i] = static_cast<float>(i % 17);
+
+        statistics::Info statistics;
+        std::vector<std::uint8_t> buffer;
+        VectorSink sink(buffer);
+        grid.write(sink, &statistics);
+        // The arrays are compressed within the write
+        for (const auto &array : statistics.arrays) REQUIRE(array.compressionStart >= statistics.writeStart);
+    }
+}
+
+TEST_CASE("Deduplicated arrays", "[createGrid]")
+{
+    std::vector<std::array<float, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    for (std::int32_t i = 0; i < 20000; ++i)
+    {
+        points.push_back({static_cast<float>(i), 0.0f, 0.0f});
+        if (i + 2 < 20000) cells.push_back({i, i + 1, i + 2});
+    }
+    std::vector<std::int32_t> materials(cells.size());
+    for (std::size_t i = 0; i < materials.size(); ++i) materials[i] = static_cast<std::int32_t>((i * 7919) % 13);
+    const std::vector<double> zeros(points.size(), 0.0);
+
+    // Returns the offset attribute of the DataArray element with the passed name
+    auto offsetOf = [](const std::string &contents, const std::string &name)
+    {
+        const auto element = contents.find("Name=\"" + name + "\"");
+        const auto offset = contents.find("offset=\"", element) + 8;
+        return std::stoull(contents.substr(offset, contents.find('"', offset) - offset));
+    };
+
+    for (auto compression : {compression::zlib, compression::none})
+    {
+        compression.deduplicate = true;
+        auto unique = createGrid(points, CellType::Triangle, cells, compression);
+        unique.addCellData("material", materials);
+        unique.addPointData("u", zeros);
+        const auto uniqueContents = writeContents(unique);
+
+        auto grid = createGrid(points, CellType::Triangle, cells, compression);
+        grid.addCellData("material", materials);
+        grid.addPointData("u", zeros);
+        grid.addPointData("v", zeros);
+        grid.addCellData("region", std::span<const std::int32_t>(materials));
+        // Other settings write other bytes, hence the array is not shared
+        auto other = compression;
+        other.level = 6;
+        grid.addPointData("w", zeros, 1, other);
+
+        const std::filesystem::path filePath = "test_deduplicated.vtu";
+        statistics::Info statistics;
+        grid.write(filePath, &statistics);
+        const auto contents = getContents(filePath);
+
+        REQUIRE(offsetOf(contents, "v") == offsetOf(contents, "u"));
+        REQUIRE(offsetOf(contents, "region") == offsetOf(contents, "material"));
+        if (compression.active) REQUIRE(offsetOf(contents, "w") != offsetOf(contents, "u"));
+        // Only the element of each duplicate is added, except for the differently compressed copy of the zeros
+        REQUIRE(statistics.arrays[5].name == "v");
+        REQUIRE(statistics.arrays[5].compressedBytes == 0);
+        REQUIRE(statistics.arrays[5].rawBytes == zeros.size() * sizeof(double));
+        const auto wBytes = statistics.arrays[6].compressedBytes;
+        REQUIRE(contents.size() < uniqueContents.size() + wBytes + 400);
+
+        const auto dataset = read(filePath);
+        std::filesystem::remove(filePath);
+        const auto region = dataset.find("region")->values<std::int32_t>();
+        REQUIRE(std::vector<std::int32_t>(region.begin(), region.end()) == materials);
+        const auto v = dataset.find("v")->values<double>();
+        REQUIRE(std::vector<double>(v.begin(), v.end()) == zeros);
+    }
+
+    SECTION("Arrays are only shared if enabled")
+    {
+        auto grid = createGrid(points, CellType::Triangle, cells);
+        grid.addPointData("u", zeros);
+        grid.addPointData("v", zeros);
+        const auto contents = writeContents(grid);
+        REQUIRE(offsetOf(contents, "v") != offsetOf(contents, "u"));
+    }
+}
+
+TEST_CASE("Strided and component views", "[createGrid]")
+{
+    struct Node
+    {
+        double pressure;
+        float velocity[3];
+        std::int32_t id;
+    };
+    std::vector<std::array<float, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    std::vector<Node> nodes;
+    for (std::int32_t i = 0; i < 5000; ++i)
+    {
+        const auto x = static_cast<float>(i);
+        points.push_back({x, 0.0f, 0.0f});
+        nodes.push_back({0.25 * static_cast<double>(i % 97), {x, 0.5f * x, static_cast<float>(i % 11)}, i % 5});
+        if (i + 1 < 5000) cells.push_back({i, i + 1});
+    }
+    std::vector<float> vx, vy, vz;
+    std::vector<float> velocity, interleaved;
+    std::vector<double> pressure;
+    for (const auto &node : nodes)
+    {
+        vx.push_back(node.velocity[0]);
+        vy.push_back(node.velocity[1]);
+        vz.push_back(node.velocity[2]);
+        velocity.insert(velocity.end(), node.velocity, node.velocity + 3);
+        interleaved.insert(interleaved.end(), {node.velocity[2], node.velocity[0], node.velocity[1]});
+        pressure.push_back(node.pressure);
+    }
+    const std::vector<std::int32_t> ids(cells.size(), 3);
+
+    // Blocks of 1000 bytes cut tuples of 12 bytes and values of 8 bytes
+    auto cutting = compression::zlib;
+    cutting.blockSize = 1000;
+    auto deferred = compression::zlib;
+    deferred.deferred = true;
+    for (const auto &compression : {compression::zlib, cutting, deferred, compression::none})
+    {
+        auto expected = createGrid(points, CellType::Line, cells, compression);
+        expected.addPointData("pressure", pressure);
+        expected.addPointData("velocity", velocity, 3);
+        expected.addPointData("interleaved", interleaved, 3);
+        expected.addCellData("ids", ids);
+
+        auto grid = createGrid(points, CellType::Line, cells, compression);
+        grid.addPointData("pressure", StridedView<double>{&nodes[0].pressure, nodes.size(), sizeof(Node)});
+        grid.addPointData("velocity", StridedView<float>{nodes[0].velocity, nodes.size(), sizeof(Node), 3});
+        grid.addPointData("interleaved", ComponentsView<float>{{vz.data(), vx.data(), vy.data()}, vx.size()});
+        // A single contiguous component is added as a plain array
+        grid.addCellData("ids", ComponentsView<std::int32_t>{{ids.data()}, ids.size()});
+        REQUIRE(writeContents(grid) == writeContents(expected));
+    }
+
+    SECTION("The views must match the grid")
+    {
+        auto grid = createGrid(points, CellType::Line, cells);
+        REQUIRE_THROWS_AS(grid.addPointData("short", ComponentsView<float>{{vx.data()}, vx.size() - 1}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(grid.addPointData("none", ComponentsView<float>{{}, vx.size()}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Generated fields", "[createGrid]")
+{
+    std::vector<std::array<float, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    std::vector<float> velocity;
+    for (std::int32_t i = 0; i < 20000; ++i)
+    {
+        const auto x = static_cast<float>(i);
+        points.push_back({x, 0.0f, 0.0f});
+        velocity.insert(velocity.end(), {std::sin(0.01f * x), std::cos(0.01f * x), 0.001f * x});
+        if (i + 1 < 20000) cells.push_back({i, i + 1});
+    }
+    auto magnitude = [&](std::uint64_t i)
+    { return std::hypot(velocity[3 * i], velocity[3 * i + 1], velocity[3 * i + 2]); };
+    auto rank = [&](std::uint64_t cell) { return static_cast<std::int32_t>(cell * 4 / cells.size()); };
+
+    std::vector<float> magnitudes(points.size());
+    for (std::size_t i = 0; i < magnitudes.size(); ++i) magnitudes[i] = magnitude(i);
+    std::vector<std::int32_t> ranks(cells.size());
+    for (std::size_t i = 0; i < ranks.size(); ++i) ranks[i] = rank(i);
+    std::vector<double> scaled(velocity.size());
+    for (std::size_t i = 0; i < scaled.size(); ++i) scaled[i] = 2.0 * velocity[i];
+
+    // Blocks of 1000 bytes cut values of 8 bytes
+    auto cutting = compression::zlib;
+    cutting.blockSize = 1000;
+    cutting.threads = 4;
+    auto deferred = compression::zlib;
+    deferred.deferred = true;
+    for (const auto &compression : {compression::zlib, cutting, deferred, compression::none})
+    {
+        auto expected = createGrid(points, CellType::Line, cells, compression);
+        expected.addPointData("magnitude", magnitudes);
+        expected.addPointData("scaled", scaled, 3);
+        expected.addCellData("rank", ranks);
+
+        auto grid = createGrid(points, CellType::Line, cells, compression);
+        grid.addPointData("magnitude", magnitude);
+        grid.addPointData("scaled", velocity | std::views::transform([](float v) { return 2.0 * v; }), 3);
+        grid.addCellData("rank", rank);
+        REQUIRE(writeContents(grid) == writeContents(expected));
+    }
+
+    SECTION("A range must match the grid")
+    {
+        auto grid = createGrid(points, CellType::Line, cells);
+        REQUIRE_THROWS_AS(grid.addPointData("short", std::views::iota(0, 10) |
+                                                         std::views::transform([](int i) { return 1.0f * i; })),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("createGrid from CSR arrays", "[createGrid]")
+{
+    const std::vector<std::array<float, 3>> points = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f},
+                                                      {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2, 4}, {0, 2, 3, 4}};
+    const std::vector<std::int32_t> connectivity = {0, 1, 2, 4, 0, 2, 3, 4};
+    const std::vector<std::int32_t> offsets = {4, 8};
+    const std::vector<std::int32_t> csrOffsets = {0, 4, 8};
+    const std::vector<CellType> cellTypes = {CellType::Tetra, CellType::Tetra};
+
+    SECTION("Same output as vector of cells")
+    {
+        for (const auto compression : {compression::zlib, compression::none})
+        {
+            const auto expected = writeContents(createGrid(points, CellType::Tetra, cells, compression));
+            REQUIRE(writeContents(createGrid(std::span(points), std::span(connectivity), std::span(offsets),
+                                             std::span(cellTypes), compression)) == expected);
+            REQUIRE(writeContents(createGrid(std::span(points), std::span(connectivity), std::span(csrOffsets),
+                                             std::span(cellTypes), compression)) == expected);
+        }
+    }
+
+    SECTION("Mixed cell types and 64-bit indices")
+    {
+        const std::vector<std::int64_t> mixedConnectivity = {0, 1, 2, 3, 4, 0, 1, 2};
+        const std::vector<std::int64_t> mixedOffsets = {0, 5, 8};
+        const std::vector<CellType> mixedTypes = {CellType::Pyramid, CellType::Triangle};
+        auto grid = createGrid(std::span(points), std::span(mixedConnectivity), std::span(mixedOffsets),
+                               std::span(mixedTypes), compression::none);
+        grid.addCellData("CellScalars", std::vector<float>{1.0f, 2.0f});
+        const auto content = writeContents(grid);
+        REQUIRE(content.find("Name=\"connectivity\" type=\"Int64\"") != std::string::npos);
+        REQUIRE(content.find("Name=\"offsets\" type=\"Int64\"") != std::string::npos);
+    }
+
+    SECTION("Mismatching sizes")
+    {
+        REQUIRE_THROWS_AS(createGrid(std::span(points), std::span(connectivity), std::span(offsets).first(1),
+                                     std::span(cellTypes)),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(createGrid(std::span(points), std::span(connectivity).first(7), std::span(offsets),
+                                     std::span(cellTypes)),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("writePartitioned", "[partitioned]")
+{
+    const std::vector<std::array<float, 3>> points = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}};
+    const std::filesystem::path filePath = "test_partitioned.pvtu";
+
+    auto createPiece = [&](float value)
+    {
+        auto grid = createGrid(points, CellType::Triangle, cells);
+        grid.addPointData("Temperature", std::vector<float>(3, value));
+        grid.addCellData("Rank", std::vector<std::int32_t>{static_cast<std::int32_t>(value)});
+        return grid;
+    };
+
+    SECTION("Pieces and parallel file")
+    {
+        std::vector<UnstructuredGrid> pieces;
+        for (int i = 0; i < 3; ++i) pieces.push_back(createPiece(static_cast<float>(i)));
+        writePartitioned(pieces, filePath, 2);
+
+        for (std::uint32_t i = 0; i < 3; ++i)
+        {
+            REQUIRE(piecePath(filePath, i) == std::filesystem::path("test_partitioned_" + std::to_string(i) + ".vtu"));
+            REQUIRE(getContents(piecePath(filePath, i)) == writeContents(pieces[i]));
+            std::filesystem::remove(piecePath(filePath, i));
+        }
+
+        const auto content = getContents(filePath);
+        std::filesystem::remove(filePath);
+        REQUIRE(content.find("<VTKFile type=\"PUnstructuredGrid\"") != std::string::npos);
+        REQUIRE(content.find("<PDataArray Name=\"Temperature\" NumberOfComponents=\"1\" type=\"Float32\"/>") !=
+                std::string::npos);
+        REQUIRE(content.find("<PDataArray Name=\"Rank\" NumberOfComponents=\"1\" type=\"Int32\"/>") !=
+                std::string::npos);
+        REQUIRE(content.find("<PDataArray NumberOfComponents=\"3\" type=\"Float32\"/>") != std::string::npos);
+        REQUIRE(content.find("<Piece Source=\"test_partitioned_2.vtu\"/>") != std::string::npos);
+        REQUIRE(content.find("test_partitioned_3.vtu") == std::string::npos);
+    }
+
+    SECTION("Pieces with different arrays")
+    {
+        std::vector<UnstructuredGrid> pieces;
+        pieces.push_back(createPiece(0.0f));
+        pieces.push_back(createGrid(points, CellType::Triangle, cells));
+        REQUIRE_THROWS_AS(writePartitioned(pieces, filePath), std::invalid_argument);
+        REQUIRE_THROWS_AS(writePartitioned(std::span<const UnstructuredGrid>(), filePath), std::invalid_argument);
+        REQUIRE(!std::filesystem::exists(filePath));
+    }
+}
+
+TEST_CASE("TimeSeries", "[series]")
+{
+    const std::vector<std::array<double, 3>> points = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}};
+    const std::filesystem::path filePath = "test_series.pvd";
+
+    for (const auto compression : {compression::zlib, compression::none})
+    {
+        auto series = createTimeSeries(filePath, std::span(points), CellType::Triangle, cells, compression);
+        REQUIRE(series.size() == 0);
+        REQUIRE(!std::filesystem::exists(filePath));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const std::vector<float> temperature(3, static_cast<float>(i));
+            auto step = series.createStep();
+            step.addPointData("Temperature", temperature);
+            series.write(step, 0.25 * i);
+
+            // A step shares the topology but is written exactly like a grid created from scratch
+            auto expected = createGrid(std::span(points), CellType::Triangle, cells, compression);
+            expected.addPointData("Temperature", temperature);
+            const std::filesystem::path stepPath = "test_series_" + std::to_string(i) + ".vtu";
+            REQUIRE(getContents(stepPath) == writeContents(expected));
+            std::filesystem::remove(stepPath);
+        }
+        REQUIRE(series.size() == 3);
+
+        const auto content = getContents(filePath);
+        std::filesystem::remove(filePath);
+        REQUIRE(content.find("<VTKFile type=\"Collection\"") != std::string::npos);
+        REQUIRE(content.find("<DataSet timestep=\"0\" part=\"0\" file=\"test_series_0.vtu\"/>") !=
+                std::string::npos);
+        REQUIRE(content.find("<DataSet timestep=\"0.5\" part=\"0\" file=\"test_series_2.vtu\"/>") !=
+                std::string::npos);
+    }
+}
+
+TEST_CASE("AsyncWriter", "[async]")
+{
+    const std::vector<std::array<float, 3>> points = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}};
+
+    auto createStep = [points, cells](int step)
+    {
+        auto grid = createGrid(points, CellType::Triangle, cells);
+        grid.addPointData("Temperature", std::vector<float>(3, static_cast<float>(step)));
+        return grid;
+    };
+    auto stepPath = [](int step) { return std::filesystem::path("test_async_" + std::to_string(step) + ".vtu"); };
+
+    SECTION("Grids and functions creating grids")
+    {
+        AsyncWriter writer({.maxInFlight = 2, .threads = 2});
+        std::vector<std::future<void>> writes;
+        for (int step = 0; step < 4; ++step)
+        {
+            if (step % 2 == 0)
+                writes.push_back(writer.write(createStep(step), stepPath(step)));
+            else
+                writes.push_back(writer.write([createStep, step] { return createStep(step); }, stepPath(step)));
+        }
+        for (auto &write : writes) REQUIRE_NOTHROW(write.get());
+        writer.wait();
+
+        for (int step = 0; step < 4; ++step)
+        {
+            REQUIRE(getContents(stepPath(step)) == writeContents(createStep(step)));
+            std::filesystem::remove(stepPath(step));
+        }
+    }
+
+    SECTION("Errors are passed through the future")
+    {
+        AsyncWriter writer;
+        auto write = writer.write(createStep(0), "missing_directory/test_async.vtu");
+        REQUIRE_THROWS_AS(write.get(), std::runtime_error);
+
+        auto failing = writer.write([]() -> UnstructuredGrid { throw std::invalid_argument("no grid"); }, stepPath(0));
+        REQUIRE_THROWS_AS(failing.get(), std::invalid_argument);
+        REQUIRE(!std::filesystem::exists(stepPath(0)));
+    }
+}
+
+TEST_CASE("Write to sinks", "[sink]")
+{
+    const std::vector<std::array<float, 3>> points = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    const std::vector<std::vector<std::int32_t>> cells = {{0, 1, 2}};
+    // Large enough that the array is passed to the sink as its own chunk
+    const std::vector<double> values(3 * 1024, 1.5);
+
+    auto grid = createGrid(points, CellType::Triangle, cells, compression::none);
+    grid.addPointData("Values", values, 1024);
+    const auto expected = writeContents(grid);
+
+    SECTION("Vector")
+    {
+        std::vector<std::uint8_t> buffer;
+        VectorSink sink(buffer);
+        write(grid, sink);
+        REQUIRE(std::string(buffer.begin(), buffer.end()) == expected);
+    }
+
+    SECTION("Many small writes")
+    {
+        std::vector<std::uint8_t> buffer;
+        VectorSink sink(buffer);
+        std::size_t reallocations = 0;
+        for (std::size_t i = 0; i < 100000; ++i)
+        {
+            const std::array<std::uint8_t, 3> bytes = {std::uint8_t(i), std::uint8_t(i >> 8), std::uint8_t(i >> 16)};
+            const std::array<std::span<const std::uint8_t>, 2> chunks = {std::span(bytes).first(1),
+                                                                         std::span(bytes).subspan(1)};
+            const auto capacity = buffer.capacity();
+            sink.write(chunks);
+            reallocations += buffer.capacity() != capacity;
+        }
+        REQUIRE(buffer.size() == 300000);
+        REQUIRE(buffer[3 * 70000 + 1] == std::uint8_t(70000 >> 8));
+        // The buffer grows geometrically instead of by each write
+        REQUIRE(reallocations < 64);
+    }
+
+    SECTION("Polymorphic allocator vector")
+    {
+        std::pmr::monotonic_buffer_resource resource;
+        std::pmr::vector<std::uint8_t> buffer(&resource);
+        PmrVectorSink sink(buffer);
+        grid.write(sink);
+        REQUIRE(std::string(buffer.begin(), buffer.end()) == expected);
+    }
+
+    SECTION("Callback")
+    {
+        std::string received;
+        bool referenced = false;
+        CallbackSink sink(
+            [&](std::span<const std::uint8_t> chunk)
+            {
+                // The array is handed over straight from the grid's memory
+                referenced = referenced || chunk.size() >= values.size() * sizeof(double);
+                received.append(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+            });
+        grid.write(sink);
+        REQUIRE(received == expected);
+        REQUIRE(referenced);
+    }
+
+    SECTION("Errors of the sink")
+    {
+        CallbackSink sink([](std::span<const std::uint8_t>) { throw std::runtime_error("sink failed"); });
+        REQUIRE_THROWS_AS(grid.write(sink), std::runtime_error);
+    }
+
+    SECTION("File descriptor")
+    {
+        const std::filesystem::path filePath = "test_sink.vtu";
+        std::FILE *file = std::fopen(filePath.string().c_str(), "wb");
+        REQUIRE(file != nullptr);
+        {
+            FileDescriptorSink sink(fileno(file));
+            grid.write(sink);
+        }
+        std::fclose(file);
+        REQUIRE(getContents(filePath) == expected);
+        std::filesystem::remove(filePath);
+    }
+}
+
+TEST_CASE("Write statistics", "[statistics]")
+{
+    std::vector<std::array<float, 3>> points;
+    std::vector<std::vector<std::int32_t>> cells;
+    std::vector<float> field;
+    for (std::int32_t i = 0; i < 20000; ++i)
+    {
+        points.push_back({static_cast<float>(i), 0.0f, 0.0f});
+        field.push_back(static_cast<float>(i % 101));
+        if (i + 2 < 20000) cells.push_back({i, i + 1, i + 2});
+    }
+
+    auto compression = compression::zlib;
+    compression.blockSize = 16384;
+    auto grid = createGrid(points, CellType::Triangle, cells, compression);
+    grid.addPointData("field", field);
+    const auto expected = writeContents(grid);
+
+    const std::filesystem::path filePath = "test_statistics.vtu";
+    statistics::Info statistics;
+    grid.write(filePath, &statistics);
+    // Flushing every array on its own does not change the file
+    REQUIRE(getContents(filePath) == expected);
+    std::filesystem::remove(filePath);
+
+    REQUIRE(statistics.arrays.size() == 5);
+    REQUIRE(statistics.arrays[0].name == "points");
+    REQUIRE(statistics.arrays[1].name == "connectivity");
+    REQUIRE(statistics.arrays[4].name == "field");
+
+    const auto &fieldStatistics = statistics.arrays[4];
+    REQUIRE(fieldStatistics.rawBytes == field.size() * sizeof(float));
+    REQUIRE(fieldStatistics.blocks == 5);
+    REQUIRE(fieldStatistics.compressedBytes < fieldStatistics.rawBytes);
+    REQUIRE(statistics.arrays[0].rawBytes == points.size() * 3 * sizeof(float));
+
+    std::uint64_t totalBytes = 0;
+    for (const auto &array : statistics.arrays)
+    {
+        totalBytes += array.compressedBytes;
+        REQUIRE(array.compressionSeconds >= 0);
+        REQUIRE(array.ioSeconds >= 0);
+        // Arrays are compressed when added, before the write starts
+        REQUIRE(array.compressionStart <= statistics.writeStart);
+        REQUIRE(array.ioStart >= statistics.writeStart);
+    }
+    REQUIRE(totalBytes < expected.size());
+    REQUIRE(statistics.peakMemory >= totalBytes);
+    REQUIRE(statistics.writeSeconds > 0);
+
+    SECTION("Uncompressed")
+    {
+        auto uncompressed = createGrid(points, CellType::Triangle, cells, compression::none);
+        uncompressed.addPointData("field", std::span<const float>(field));
+        std::vector<std::uint8_t> buffer;
+        VectorSink sink(buffer);
+        uncompressed.write(sink, &statistics);
+        REQUIRE(statistics.arrays.size() == 5);
+        REQUIRE(statistics.arrays[4].rawBytes == field.size() * sizeof(float));
+        REQUIRE(statistics.arrays[4].blocks == 0);
+    }
+
+    SECTION("Trace")
+    {
+        std::ostringstream trace;
+        statistics.writeTrace(trace);
+        const auto json = trace.str();
+        REQUIRE(json.starts_with("{\"displayTimeUnit\""));
+        REQUIRE(json.find("\"name\":\"compress field\"") != std::string::npos);
+        REQUIRE(json.find("\"name\":\"write field\"") != std::string::npos);
+        REQUIRE(json.find("\"blocks\":5") != std::string::npos);
+        REQUIRE(json.ends_with("]}\n"));
+    }
+}
+
 TEST_CASE("Compression Info Defaults", "[compression]")
 {
     using namespace tinyvtu::compression;
@@ -70,6 +767,8 @@ TEST_CASE("Compression Info Defaults", "[compression]")
         REQUIRE(defaultCompression.active == true);
         REQUIRE(defaultCompression.blockSize == 32768);
         REQUIRE(defaultCompression.level == 2);
+        REQUIRE(defaultCompression.threads == 1);
+        REQUIRE(defaultCompression.codec == Codec::ZLib);
     }
 
     SECTION("No Compression")
@@ -84,5 +783,14 @@ TEST_CASE("Compression Info Defaults", "[compression]")
         REQUIRE(zlib.active == true);
         REQUIRE(zlib.blockSize == 32768);
         REQUIRE(zlib.level == 2);
+        REQUIRE(zlib.codec == Codec::ZLib);
+    }
+
+    SECTION("Other codecs")
+    {
+        REQUIRE(lz4.active == true);
+        REQUIRE(lz4.codec == Codec::LZ4);
+        REQUIRE(lzma.active == true);
+        REQUIRE(lzma.codec == Codec::LZMA);
     }
 }
@@ -1,4 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <fstream>
+#include <sstream>
 
 #include "internal/XMLWriter.hpp"
 
@@ -239,4 +242,56 @@ TEST_CASE_METHOD(XMLWriterTest, "XMLWriter writes elements correctly", "[XMLWrit
         writer.writeData(large_data_block);
         writer.writeData(pattern_data);
     }
+    SECTION("Limit bandwidth")
+    {
+        const Data data(200 * 1024, 0x2A);
+        const auto start = std::chrono::steady_clock::now();
+        {
+            XMLWriter writer(file_path);
+            writer.limitBandwidth(1024 * 1024);
+            writer.writeData(data);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        // 200 KiB at 1 MiB/s take about 0.2 seconds
+        REQUIRE(elapsed.count() > 0.15);
+        REQUIRE(std::filesystem::file_size(file_path) == data.size());
+    }
+    SECTION("Gathered content and data")
+    {
+        // Large data is referenced, small data is copied, both keep their position between the XML content
+        const Data large(64 * 1024, 0x41);
+        const Data small{0x42, 0x43};
+        std::string expected;
+        {
+            XMLWriter writer(file_path);
+            writer.openXMLElement("a");
+            writer.openXMLElement("b");
+            writer.writeContent("_", true, false);
+            writer.writeData(large);
+            writer.writeData(small);
+            writer.writeData(large);
+            writer.writeContent("", false, true);
+            writer.endXMLElement();
+            writer.endXMLElement();
+            writer.flush();
+        }
+        expected = "<a>\n  <b>\n    _" + std::string(large.size(), 'A') + "BC" + std::string(large.size(), 'A') +
+                   "\n  </b>\n</a>\n";
+        REQUIRE(getContents(file_path) == expected);
+
+        std::ostringstream stream;
+        {
+            XMLWriter writer(stream);
+            writer.openXMLElement("a");
+            writer.openXMLElement("b");
+            writer.writeContent("_", true, false);
+            writer.writeData(large);
+            writer.writeData(small);
+            writer.writeData(large);
+            writer.writeContent("", false, true);
+            writer.endXMLElement();
+            writer.endXMLElement();
+        }
+        REQUIRE(stream.str() == expected);
+    }
 }